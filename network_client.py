@@ -0,0 +1,124 @@
+"""Client for the network_server binary.
+
+Speaks the line protocol described in src/query_server.hpp over the server's
+Unix-domain socket, so analyses can query a network that stays loaded instead
+of deserializing it in every script.
+"""
+
+
+__author__ = "karepker@umich.edu Kar Epker"
+__copyright__ = "Kar Epker, 2015"
+
+
+import argparse
+import socket
+
+
+class QueryError(Exception):
+    """Raised when the server answers a request with an error."""
+    pass
+
+
+class NetworkClient:
+    """A connection to a running network_server."""
+
+    def __init__(self, socket_path):
+        """Connects to the server.
+
+        Args:
+            socket_path (string): Path of the server's Unix-domain socket.
+        """
+
+        self.connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.connection.connect(socket_path)
+        self.responses = self.connection.makefile('r')
+
+
+    def close(self):
+        self.connection.sendall(b'quit\n')
+        self.responses.close()
+        self.connection.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def request(self, request):
+        """Sends a request and returns the lines of the response.
+
+        Args:
+            request (string): A single line request, e.g. 'neighbors 147195'.
+
+        Returns:
+            A list of the response's lines, split on tabs.
+
+        Raises:
+            QueryError: If the server could not answer the request.
+        """
+
+        self.connection.sendall((request + '\n').encode())
+        status = self.responses.readline().rstrip('\n')
+        if status.startswith('ERR '):
+            raise QueryError(status[len('ERR '):])
+
+        num_lines = int(status[len('OK '):])
+        return [self.responses.readline().rstrip('\n').split('\t')
+                for _ in range(num_lines)]
+
+
+    def student(self, student_id):
+        """Returns the description of the student."""
+        return self.request('student {}'.format(student_id))[0][0]
+
+    def neighbors(self, student_id):
+        """Returns a dictionary of neighbor ID => edge weight."""
+        return {int(neighbor): float(weight) for neighbor, weight in
+                self.request('neighbors {}'.format(student_id))}
+
+    def ego(self, student_id, hops):
+        """Returns (student, student, weight) edges within hops of student."""
+        return [(int(u), int(v), float(weight)) for u, v, weight in
+                self.request('ego {} {}'.format(student_id, hops))]
+
+    def distances(self, student_id, weighted=True):
+        """Returns a dictionary of connected student ID => distance."""
+        distance_type = 'weighted' if weighted else 'unweighted'
+        return {int(other): float(distance) for other, distance in
+                self.request('distances {} {}'.format(
+                    student_id, distance_type))}
+
+    def distance(self, source_id, target_id, weighted=True):
+        """Returns the distance between the students, None if disconnected."""
+        distance_type = 'weighted' if weighted else 'unweighted'
+        lines = self.request('distance {} {} {}'.format(
+            source_id, target_id, distance_type))
+        return float(lines[0][0]) if lines else None
+
+    def reduce(self, grouping, aggregate):
+        """Returns (group, group, aggregate) edges of the reduced network."""
+        return [(u, v, float(value)) for u, v, value in
+                self.request('reduce {} {}'.format(grouping, aggregate))]
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Send requests to a running '
+        'network_server, one per line of input')
+    parser.add_argument('--socket-path', dest='socket_path',
+        help='Path of the server\'s socket.', required=True)
+
+    args = parser.parse_args()
+
+    with NetworkClient(args.socket_path) as client:
+        while True:
+            try:
+                request = input('Enter request: ')
+            except EOFError:
+                break
+
+            try:
+                for line in client.request(request):
+                    print('\t'.join(line))
+            except QueryError as e:
+                print(e, end='\n\n')
@@ -0,0 +1,237 @@
+"""Performance regression harness for the network binaries.
+
+Runs a fixed synthetic workload through serialize, build and an analyze
+pipeline, then compares each step's wall time and peak resident memory, and
+the checksums of everything it wrote, against a baselines file. Exits with a
+failure if a metric got worse than the baseline by more than the threshold or
+if any output changed. Baselines are recorded on the first run or with
+--update; they only mean something on the machine that recorded them.
+"""
+
+
+__author__ = "karepker@umich.edu Kar Epker"
+__copyright__ = "Kar Epker, 2015"
+
+
+import argparse
+import hashlib
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+
+# The metrics of every step compared against the baselines.
+METRICS = ['wall_seconds', 'peak_rss_kb']
+
+# Timings shorter than this are mostly noise, so differences below it are
+# never regressions.
+MIN_SECONDS = 0.05
+
+PIPELINE = """\
+degree_sum weighted=output/weighted_summation.tsv unweighted=output/unweighted_summation.tsv
+reduce grouping=major1 aggregate=sum output=output/major1_weighted.tsv
+reduce grouping=school aggregate=count output=output/school_unweighted.tsv
+distances type=weighted cohort=major1:Philosophy output=output/philosophy_weighted_distances.tsv
+distances type=unweighted cohort=major1:Philosophy output=output/philosophy_unweighted_distances.tsv
+ego cohort=major1:Philosophy output_prefix=output/philosophy_ format=indexed
+"""
+
+
+def checksum(path):
+    """Returns the SHA-256 hex digest of the file."""
+
+    digest = hashlib.sha256()
+    with open(path, 'rb') as f:
+        for block in iter(lambda: f.read(1 << 20), b''):
+            digest.update(block)
+    return digest.hexdigest()
+
+
+def run_step(name, command, work_dir, stdout_path=None):
+    """Runs a binary and returns its metrics report.
+
+    Args:
+        name (string): Name of the step, used for the metrics file.
+        command (list): The binary and its arguments.
+        work_dir (string): Directory the binary runs in.
+        stdout_path (string): Optionally save the binary's output here.
+
+    Returns:
+        The metrics report parsed from JSON, see src/metrics.hpp.
+    """
+
+    metrics_path = os.path.join(work_dir, name + '_metrics.json')
+    command = command + ['--metrics_path', metrics_path]
+    stdout = open(stdout_path, 'wb') if stdout_path else subprocess.DEVNULL
+    try:
+        subprocess.run(command, cwd=work_dir, stdout=stdout, check=True)
+    finally:
+        if stdout_path:
+            stdout.close()
+
+    with open(metrics_path) as f:
+        return json.load(f)
+
+
+def run_workload(binary_dir, work_dir, args):
+    """Runs every step of the workload.
+
+    Returns:
+        A tuple of (step name => metrics, output file name => checksum).
+    """
+
+    def binary(name):
+        return os.path.join(binary_dir, name)
+
+    def path(name):
+        return os.path.join(work_dir, name)
+
+    subprocess.run([binary('synthesize'),
+        '--student_file', path('student.tab'),
+        '--enrollment_file', path('enrollment.tab'),
+        '--num_students', str(args.num_students),
+        '--seed', str(args.seed)], check=True)
+
+    reports = {}
+    reports['serialize'] = run_step('serialize', [binary('serialize'),
+        '--student_file', path('student.tab'),
+        '--enrollment_file', path('enrollment.tab'),
+        '--student_archive_path', path('student_archive.txt'),
+        '--course_archive_path', path('course_archive.txt')], work_dir)
+
+    archive_args = ['--student_archive_path', path('student_archive.txt'),
+                    '--course_archive_path', path('course_archive.txt')]
+    reports['build'] = run_step('build', [binary('build'),
+        '--weighting_function', args.weighting_function,
+        '--threads', str(args.threads), '--progress_period', '0'] +
+        archive_args, work_dir, path('student_network.txt'))
+
+    os.makedirs(path('output'), exist_ok=True)
+    with open(path('pipeline.txt'), 'w') as f:
+        f.write(PIPELINE)
+    reports['analyze'] = run_step('analyze', [binary('analyze'),
+        '--student_network_archive_path', path('student_network.txt'),
+        '--pipeline_path', path('pipeline.txt'),
+        '--threads', str(args.threads)] + archive_args, work_dir)
+
+    outputs = ['student_archive.txt', 'course_archive.txt',
+               'student_network.txt']
+    outputs += [os.path.join('output', name)
+                for name in sorted(os.listdir(path('output')))]
+    checksums = {name: checksum(path(name)) for name in outputs}
+    return ({step: {metric: report[metric] for metric in METRICS}
+             for step, report in reports.items()}, checksums)
+
+
+def best_of(runs):
+    """Returns the lowest value of every metric over the runs of a step."""
+
+    return {step: {metric: min(run[step][metric] for run in runs)
+                   for metric in METRICS}
+            for step in runs[0]}
+
+
+def find_regressions(baseline_metrics, metrics, threshold):
+    """Returns a description of every metric that regressed.
+
+    A metric regresses if it's more than threshold (a fraction) above its
+    baseline. Steps or metrics missing from the baselines are skipped.
+    """
+
+    regressions = []
+    for step, step_metrics in sorted(metrics.items()):
+        for metric, value in sorted(step_metrics.items()):
+            baseline = baseline_metrics.get(step, {}).get(metric)
+            if baseline is None:
+                continue
+            limit = baseline * (1 + threshold)
+            if metric == 'wall_seconds':
+                limit = max(limit, baseline + MIN_SECONDS)
+            if value > limit:
+                regressions.append('{} {}: {:g} is {:.1%} above the baseline '
+                    'of {:g}'.format(step, metric, value,
+                                     value / baseline - 1, baseline))
+    return regressions
+
+
+def find_changed_outputs(baseline_checksums, checksums):
+    """Returns the names of outputs that differ from the baselines."""
+
+    names = set(baseline_checksums) | set(checksums)
+    return sorted(name for name in names
+                  if baseline_checksums.get(name) != checksums.get(name))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Run a fixed synthetic '
+        'workload and compare its performance against stored baselines')
+    parser.add_argument('--binary-dir', dest='binary_dir',
+        default=os.path.join('build', 'src'),
+        help='Directory containing the built binaries.')
+    parser.add_argument('--baselines', dest='baselines',
+        default='perf_baselines.json', help='Path of the baselines file.')
+    parser.add_argument('--threshold', dest='threshold', type=float,
+        default=0.2, help='Fraction by which a metric may exceed its '
+        'baseline before it\'s a regression.')
+    parser.add_argument('--repetitions', dest='repetitions', type=int,
+        default=3, help='Times to run the workload, the best run counts.')
+    parser.add_argument('--num-students', dest='num_students', type=int,
+        default=1000, help='Number of synthetic students.')
+    parser.add_argument('--seed', dest='seed', type=int, default=1,
+        help='Seed of the synthetic data.')
+    parser.add_argument('--threads', dest='threads', type=int, default=1,
+        help='Threads used by build and analyze.')
+    parser.add_argument('--weighting-function', dest='weighting_function',
+        default='CreditHoursOverEnrollment',
+        help='Weighting function of the student network.')
+    parser.add_argument('--update', dest='update', action='store_true',
+        help='Record the results as the new baselines.')
+
+    args = parser.parse_args()
+    workload = {'num_students': args.num_students, 'seed': args.seed,
+                'threads': args.threads,
+                'weighting_function': args.weighting_function}
+
+    runs = []
+    checksums = None
+    for _ in range(args.repetitions):
+        with tempfile.TemporaryDirectory() as work_dir:
+            run_metrics, run_checksums = run_workload(
+                    os.path.abspath(args.binary_dir), work_dir, args)
+        runs.append(run_metrics)
+        if checksums is not None and run_checksums != checksums:
+            sys.exit('Outputs differ between runs: {}'.format(', '.join(
+                find_changed_outputs(checksums, run_checksums))))
+        checksums = run_checksums
+    metrics = best_of(runs)
+
+    for step, step_metrics in metrics.items():
+        print('{}: {:.3f} s, {} KB peak resident memory'.format(
+            step, step_metrics['wall_seconds'], step_metrics['peak_rss_kb']))
+
+    results = {'host': platform.node(), 'workload': workload,
+               'metrics': metrics, 'checksums': checksums}
+    if args.update or not os.path.exists(args.baselines):
+        with open(args.baselines, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+        print('Recorded baselines in {}'.format(args.baselines))
+        sys.exit(0)
+
+    with open(args.baselines) as f:
+        baselines = json.load(f)
+    if baselines['workload'] != workload:
+        sys.exit('The baselines were recorded for the workload {}, rerun with '
+                 '--update to replace them'.format(baselines['workload']))
+    if baselines['host'] != platform.node():
+        print('Warning: the baselines were recorded on {}'.format(
+            baselines['host']))
+
+    failures = find_regressions(baselines['metrics'], metrics, args.threshold)
+    failures += ['{} changed'.format(name) for name in
+                 find_changed_outputs(baselines['checksums'], checksums)]
+    for failure in failures:
+        print(failure)
+    sys.exit(1 if failures else 0)
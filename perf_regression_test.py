@@ -0,0 +1,63 @@
+"""Tests for perf_regression module."""
+
+__author__ = "karepker@umich.edu Kar Epker"
+__copyright__ = "Kar Epker, 2015"
+
+
+import unittest
+
+import perf_regression
+
+
+class PerfRegressionTest(unittest.TestCase):
+    """Tests perf_regression module."""
+
+    def test_best_of(self):
+        """Tests best_of."""
+
+        runs = [{'build': {'wall_seconds': 2.0, 'peak_rss_kb': 100}},
+                {'build': {'wall_seconds': 1.5, 'peak_rss_kb': 120}}]
+        expected = {'build': {'wall_seconds': 1.5, 'peak_rss_kb': 100}}
+        self.assertEqual(perf_regression.best_of(runs), expected)
+
+    def test_find_regressions(self):
+        """Tests find_regressions."""
+
+        baselines = {'build': {'wall_seconds': 10.0, 'peak_rss_kb': 1000},
+                     'serialize': {'wall_seconds': 0.01, 'peak_rss_kb': 500}}
+
+        # test 1 (within the threshold)
+        metrics1 = {'build': {'wall_seconds': 11.9, 'peak_rss_kb': 1100}}
+        self.assertEqual(
+                perf_regression.find_regressions(baselines, metrics1, 0.2), [])
+
+        # test 2 (both metrics regressed)
+        metrics2 = {'build': {'wall_seconds': 12.5, 'peak_rss_kb': 1300}}
+        regressions2 = perf_regression.find_regressions(
+                baselines, metrics2, 0.2)
+        self.assertEqual(len(regressions2), 2)
+        self.assertTrue(regressions2[0].startswith('build peak_rss_kb: 1300'))
+        self.assertTrue(regressions2[1].startswith('build wall_seconds: 12.5'))
+
+        # test 3 (tiny timings are noise)
+        metrics3 = {'serialize': {'wall_seconds': 0.05, 'peak_rss_kb': 500}}
+        self.assertEqual(
+                perf_regression.find_regressions(baselines, metrics3, 0.2), [])
+
+        # test 4 (steps without baselines are skipped)
+        metrics4 = {'analyze': {'wall_seconds': 100.0, 'peak_rss_kb': 1}}
+        self.assertEqual(
+                perf_regression.find_regressions(baselines, metrics4, 0.2), [])
+
+    def test_find_changed_outputs(self):
+        """Tests find_changed_outputs."""
+
+        baselines = {'a': '1', 'b': '2', 'c': '3'}
+        checksums = {'a': '1', 'b': '4', 'd': '5'}
+        self.assertEqual(
+                perf_regression.find_changed_outputs(baselines, checksums),
+                ['b', 'c', 'd'])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,113 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+
+// Threads beyond this many share the last slot.
+const int max_counted_threads{256};
+const std::size_t cache_line_size{64};
+
+
+// The counts of a thread, on its own cache line. Nothing here may allocate,
+// so the slots are a static array and a thread claims one with an index.
+struct alignas(cache_line_size) AllocationSlot {
+	std::atomic<long> allocations, deallocations, allocated_bytes;
+};
+
+// Zero initialized before any code runs, so allocations made during static
+// initialization are counted too.
+static AllocationSlot slots[max_counted_threads];
+static std::atomic<int> num_slots_claimed;
+
+
+static AllocationSlot& GetThreadSlot() {
+	thread_local AllocationSlot* thread_slot{nullptr};
+	if (!thread_slot) {
+		auto slot_index = num_slots_claimed.fetch_add(1);
+		thread_slot = &slots[slot_index < max_counted_threads ?
+			slot_index : max_counted_threads - 1];
+	}
+	return *thread_slot;
+}
+
+
+static void* CountedAllocate(std::size_t size) {
+	auto& slot = GetThreadSlot();
+	slot.allocations.fetch_add(1, std::memory_order_relaxed);
+	slot.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+
+static void CountedFree(void* pointer) {
+	if (!pointer) { return; }
+	GetThreadSlot().deallocations.fetch_add(1, std::memory_order_relaxed);
+	std::free(pointer);
+}
+
+
+void* operator new(std::size_t size) {
+	if (auto pointer = CountedAllocate(size)) { return pointer; }
+	throw std::bad_alloc{};
+}
+
+
+void* operator new[](std::size_t size) {
+	if (auto pointer = CountedAllocate(size)) { return pointer; }
+	throw std::bad_alloc{};
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{ return CountedAllocate(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{ return CountedAllocate(size); }
+
+void operator delete(void* pointer) noexcept { CountedFree(pointer); }
+
+void operator delete[](void* pointer) noexcept { CountedFree(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept
+{ CountedFree(pointer); }
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{ CountedFree(pointer); }
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{ CountedFree(pointer); }
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{ CountedFree(pointer); }
+
+
+bool AllocationCountingEnabled() { return true; }
+
+
+AllocationCounts GetAllocationCounts() {
+	AllocationCounts counts{0, 0, 0};
+	int num_slots{std::min(num_slots_claimed.load(), max_counted_threads)};
+	for (int i{0}; i < num_slots; ++i) {
+		counts.allocations +=
+			slots[i].allocations.load(std::memory_order_relaxed);
+		counts.deallocations +=
+			slots[i].deallocations.load(std::memory_order_relaxed);
+		counts.allocated_bytes +=
+			slots[i].allocated_bytes.load(std::memory_order_relaxed);
+	}
+	return counts;
+}
+
+#else
+
+bool AllocationCountingEnabled() { return false; }
+
+AllocationCounts GetAllocationCounts() { return {0, 0, 0}; }
+
+#endif  // ENABLE_ALLOCATION_TRACKING
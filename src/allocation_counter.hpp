@@ -0,0 +1,24 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+
+// Heap allocations made through operator new and delete by every thread of
+// the process. They're only counted in builds with ENABLE_ALLOCATION_TRACKING
+// defined (cmake -Dallocation_tracking=ON), which replace the global
+// operators with ones that count into a slot per thread. Otherwise every
+// count is 0. The metrics report shows the counts of every phase.
+struct AllocationCounts {
+	long allocations;
+	long deallocations;
+	long allocated_bytes;
+};
+
+// Whether this build counts allocations.
+bool AllocationCountingEnabled();
+
+// Returns the counts summed over every thread so far. Subtract two results
+// to get the allocations made in between.
+AllocationCounts GetAllocationCounts();
+
+
+#endif  // ALLOCATION_COUNTER_H
@@ -0,0 +1,35 @@
+#include "allocation_counter.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+
+using std::unique_ptr;
+using std::vector;
+
+
+TEST(AllocationCounterTest, GetAllocationCounts) {
+	auto start = GetAllocationCounts();
+	{
+		unique_ptr<int> number{new int{1}};
+		vector<char> bytes(1000);
+		std::thread{[]() { unique_ptr<int[]> numbers{new int[100]}; }}.join();
+	}
+	auto end = GetAllocationCounts();
+
+	if (!AllocationCountingEnabled()) {
+		EXPECT_EQ(0, end.allocations);
+		EXPECT_EQ(0, end.deallocations);
+		EXPECT_EQ(0, end.allocated_bytes);
+		return;
+	}
+
+	// starting the thread may allocate too
+	EXPECT_GE(end.allocations - start.allocations, 3);
+	EXPECT_GE(end.deallocations - start.deallocations, 3);
+	EXPECT_GE(end.allocated_bytes - start.allocated_bytes,
+			  static_cast<long>(sizeof(int) + 1000 + 100 * sizeof(int)));
+}
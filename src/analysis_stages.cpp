@@ -0,0 +1,517 @@
+#include "analysis_stages.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "edge_checksum.hpp"
+#include "metrics.hpp"
+#include "reduce_network.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "student_sample.hpp"
+#include "thread_safe_range_action.hpp"
+#include "trace.hpp"
+
+
+using std::accumulate; using std::min; using std::transform;
+using std::begin; using std::back_inserter; using std::end;
+using std::endl;
+using std::function;
+using std::invalid_argument; using std::runtime_error;
+using std::make_shared;
+using std::map;
+using std::ofstream; using std::ostream; using std::ostringstream;
+using std::make_pair; using std::pair;
+using std::string; using std::to_string;
+using std::vector;
+
+using boost::algorithm::join;
+using boost::counting_iterator;
+
+
+// Number of ego networks held in memory between writes by SaveEgoNetworks.
+const std::size_t ego_batch_size{1024};
+
+
+// Functions getting the description of a field of a student.
+const map<string, function<string(const Student&)>> cohort_fields{
+	{"major1", [](const Student& student)
+		{ return student.GetMajor1Description(); }},
+	{"major2", [](const Student& student)
+		{ return student.GetMajor2Description(); }},
+	{"school", [](const Student& student) { return student.school(); }},
+	{"gender", [](const Student& student)
+		{ return student.GetGenderDescription(); }},
+	{"ethnicity", [](const Student& student)
+		{ return student.GetEthnicityDescription(); }},
+};
+
+
+const map<string, EdgeAggregate_e> aggregate_names{
+	{"sum", EdgeAggregate_e::Sum},
+	{"count", EdgeAggregate_e::Count},
+	{"min", EdgeAggregate_e::Min},
+	{"max", EdgeAggregate_e::Max},
+};
+
+
+CohortFilter ParseCohortFilter(const string& cohort) {
+	if (cohort == "all") { return [](const Student&) { return true; }; }
+
+	auto separator = cohort.find(':');
+	if (separator == string::npos) {
+		throw invalid_argument{"Cohort \"" + cohort +
+			"\" is not of the form <field>:<value>"};
+	}
+
+	auto field_it = cohort_fields.find(cohort.substr(0, separator));
+	if (field_it == cohort_fields.end()) {
+		throw invalid_argument{"Unknown cohort field in \"" + cohort + "\""};
+	}
+
+	auto field = field_it->second;
+	auto value = cohort.substr(separator + 1);
+	return [field, value](const Student& student)
+	{ return field(student) == value; };
+}
+
+
+EdgeAggregate_e ParseEdgeAggregate(const string& aggregate) {
+	auto aggregate_it = aggregate_names.find(aggregate);
+	if (aggregate_it == aggregate_names.end())
+	{ throw invalid_argument{"Unknown aggregate \"" + aggregate + "\""}; }
+	return aggregate_it->second;
+}
+
+
+bool IsGroupingName(const string& grouping)
+{ return cohort_fields.count(grouping) == 1; }
+
+
+ofstream OpenOutputFile(const string& path) {
+	ofstream output{path};
+	if (!output.is_open())
+	{ throw runtime_error{"Could not open \"" + path + "\" for writing!"}; }
+	return output;
+}
+
+
+void ReportSavedEdges(const string& path, const EdgeChecksum& checksum)
+{ SetLabel("edge_checksum:" + path, checksum.ToString()); }
+
+
+void SaveDegreeSums(const StudentNetwork& network, ostream& weighted_output,
+					ostream& unweighted_output) {
+	TRACE_SCOPE("degree_sums");
+	for (const auto& student_d : network.GetVertexDescriptors()) {
+		auto out_edges = network.GetOutEdgeValues(student_d);
+		auto weighted_sum = accumulate(begin(out_edges), end(out_edges), 0.);
+		auto unweighted_sum = out_edges.size();
+		weighted_output << network[student_d] << '\t' << weighted_sum << '\n';
+		unweighted_output << network[student_d] << '\t' << unweighted_sum
+						  << '\n';
+	}
+}
+
+
+// Throws if a vertex of the network isn't a sampled student, e.g. when the
+// network was built from another sample.
+static void CheckSampledNetwork(const StudentNetwork& network,
+								const StudentSample& sample) {
+	for (const auto& student_d : network.GetVertexDescriptors()) {
+		if (!sample.Contains(network[student_d])) {
+			throw invalid_argument{"Student " + to_string(network[student_d])
+				+ " of the network isn't in the sample!"};
+		}
+	}
+}
+
+
+static void SaveEstimate(const SampleEstimate& estimate, ostream& output) {
+	output << estimate.sample_value << '\t' << estimate.scaling_factor()
+		   << '\t' << estimate.value << '\t' << estimate.standard_error
+		   << '\t' << estimate.lower() << '\t' << estimate.upper() << '\n';
+}
+
+
+void SaveDegreeSumEstimates(const StudentNetwork& network,
+							const StudentSample& sample,
+							ostream& weighted_output,
+							ostream& unweighted_output,
+							ostream& summary_output) {
+	TRACE_SCOPE("degree_sum_estimates");
+	CheckSampledNetwork(network, sample);
+	auto num_replicates = sample.num_replicates();
+	auto fraction = sample.sampling_fraction();
+
+	// a student's neighbors are a sample of the other students, every edge of
+	// the network one of the sampled pairs
+	JackknifeTotal edges{num_replicates, 2, fraction},
+				   weight{num_replicates, 2, fraction};
+	for (const auto& student_d : network.GetVertexDescriptors()) {
+		auto student = network[student_d];
+		auto replicate = sample.GetReplicate(student);
+		JackknifeTotal weighted_sum{num_replicates, 1, fraction},
+					   unweighted_sum{num_replicates, 1, fraction};
+		for (const auto& edge_d : network.GetOutEdgeDescriptors(student_d)) {
+			auto other = network[network.GetTargetDescriptor(edge_d)];
+			auto probability = sample.GetConditionalProbability(student, other);
+			auto other_replicate = sample.GetReplicate(other);
+			weighted_sum.Add(network[edge_d], probability, other_replicate);
+			unweighted_sum.Add(1., probability, other_replicate);
+
+			if (student >= other) { continue; }
+			auto pair_probability = sample.GetPairProbability(student, other);
+			edges.Add(1., pair_probability, replicate, other_replicate);
+			weight.Add(network[edge_d], pair_probability, replicate,
+					other_replicate);
+		}
+
+		auto weighted_estimate = weighted_sum.Estimate();
+		auto unweighted_estimate = unweighted_sum.Estimate();
+		weighted_output << student << '\t' << weighted_estimate.value << '\t'
+						<< weighted_estimate.lower() << '\t'
+						<< weighted_estimate.upper() << '\n';
+		unweighted_output << student << '\t' << unweighted_estimate.value
+						  << '\t' << unweighted_estimate.lower() << '\t'
+						  << unweighted_estimate.upper() << '\n';
+	}
+
+	// every edge adds to the degree of both its students
+	auto edges_estimate = edges.Estimate();
+	auto weight_estimate = weight.Estimate();
+	double population_size = sample.population_size();
+	summary_output << "edges\t";
+	SaveEstimate(edges_estimate, summary_output);
+	summary_output << "total_weight\t";
+	SaveEstimate(weight_estimate, summary_output);
+	summary_output << "mean_degree\t";
+	SaveEstimate({2. * edges_estimate.sample_value / sample.size(),
+			2. * edges_estimate.value / population_size,
+			2. * edges_estimate.standard_error / population_size},
+			summary_output);
+	summary_output << "mean_weighted_degree\t";
+	SaveEstimate({2. * weight_estimate.sample_value / sample.size(),
+			2. * weight_estimate.value / population_size,
+			2. * weight_estimate.standard_error / population_size},
+			summary_output);
+}
+
+
+// A grouping encoded for ReduceNetworkMulti along with a function that saves
+// a reduced network of the grouping's vertex type.
+struct EncodedGrouping {
+	const vector<int>* group_ids;
+	std::size_t num_groups;
+	function<EdgeChecksum(const AggregateMatrix&, ostream&)> save;
+};
+
+
+template <typename VertexFunc>
+static EncodedGrouping EncodeGrouping(const StudentNetwork& network,
+									  VertexFunc vertex_func) {
+	auto grouping = make_shared<decltype(
+			EncodeVertexGrouping(network, vertex_func))>(
+				EncodeVertexGrouping(network, vertex_func));
+
+	// counts are saved as integers, every other aggregate as a double
+	auto save = [grouping](const AggregateMatrix& matrix, ostream& output) {
+		if (matrix.aggregate() == EdgeAggregate_e::Count) {
+			return MakeReducedNetwork<int>(
+					*grouping, matrix).SaveEdgewise(output);
+		}
+		return MakeReducedNetwork<double>(
+				*grouping, matrix).SaveEdgewise(output);
+	};
+	return {&grouping->group_ids, grouping->groups.size(), save};
+}
+
+
+static EncodedGrouping EncodeGrouping(const StudentNetwork& network,
+									  const StudentContainer& students,
+									  const string& grouping) {
+	// keep the ethnicity enum so the reduced vertices sort like before
+	if (grouping == "ethnicity") {
+		return EncodeGrouping(network, [&students](const Student::Id& id)
+				{ return students.Find(id).ethnicity(); });
+	}
+
+	auto field = cohort_fields.at(grouping);
+	return EncodeGrouping(network, [&students, field](const Student::Id& id)
+			{ return field(students.Find(id)); });
+}
+
+
+// Reduces the network by every grouping and aggregate in reductions, then
+// saves reduction i to get_output(i). Returns the checksums of the saved edges.
+template <typename GetOutput>
+static vector<EdgeChecksum> SaveReductions(
+		const StudentNetwork& network, const StudentContainer& students,
+		const vector<ReductionOutput>& reductions, GetOutput get_output) {
+	// encode each grouping only once
+	map<string, EncodedGrouping> groupings;
+	vector<Reduction> encoded_reductions;
+	for (const auto& reduction : reductions) {
+		auto grouping_it = groupings.find(reduction.grouping);
+		if (grouping_it == groupings.end()) {
+			grouping_it = groupings.emplace(reduction.grouping, EncodeGrouping(
+						network, students, reduction.grouping)).first;
+		}
+		encoded_reductions.push_back({grouping_it->second.group_ids,
+				grouping_it->second.num_groups, reduction.aggregate});
+	}
+
+	auto reduced = ReduceNetworkMulti(network, encoded_reductions);
+	vector<EdgeChecksum> checksums;
+	for (std::size_t i{0}; i < reductions.size(); ++i) {
+		checksums.push_back(groupings.at(reductions[i].grouping).save(
+					reduced[i], get_output(i)));
+	}
+	return checksums;
+}
+
+
+void SaveReductions(const StudentNetwork& network,
+					const StudentContainer& students,
+					const vector<ReductionOutput>& outputs) {
+	TRACE_SCOPE("reductions");
+	// files are opened one at a time as the reductions are saved
+	ofstream output_file;
+	auto checksums = SaveReductions(network, students, outputs,
+			[&outputs, &output_file](std::size_t i) -> ostream& {
+				output_file = OpenOutputFile(outputs[i].output_path);
+				return output_file;
+			});
+	for (std::size_t i{0}; i < outputs.size(); ++i)
+	{ ReportSavedEdges(outputs[i].output_path, checksums[i]); }
+}
+
+
+EdgeChecksum SaveReduction(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const ReductionOutput& reduction,
+						   ostream& output) {
+	TRACE_SCOPE("reduction");
+	return SaveReductions(network, students, {reduction},
+			[&output](std::size_t) -> ostream& { return output; }).front();
+}
+
+
+void SaveReductionEstimate(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const StudentSample& sample,
+						   const ReductionOutput& reduction,
+						   ostream& output) {
+	TRACE_SCOPE("reduction_estimate");
+	if (reduction.aggregate != EdgeAggregate_e::Sum &&
+			reduction.aggregate != EdgeAggregate_e::Count) {
+		throw invalid_argument{"Only sums and counts of a sample can be "
+			"estimated!"};
+	}
+	CheckSampledNetwork(network, sample);
+
+	// the groups of a pair are ordered, as the network is undirected
+	auto field = cohort_fields.at(reduction.grouping);
+	map<pair<string, string>, JackknifeTotal> cells;
+	for (const auto& edge_d : network.GetEdgeDescriptors()) {
+		auto student1 = network.GetSourceValue(edge_d);
+		auto student2 = network.GetTargetValue(edge_d);
+		auto group1 = field(students.Find(student1));
+		auto group2 = field(students.Find(student2));
+		auto groups = group1 < group2 ? make_pair(group1, group2) :
+			make_pair(group2, group1);
+		auto cell_it = cells.emplace(groups,
+				JackknifeTotal{sample.num_replicates(), 2,
+					sample.sampling_fraction()}).first;
+		auto value = reduction.aggregate == EdgeAggregate_e::Sum ?
+			network[edge_d] : 1.;
+		cell_it->second.Add(value, sample.GetPairProbability(student1,
+					student2), sample.GetReplicate(student1),
+				sample.GetReplicate(student2));
+	}
+
+	for (const auto& cell : cells) {
+		auto estimate = cell.second.Estimate();
+		output << cell.first.first << '\t' << cell.first.second << '\t'
+			   << estimate.sample_value << '\t' << estimate.scaling_factor()
+			   << '\t' << estimate.value << '\t' << estimate.lower() << '\t'
+			   << estimate.upper() << '\n';
+	}
+}
+
+
+// Writes a line "<student>\t<distance 1>\t...\t<distance n>" for every student
+// in the cohort. FindDistances maps a vertex to its distances.
+template <typename FindDistances>
+static void SaveDistances(const StudentNetwork& network,
+						  const StudentContainer& students,
+						  const CohortFilter& filter,
+						  ostream& output,
+						  FindDistances find_distances) {
+	TRACE_SCOPE("distances");
+	for (auto vertex_d : network.GetVertexDescriptors()) {
+		auto student_id = network[vertex_d];
+
+		// Determine whether or not we should process this student.
+		if (!filter(students.Find(student_id))) { continue; }
+
+		output << student_id << "\t";
+
+		// get the second member of the pair
+		auto distances = find_distances(vertex_d);
+		auto distance_values = vector<string>{};
+		transform(begin(distances), end(distances),
+				back_inserter(distance_values),
+				[](pair<Student::Id, double> elt)
+				{ return to_string(elt.second); });
+		output << join(distance_values, "\t") << '\n';
+	}
+}
+
+
+void SaveWeightedDistances(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const CohortFilter& filter,
+						   ostream& output,
+						   const student_delta_stepping_t* delta_stepping) {
+	SaveDistances(network, students, filter, output,
+			[&network, delta_stepping](StudentNetwork::vertex_t vertex_d) {
+				return delta_stepping ?
+					delta_stepping->FindDistances(vertex_d) :
+					network.FindWeightedDistances(vertex_d);
+			});
+}
+
+
+void SaveUnweightedDistances(const StudentNetwork& network,
+							 const StudentContainer& students,
+							 const CohortFilter& filter,
+							 ostream& output) {
+	SaveDistances(network, students, filter, output,
+			[&network](StudentNetwork::vertex_t vertex_d)
+			{ return network.FindUnweightedDistances(vertex_d); });
+}
+
+
+/* Saves an indidivual student's network to the given file in the form:
+ * <connected student 1>\t<edge weight of connected student 1>
+ * <connected student 2>\t<edge weight of connected student 2>
+ * ...
+ * <connected student n>\t<edge weight of connected student n>
+ */
+void SaveIndividualStudentNetworks(const StudentNetwork& network,
+								   const StudentContainer& students,
+								   const CohortFilter& filter,
+								   const string& path_prefix) {
+	TRACE_SCOPE("ego_networks");
+	EdgeChecksum checksum;
+	for (auto student_d : network.GetVertexDescriptors()) {
+		auto student_id = network[student_d];
+		if (!filter(students.Find(student_id))) { continue; }
+
+		auto individual_network = OpenOutputFile(
+				path_prefix + to_string(student_id) + ".tsv");
+		for (const auto& edge_d : network.GetOutEdgeDescriptors(student_d)) {
+			individual_network << network.GetTargetValue(edge_d) << "\t"
+							   << network[edge_d] << '\n';
+			checksum.AddEdge(student_id, network.GetTargetValue(edge_d),
+					GetWrittenWeight(network[edge_d],
+						individual_network.precision()));
+		}
+	}
+	ReportSavedEdges(path_prefix + "*.tsv", checksum);
+}
+
+
+vector<StudentNetwork::vertex_t> FindCohortVertices(
+		const StudentNetwork& network, const StudentContainer& students,
+		const CohortFilter& filter) {
+	vector<StudentNetwork::vertex_t> vertices;
+	for (auto vertex_d : network.GetVertexDescriptors()) {
+		if (filter(students.Find(network[vertex_d])))
+		{ vertices.push_back(vertex_d); }
+	}
+	return vertices;
+}
+
+
+vector<StudentNetwork::vertex_t> FindStudentVertices(
+		const StudentNetwork& network, const vector<Student::Id>& student_ids) {
+	auto index = network.GetVertexIndex();
+	vector<StudentNetwork::vertex_t> vertices;
+	for (auto student_id : student_ids) {
+		auto vertex_it = index.find(student_id);
+		if (vertex_it == index.end()) {
+			throw invalid_argument{"Student " + to_string(student_id) +
+				" is not in the network"};
+		}
+		vertices.push_back(vertex_it->second);
+	}
+	return vertices;
+}
+
+
+EdgeChecksum SaveEgoNetworks(const StudentNetwork& network,
+							 const vector<StudentNetwork::vertex_t>& egos,
+							 ostream& data_output, ostream& index_output) {
+	TRACE_SCOPE("ego_networks");
+	using index_it_t = counting_iterator<std::size_t>;
+
+	std::size_t offset{0};
+	vector<string> blocks;
+	vector<EdgeChecksum> block_checksums;
+	EdgeChecksum checksum;
+	for (std::size_t batch_begin{0}; batch_begin < egos.size();
+			batch_begin += ego_batch_size) {
+		auto batch_end = min(batch_begin + ego_batch_size, egos.size());
+		blocks.assign(batch_end - batch_begin, string{});
+		block_checksums.assign(batch_end - batch_begin, EdgeChecksum{});
+
+		// format the batch in parallel, then write it in order
+		PerformFunctionOnRange(
+				[&network, &egos, &blocks, &block_checksums, batch_begin](
+					index_it_t first, index_it_t last) {
+					for (auto ego_it = first; ego_it != last; ++ego_it) {
+						auto ego = egos[*ego_it];
+						ostringstream block;
+						auto& block_checksum =
+							block_checksums[*ego_it - batch_begin];
+						for (const auto& edge_d :
+								network.GetOutEdgeDescriptors(ego)) {
+							block << network[ego] << '\t'
+								  << network.GetTargetValue(edge_d) << '\t'
+								  << network[edge_d] << '\n';
+							block_checksum.AddEdge(network[ego],
+									network.GetTargetValue(edge_d),
+									GetWrittenWeight(network[edge_d],
+										block.precision()));
+						}
+						blocks[*ego_it - batch_begin] = block.str();
+					}
+				}, index_it_t{batch_begin}, index_it_t{batch_end});
+
+		for (std::size_t i{0}; i < blocks.size(); ++i) {
+			data_output << blocks[i];
+			index_output << network[egos[batch_begin + i]] << '\t' << offset
+						 << '\t' << blocks[i].size() << '\n';
+			offset += blocks[i].size();
+			checksum.Combine(block_checksums[i]);
+		}
+	}
+	return checksum;
+}
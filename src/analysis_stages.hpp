@@ -0,0 +1,150 @@
+#ifndef ANALYSIS_STAGES_H
+#define ANALYSIS_STAGES_H
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "delta_stepping.hpp"
+#include "edge_checksum.hpp"
+#include "reduce_network.hpp"
+#include "student.hpp"
+#include "student_network.hpp"
+
+
+class StudentContainer;
+class StudentSample;
+
+
+// Analyses of a loaded student network shared by the network_processing
+// binaries and the analyze pipeline driver. None of them modify the network or
+// the students, so they may run concurrently.
+
+using student_delta_stepping_t = DeltaStepping<Student::Id, double>;
+
+// Selects the students an analysis applies to.
+using CohortFilter = std::function<bool(const Student&)>;
+
+// Parses a cohort of the form "<field>:<value>" or "all". Fields are major1,
+// major2, school, gender and ethnicity, and values are compared against the
+// student's description of the field, e.g. "major1:General Studies".
+// Throws std::invalid_argument for an unknown field.
+CohortFilter ParseCohortFilter(const std::string& cohort);
+
+// Parses "sum", "count", "min" or "max". Throws std::invalid_argument.
+EdgeAggregate_e ParseEdgeAggregate(const std::string& aggregate);
+
+// Returns whether SaveReductions knows how to group by the given field.
+bool IsGroupingName(const std::string& grouping);
+
+// Opens a file for writing, throws std::runtime_error if it can't be opened.
+std::ofstream OpenOutputFile(const std::string& path);
+
+// Reports the checksum of the edges saved to path as the
+// "edge_checksum:<path>" label of the metrics report, so the file can be
+// checked against the network's build.
+void ReportSavedEdges(const std::string& path, const EdgeChecksum& checksum);
+
+
+// Writes "<student>\t<sum of edge weights>" and "<student>\t<degree>" lines.
+void SaveDegreeSums(const StudentNetwork& network,
+					std::ostream& weighted_output,
+					std::ostream& unweighted_output);
+
+
+// Estimates the degree sums of every student of the network of a sample from
+// their sampled neighbors, writing "<student>\t<estimate>\t<lower>\t<upper>"
+// lines with the 95% confidence interval. The summary gets a
+// "<statistic>\t<sample value>\t<scaling factor>\t<estimate>\t<standard
+// error>\t<lower>\t<upper>" line for the edges, total weight, mean degree and
+// mean weighted degree of the whole network. Throws std::invalid_argument if
+// the network isn't that of the sample.
+void SaveDegreeSumEstimates(const StudentNetwork& network,
+							const StudentSample& sample,
+							std::ostream& weighted_output,
+							std::ostream& unweighted_output,
+							std::ostream& summary_output);
+
+
+struct ReductionOutput {
+	std::string grouping;
+	EdgeAggregate_e aggregate;
+	std::string output_path;
+};
+
+// Reduces the network by every requested grouping and aggregate in a single
+// pass over the edges and saves each reduced network edgewise, reporting the
+// edges saved to every output.
+void SaveReductions(const StudentNetwork& network,
+					const StudentContainer& students,
+					const std::vector<ReductionOutput>& outputs);
+
+// Saves a single reduction to output, output_path is ignored. Returns the
+// checksum of the saved edges.
+EdgeChecksum SaveReduction(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const ReductionOutput& reduction,
+						   std::ostream& output);
+
+
+// Estimates a sum or count reduction of the whole network from the network of
+// a sample, writing a "<group 1>\t<group 2>\t<sample value>\t<scaling
+// factor>\t<estimate>\t<lower>\t<upper>" line for every pair of groups
+// connected in the sample. Throws std::invalid_argument for a min or max, or
+// if the network isn't that of the sample.
+void SaveReductionEstimate(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const StudentSample& sample,
+						   const ReductionOutput& reduction,
+						   std::ostream& output);
+
+
+// Writes the weighted distances from every student in the cohort to every
+// other connected student, one student per line. If delta_stepping is given,
+// it is used in place of Dijkstra.
+void SaveWeightedDistances(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const CohortFilter& filter,
+						   std::ostream& output,
+						   const student_delta_stepping_t* delta_stepping);
+
+// Same as SaveWeightedDistances with the number of steps between students.
+void SaveUnweightedDistances(const StudentNetwork& network,
+							 const StudentContainer& students,
+							 const CohortFilter& filter,
+							 std::ostream& output);
+
+
+// Saves the network of every student in the cohort to
+// "<path_prefix><student id>.tsv", reporting the edges of all of them as
+// "<path_prefix>*.tsv".
+void SaveIndividualStudentNetworks(const StudentNetwork& network,
+								   const StudentContainer& students,
+								   const CohortFilter& filter,
+								   const std::string& path_prefix);
+
+// Returns the vertices of the students in the cohort in network order.
+std::vector<StudentNetwork::vertex_t> FindCohortVertices(
+		const StudentNetwork& network, const StudentContainer& students,
+		const CohortFilter& filter);
+
+// Resolves students to their vertices through the network's vertex index.
+// Throws std::invalid_argument for a student that isn't in the network.
+std::vector<StudentNetwork::vertex_t> FindStudentVertices(
+		const StudentNetwork& network,
+		const std::vector<Student::Id>& student_ids);
+
+// Saves the networks of all the egos to a single data file, one
+// "<ego>\t<connected student>\t<edge weight>" line per edge, grouped by ego.
+// The index gets one "<ego>\t<byte offset>\t<byte length>" line per ego
+// giving where its lines are in the data file, so readers can seek to it.
+// Networks are formatted in parallel and written in the order of egos. Returns
+// the checksum of the lines' edges, an edge between two egos is in it twice.
+EdgeChecksum SaveEgoNetworks(const StudentNetwork& network,
+							 const std::vector<StudentNetwork::vertex_t>& egos,
+							 std::ostream& data_output,
+							 std::ostream& index_output);
+
+
+#endif  // ANALYSIS_STAGES_H
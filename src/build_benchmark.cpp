@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include "benchmark/benchmark.h"
+
+#include "course_container.hpp"
+#include "course_network.hpp"
+#include "graph_builder.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "synthetic_data.hpp"
+#include "utility.hpp"
+#include "weighting_function.hpp"
+
+
+using std::map;
+using std::mt19937; using std::uniform_int_distribution;
+using std::ostringstream; using std::stringstream;
+using std::pair;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+using weighting_func_ptr =
+	boost::optional<double>(*)(const Student&, const Student&);
+
+
+// Number of random student pairs the weighting functions are timed over.
+const int num_weighted_pairs{100000};
+
+
+// Tabs and loaded containers of a synthetic population, generated once per
+// size and shared by every benchmark.
+struct BenchmarkData {
+	string student_tab, enrollment_tab;
+	unique_ptr<StudentContainer> students;
+	unique_ptr<CourseContainer> courses;
+	vector<pair<const Student*, const Student*>> pairs;
+};
+
+
+static const BenchmarkData& GetData(int num_students) {
+	static map<int, unique_ptr<BenchmarkData>> cache;
+	auto& data = cache[num_students];
+	if (data) { return *data; }
+
+	// course offerings grow with the university
+	SyntheticPopulation population;
+	population.num_students = num_students;
+	population.num_courses = std::max(200, num_students / 8);
+
+	data.reset(new BenchmarkData{});
+	ostringstream student_output, enrollment_output;
+	WriteSyntheticStudentTab(population, student_output);
+	WriteSyntheticEnrollmentTab(population, enrollment_output);
+	data->student_tab = student_output.str();
+	data->enrollment_tab = enrollment_output.str();
+
+	stringstream student_stream{data->student_tab};
+	stringstream enrollment_stream{data->enrollment_tab};
+	data->students.reset(new StudentContainer{
+			StudentContainer::LoadFromTsv(student_stream)});
+	data->courses.reset(new CourseContainer{
+			CourseContainer::LoadFromTsv(enrollment_stream)});
+	data->students->UpdateCourses(*data->courses);
+
+	mt19937 engine{population.seed};
+	uniform_int_distribution<int> student{0, num_students - 1};
+	auto first_student = data->students->begin();
+	for (int i{0}; i < num_weighted_pairs; ++i) {
+		data->pairs.emplace_back(&first_student[student(engine)],
+								 &first_student[student(engine)]);
+	}
+	return *data;
+}
+
+
+static void BM_LoadStudentsFromTsv(benchmark::State& state) {
+	const auto& data = GetData(state.range(0));
+	while (state.KeepRunning()) {
+		stringstream student_stream{data.student_tab};
+		auto students = StudentContainer::LoadFromTsv(student_stream);
+		benchmark::DoNotOptimize(students);
+	}
+	state.SetBytesProcessed(state.iterations() * data.student_tab.size());
+}
+BENCHMARK(BM_LoadStudentsFromTsv)->Arg(1000)->Arg(10000)->Arg(50000)
+	->Unit(benchmark::kMillisecond);
+
+
+static void BM_LoadCoursesFromTsv(benchmark::State& state) {
+	const auto& data = GetData(state.range(0));
+	while (state.KeepRunning()) {
+		stringstream enrollment_stream{data.enrollment_tab};
+		auto courses = CourseContainer::LoadFromTsv(enrollment_stream);
+		benchmark::DoNotOptimize(courses);
+	}
+	state.SetBytesProcessed(state.iterations() * data.enrollment_tab.size());
+}
+BENCHMARK(BM_LoadCoursesFromTsv)->Arg(1000)->Arg(10000)->Arg(50000)
+	->Unit(benchmark::kMillisecond);
+
+
+static void BM_UpdateCourses(benchmark::State& state) {
+	const auto& data = GetData(state.range(0));
+	while (state.KeepRunning()) {
+		// only time the update, not copying the students
+		state.PauseTiming();
+		stringstream student_stream{data.student_tab};
+		auto students = StudentContainer::LoadFromTsv(student_stream);
+		state.ResumeTiming();
+
+		students.UpdateCourses(*data.courses);
+		benchmark::DoNotOptimize(students);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UpdateCourses)->Arg(1000)->Arg(10000)->Arg(50000)
+	->Unit(benchmark::kMillisecond);
+
+
+// Arguments are the number of students and the number of threads.
+static void BM_BuildStudentNetwork(benchmark::State& state,
+								   weighting_func_ptr weighting_func) {
+	const auto& data = GetData(state.range(0));
+	num_threads = state.range(1);
+	while (state.KeepRunning()) {
+		auto network = BuildStudentNetworkFromStudents(
+				*data.students, weighting_func);
+		benchmark::DoNotOptimize(network);
+	}
+	num_threads = 1;
+
+	// every distinct pair of students is weighted
+	state.SetItemsProcessed(state.iterations() *
+			state.range(0) * (state.range(0) - 1) / 2);
+}
+// The adjacency matrix takes O(|V|^2) memory, 50k students need ~20GB.
+BENCHMARK_CAPTURE(BM_BuildStudentNetwork, credit_hours_over_enrollment,
+				  &CreditHoursOverEnrollment)
+	->Args({1000, 1})->Args({1000, 4})->Args({10000, 1})->Args({10000, 4})
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BuildStudentNetwork, inverse_enrollment,
+				  &InverseEnrollment)
+	->Args({1000, 1})->Args({1000, 4})->Args({10000, 1})->Args({10000, 4})
+	->Unit(benchmark::kMillisecond);
+
+
+static void BM_BuildCourseNetwork(benchmark::State& state) {
+	const auto& data = GetData(state.range(0));
+	while (state.KeepRunning()) {
+		auto network = BuildCourseNetworkFromEnrollment(*data.students);
+		benchmark::DoNotOptimize(network);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildCourseNetwork)->Arg(1000)->Arg(10000)->Arg(50000)
+	->Unit(benchmark::kMillisecond);
+
+
+static void BM_WeightingFunction(benchmark::State& state,
+								 weighting_func_ptr weighting_func) {
+	const auto& data = GetData(state.range(0));
+	while (state.KeepRunning()) {
+		for (const auto& student_pair : data.pairs) {
+			auto weight = weighting_func(
+					*student_pair.first, *student_pair.second);
+			benchmark::DoNotOptimize(weight);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * data.pairs.size());
+}
+BENCHMARK_CAPTURE(BM_WeightingFunction, credit_hours_over_enrollment,
+				  &CreditHoursOverEnrollment)
+	->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WeightingFunction, inverse_enrollment,
+				  &InverseEnrollment)
+	->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,169 @@
+#include "build_checkpoint.hpp"
+
+#include <cstdio>
+
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "edge_checksum.hpp"
+#include "student_container.hpp"
+#include "trace.hpp"
+
+
+using std::endl;
+using std::ifstream; using std::ofstream;
+using std::istringstream;
+using std::lock_guard;
+using std::map;
+using std::string; using std::to_string;
+using std::vector;
+
+namespace chr = std::chrono;
+
+
+// The checksum of the edges of rows.
+static EdgeChecksum GetRowsChecksum(
+		const vector<std::pair<long, RowEdges>>& rows) {
+	EdgeChecksum checksum;
+	for (const auto& row : rows) {
+		for (const auto& edge : row.second)
+		{ checksum.AddEdge(row.first, edge.column, edge.weight); }
+	}
+	return checksum;
+}
+
+
+BuildCheckpoint::BuildCheckpoint(const string& directory, const string& label,
+								 const StudentContainer& students,
+								 ShardRows rows, int period_seconds) :
+	directory_{directory}, label_{label},
+	fingerprint_{GetStudentsFingerprint(students)},
+	num_students_{static_cast<long>(students.size())}, rows_(rows),
+	period_{period_seconds}, resumed_rows_(rows.last_row - rows.first_row),
+	mutex_{"checkpoint"}, next_checkpoint_{0},
+	last_save_{chr::steady_clock::now()} {}
+
+
+string BuildCheckpoint::GetPath(int checkpoint) const
+{ return directory_ + "/checkpoint_" + to_string(checkpoint) + ".txt"; }
+
+
+map<long, RowEdges> BuildCheckpoint::Resume() {
+	TRACE_SCOPE("resume_checkpoints");
+	lock_guard<CountingMutex> checkpoint_lock_guard{mutex_};
+	map<long, RowEdges> finished_rows;
+	for (;; ++next_checkpoint_) {
+		auto path = GetPath(next_checkpoint_);
+		ifstream input{path};
+		if (!input.is_open()) { break; }
+
+		string line, keyword, label, fingerprint;
+		long num_students;
+		ShardRows rows;
+		getline(input, line);
+		istringstream header{line};
+		header >> keyword >> label >> num_students >> fingerprint
+			   >> rows.first_row >> rows.last_row;
+		if (!header || keyword != "checkpoint")
+		{ throw CheckpointError{path + " isn't a checkpoint!"}; }
+		if (label != label_ || num_students != num_students_ ||
+				fingerprint != fingerprint_ || !(rows == rows_)) {
+			throw CheckpointError{path + " is of another build, resume it "
+				"with the same options and students or start over!"};
+		}
+
+		vector<std::pair<long, RowEdges>> checkpoint_rows;
+		bool complete{false};
+		while (!complete && getline(input, line)) {
+			istringstream fields{line};
+			if (line.compare(0, 4, "row\t") == 0) {
+				long row;
+				fields >> keyword >> row;
+				if (!fields || row < rows_.first_row || row >= rows_.last_row)
+				{ throw CheckpointError{path + " has a bad row: " + line}; }
+				checkpoint_rows.emplace_back(row, RowEdges{});
+			} else if (line.compare(0, 4, "end\t") == 0) {
+				long num_rows;
+				string checksum;
+				fields >> keyword >> num_rows >> checksum;
+				auto expected_checksum = GetRowsChecksum(checkpoint_rows);
+				if (num_rows != static_cast<long>(checkpoint_rows.size()) ||
+						checksum != expected_checksum.ToString())
+				{ throw CheckpointError{path + " is corrupt!"}; }
+				complete = true;
+			} else {
+				RowEdge edge;
+				fields >> edge.column >> edge.weight;
+				if (!fields || checkpoint_rows.empty())
+				{ throw CheckpointError{path + " has a bad edge: " + line}; }
+				checkpoint_rows.back().second.push_back(edge);
+			}
+		}
+		if (!complete) { throw CheckpointError{path + " is truncated!"}; }
+
+		for (auto& row : checkpoint_rows) {
+			if (resumed_rows_[row.first - rows_.first_row]) {
+				throw CheckpointError{path + " repeats row " +
+					to_string(row.first) + ", start over!"};
+			}
+			resumed_rows_[row.first - rows_.first_row] = true;
+			finished_rows[row.first] = std::move(row.second);
+		}
+		AddToCounter("rows_resumed", checkpoint_rows.size());
+	}
+	return finished_rows;
+}
+
+
+void BuildCheckpoint::Clear() {
+	for (int checkpoint{0}; std::remove(GetPath(checkpoint).c_str()) == 0;
+			++checkpoint) {}
+}
+
+
+void BuildCheckpoint::FinishRow(long row, const RowEdges& edges) {
+	lock_guard<CountingMutex> checkpoint_lock_guard{mutex_};
+	pending_rows_.emplace_back(row, edges);
+	if (chr::steady_clock::now() - last_save_ >= period_) { SaveLocked(); }
+}
+
+
+void BuildCheckpoint::Save() {
+	lock_guard<CountingMutex> checkpoint_lock_guard{mutex_};
+	if (!pending_rows_.empty()) { SaveLocked(); }
+}
+
+
+void BuildCheckpoint::SaveLocked() {
+	TRACE_SCOPE("save_checkpoint");
+	// checkpoints are saved one at a time, so they're complete up to the first
+	// one missing
+	auto path = GetPath(next_checkpoint_);
+	auto temporary_path = path + ".tmp";
+	ofstream output{temporary_path};
+	output << "checkpoint\t" << label_ << '\t' << num_students_ << '\t'
+		   << fingerprint_ << '\t' << rows_.first_row << '\t'
+		   << rows_.last_row << '\n';
+	output.precision(std::numeric_limits<double>::max_digits10);
+	for (const auto& row : pending_rows_) {
+		output << "row\t" << row.first << '\n';
+		for (const auto& edge : row.second)
+		{ output << edge.column << '\t' << edge.weight << '\n'; }
+	}
+	output << "end\t" << pending_rows_.size() << '\t'
+		   << GetRowsChecksum(pending_rows_).ToString() << endl;
+	output.close();
+	if (!output || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+	{ throw CheckpointError{"Could not save the checkpoint " + path + "!"}; }
+
+	AddToCounter("checkpoints_saved", 1);
+	AddToCounter("rows_checkpointed", pending_rows_.size());
+	pending_rows_.clear();
+	++next_checkpoint_;
+	last_save_ = chr::steady_clock::now();
+}
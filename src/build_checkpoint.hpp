@@ -0,0 +1,85 @@
+#ifndef BUILD_CHECKPOINT_H
+#define BUILD_CHECKPOINT_H
+
+#include <chrono>
+#include <exception>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "metrics.hpp"
+#include "network_shard.hpp"
+
+
+class StudentContainer;
+
+
+// Checkpoints of a long student network build. Workers report every row they
+// finish with its edges, and once period_seconds have passed since the last
+// checkpoint the rows finished since are saved to the next file of the
+// checkpoint directory, checkpoint_0.txt, checkpoint_1.txt and so on. Files
+// are written under a temporary name and renamed once complete, one at a
+// time, so a build killed at any point leaves only whole checkpoints.
+// Resuming loads them and the build skips their rows.
+class BuildCheckpoint {
+ public:
+	// The label tells builds apart, e.g. by weighting function. Checkpoints
+	// with another label or of other students or rows can't be resumed.
+	BuildCheckpoint(const std::string& directory, const std::string& label,
+					const StudentContainer& students, ShardRows rows,
+					int period_seconds);
+
+	BuildCheckpoint(const BuildCheckpoint&) = delete;
+	BuildCheckpoint& operator=(const BuildCheckpoint&) = delete;
+
+	// Loads the checkpoints in the directory and returns the finished rows
+	// with their edges. Throws CheckpointError if they're of another build.
+	// The builders call it, once.
+	std::map<long, RowEdges> Resume();
+
+	// Removes the checkpoints of an earlier build.
+	void Clear();
+
+	const ShardRows& rows() const { return rows_; }
+
+	// Whether the row was finished by a resumed checkpoint.
+	bool IsRowResumed(long row) const
+	{ return resumed_rows_[row - rows_.first_row]; }
+
+	// Records a finished row, saving a checkpoint if it's time. Thread-safe.
+	void FinishRow(long row, const RowEdges& edges);
+
+	// Saves the rows finished since the last checkpoint.
+	void Save();
+
+ private:
+	std::string GetPath(int checkpoint) const;
+	// Saves the pending rows as the next checkpoint, holding mutex_.
+	void SaveLocked();
+
+	std::string directory_, label_, fingerprint_;
+	long num_students_;
+	ShardRows rows_;
+	std::chrono::seconds period_;
+	std::vector<bool> resumed_rows_;
+
+	CountingMutex mutex_;
+	// only changed while holding mutex_
+	std::vector<std::pair<long, RowEdges>> pending_rows_;
+	int next_checkpoint_;
+	std::chrono::steady_clock::time_point last_save_;
+};
+
+
+class CheckpointError : public std::exception {
+ public:
+	CheckpointError(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // BUILD_CHECKPOINT_H
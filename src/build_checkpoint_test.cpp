@@ -0,0 +1,141 @@
+#include "build_checkpoint.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <fstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "network_shard.hpp"
+#include "student.hpp"
+#include "student_container_mock.hpp"
+
+
+using std::ofstream;
+using std::string;
+
+using ::testing::NiceMock;
+using ::testing::Return;
+
+
+class BuildCheckpointTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		students.Insert({Student{1}, Student{2}, Student{3}, Student{4}});
+		ON_CALL(students, size()).WillByDefault(Return(4));
+
+		char directory_template[] = "/tmp/checkpoint_test_XXXXXX";
+		ASSERT_NE(nullptr, mkdtemp(directory_template));
+		directory = directory_template;
+	}
+
+	void TearDown() override {
+		BuildCheckpoint{directory, label, students, rows, 0}.Clear();
+		rmdir(directory.c_str());
+	}
+
+ protected:
+	NiceMock<MockStudentContainer> students;
+	string directory;
+	string label{"test"};
+	ShardRows rows{0, 4};
+};
+
+
+TEST_F(BuildCheckpointTest, SaveAndResume) {
+	{
+		BuildCheckpoint checkpoint{directory, label, students, rows, 3600};
+		checkpoint.Clear();
+		EXPECT_TRUE(checkpoint.Resume().empty());
+
+		checkpoint.FinishRow(2, {{3, 0.1 + 0.2}});
+		checkpoint.FinishRow(0, {{1, 1.}, {3, 2.}});
+		checkpoint.Save();
+		checkpoint.FinishRow(3, {});
+		// not saved yet, the period hasn't passed
+	}
+
+	BuildCheckpoint checkpoint{directory, label, students, rows, 3600};
+	auto resumed_rows = checkpoint.Resume();
+	ASSERT_EQ(2u, resumed_rows.size());
+	ASSERT_EQ(2u, resumed_rows[0].size());
+	EXPECT_EQ(1, resumed_rows[0][0].column);
+	EXPECT_DOUBLE_EQ(1., resumed_rows[0][0].weight);
+	EXPECT_EQ(3, resumed_rows[0][1].column);
+	ASSERT_EQ(1u, resumed_rows[2].size());
+	EXPECT_EQ(0.1 + 0.2, resumed_rows[2][0].weight);
+
+	EXPECT_TRUE(checkpoint.IsRowResumed(0));
+	EXPECT_FALSE(checkpoint.IsRowResumed(1));
+	EXPECT_TRUE(checkpoint.IsRowResumed(2));
+	EXPECT_FALSE(checkpoint.IsRowResumed(3));
+
+	// later checkpoints follow the resumed ones
+	checkpoint.FinishRow(1, {{2, 4.}});
+	checkpoint.Save();
+	BuildCheckpoint resumed_again{directory, label, students, rows, 3600};
+	EXPECT_EQ(3u, resumed_again.Resume().size());
+
+	checkpoint.Clear();
+	BuildCheckpoint cleared{directory, label, students, rows, 3600};
+	EXPECT_TRUE(cleared.Resume().empty());
+}
+
+
+TEST_F(BuildCheckpointTest, SavesEveryPeriod) {
+	BuildCheckpoint checkpoint{directory, label, students, rows, 0};
+	checkpoint.Clear();
+	checkpoint.FinishRow(0, {{1, 1.}});
+	checkpoint.FinishRow(1, {});
+
+	BuildCheckpoint resumed{directory, label, students, rows, 0};
+	EXPECT_EQ(2u, resumed.Resume().size());
+}
+
+
+TEST_F(BuildCheckpointTest, OtherBuild) {
+	BuildCheckpoint checkpoint{directory, label, students, rows, 0};
+	checkpoint.Clear();
+	checkpoint.FinishRow(0, {{1, 1.}});
+
+	BuildCheckpoint other_label{directory, label + "_other", students, rows, 0};
+	EXPECT_THROW(other_label.Resume(), CheckpointError);
+
+	BuildCheckpoint other_rows{directory, label, students, {0, 2}, 0};
+	EXPECT_THROW(other_rows.Resume(), CheckpointError);
+
+	NiceMock<MockStudentContainer> other_students;
+	other_students.Insert({Student{1}, Student{2}, Student{3}, Student{5}});
+	ON_CALL(other_students, size()).WillByDefault(Return(4));
+	BuildCheckpoint other_fingerprint{
+		directory, label, other_students, rows, 0};
+	EXPECT_THROW(other_fingerprint.Resume(), CheckpointError);
+}
+
+
+TEST_F(BuildCheckpointTest, Corrupt) {
+	BuildCheckpoint checkpoint{directory, label, students, rows, 0};
+	checkpoint.Clear();
+	checkpoint.FinishRow(0, {{1, 1.}});
+
+	// a partly written checkpoint is never renamed, so it isn't resumed
+	{
+		ofstream partial{directory + "/checkpoint_1.txt.tmp"};
+		partial << "checkpoint\t" << label << "\t4\n";
+	}
+	BuildCheckpoint resumed{directory, label, students, rows, 0};
+	EXPECT_EQ(1u, resumed.Resume().size());
+	std::remove((directory + "/checkpoint_1.txt.tmp").c_str());
+
+	{
+		ofstream truncated{directory + "/checkpoint_1.txt"};
+		truncated << "checkpoint\t" << label << "\t4\n";
+	}
+	BuildCheckpoint bad_header{directory, label, students, rows, 0};
+	EXPECT_THROW(bad_header.Resume(), CheckpointError);
+}
@@ -1,29 +1,57 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 #include <boost/program_options.hpp>
 
+#include "build_checkpoint.hpp"
+#include "co_enrollment.hpp"
 #include "course_container.hpp"
 #include "course_network.hpp"
+#include "edge_filter.hpp"
+#include "edge_spill.hpp"
 #include "graph_builder.hpp"
 #include "mem_usage.hpp"
+#include "metrics.hpp"
+#include "minhash.hpp"
+#include "network_shard.hpp"
+#include "network_update.hpp"
+#include "numa_placement.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "student_sample.hpp"
+#include "temporal_network.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 #include "weighting_function.hpp"
 
 
 using std::cerr; using std::cin; using std::cout; using std::endl;
 using std::ifstream; using std::istream; using std::ofstream; using std::ostream;
-using std::string;
+using std::string; using std::to_string;
+using std::unique_ptr;
 
 namespace po = boost::program_options;
 
 
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Options for network building binary:"};
-	string student_archive_path, course_archive_path, weighting_function_name;
+	string student_archive_path, course_archive_path, weighting_function_name,
+		   metrics_path, trace_path, memory_budget, scratch_dir, spill_buffer,
+		   checkpoint_dir, update_network_path;
+	int metrics_period, shard_index, num_shards, checkpoint_period,
+		temporal_window, new_term;
+	bool out_of_core, resume, approximate;
+	EdgeFilter filter;
+	MinHashOptions minhash_options;
+	SampleOptions sample_options;
 	NetworkType_e network_to_build;
 	desc.add_options()
 		("help,h", "Show this help message")
@@ -41,7 +69,106 @@ int main(int argc, char* argv[]) {
 			 NetworkType_e::Student), "Set the network to build "
 		 "('student' or 'course')")
 		("threads,t", po::value<int>(&num_threads)->default_value(1),
-		 "Number of threads to use to build the network");
+		 "Number of threads to use to build the network")
+		("numa", po::bool_switch(&numa_placement),
+		 "Pin the threads to the NUMA nodes, splitting the rows of the "
+		 "student network between them, and interleave the students and "
+		 "courses across the nodes. Needs a build with -Dnuma=ON")
+		("num_shards", po::value<int>(&num_shards)->default_value(1),
+		 "Split the student network between this many runs of build, e.g. "
+		 "the tasks of a job array. Each writes the edges of its shard, which "
+		 "merge combines into the network")
+		("shard_index", po::value<int>(&shard_index)->default_value(0),
+		 "Build this shard, from 0 to num_shards - 1")
+		("min_weight",
+		 po::value<double>(&filter.min_weight)->default_value(0.),
+		 "Drop student network edges lighter than this")
+		("min_shared_courses",
+		 po::value<int>(&filter.min_shared_courses)->default_value(1),
+		 "Only connect students sharing at least this many courses")
+		("top_k", po::value<int>(&filter.top_k)->default_value(0),
+		 "Only keep an edge if it's among the top_k heaviest of one of its "
+		 "students, 0 to keep every edge")
+		("approximate", po::bool_switch(&approximate),
+		 "Approximate the student network, only weighting the pairs of "
+		 "students with similar courses by MinHash")
+		("lsh_bands",
+		 po::value<int>(&minhash_options.num_bands)->default_value(20),
+		 "Split MinHash signatures into this many bands, more find more of "
+		 "the less similar pairs")
+		("lsh_rows",
+		 po::value<int>(&minhash_options.band_rows)->default_value(3),
+		 "Hash values in every band, more weight fewer dissimilar pairs")
+		("lsh_min_similarity", po::value<double>(
+			&minhash_options.min_similarity)->default_value(0.),
+		 "Don't weight candidates whose signatures agree on less than this "
+		 "fraction of values")
+		("lsh_seed", po::value<std::uint64_t>(
+			&minhash_options.seed)->default_value(0),
+		 "Seed of the MinHash functions")
+		("update_network", po::value<string>(&update_network_path),
+		 "Rather than building the network, update the one saved here with "
+		 "the enrollments of new_term, only weighting the pairs of students "
+		 "sharing its courses. The archives are the updated ones, the network "
+		 "was built without new_term with the same options.")
+		("new_term", po::value<int>(&new_term)->default_value(0),
+		 "The term of the enrollments added since update_network was built, "
+		 "e.g. 201503")
+		("mega_course_size",
+		 po::value<long>(&mega_course_size)->default_value(1000),
+		 "Updates split the pairs of students of courses larger than this "
+		 "into blocks of this many students, so the threads share them")
+		("temporal_window",
+		 po::value<int>(&temporal_window)->default_value(0),
+		 "Build a snapshot of the student network of every window of this "
+		 "many consecutive terms, 1 for a network per term, in one pass. "
+		 "The snapshots are saved together, see the snapshot binary.")
+		("sample_rate",
+		 po::value<double>(&sample_options.rate)->default_value(1.),
+		 "Only build the student network of this fraction of the students, "
+		 "for quick estimates. Their edges keep the weights of the whole "
+		 "network.")
+		("sample_seed", po::value<std::uint64_t>(
+			&sample_options.seed)->default_value(0),
+		 "Seed of the student sample, the analyses need the same one")
+		("stratify_by", po::value<string>(&sample_options.stratify_by),
+		 "Sample the sample_rate of every 'school' or 'major1' rather than "
+		 "of all the students")
+		("checkpoint_dir", po::value<string>(&checkpoint_dir),
+		 "Save the rows of the student network finished so far to this "
+		 "directory, so a build that's killed can be resumed")
+		("checkpoint_period",
+		 po::value<int>(&checkpoint_period)->default_value(600),
+		 "Save a checkpoint every this many seconds")
+		("resume", po::bool_switch(&resume),
+		 "Resume from the checkpoints in checkpoint_dir rather than starting "
+		 "over. The build must have the same options and students.")
+		("progress_period",
+		 po::value<int>(&progress_period)->default_value(60),
+		 "Write the build's progress and ETA to stderr every this many "
+		 "seconds, 0 to disable")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds")
+		("memory_budget", po::value<string>(&memory_budget),
+		 "Resident memory the build may use, e.g. \"35gb\". A student "
+		 "network that won't fit is built out of core, the build stops as "
+		 "soon as the budget is exceeded.")
+		("out_of_core", po::bool_switch(&out_of_core),
+		 "Build the student network out of core: spill sorted runs of edges "
+		 "to scratch_dir and merge them into the saved network, which never "
+		 "has to fit in memory")
+		("scratch_dir", po::value<string>(&scratch_dir)->default_value(
+			std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp"),
+		 "Directory for the runs of an out of core build, e.g. "
+		 "/tmp/$PBS_JOBID")
+		("spill_buffer", po::value<string>(&spill_buffer)->default_value("1gb"),
+		 "Memory for the edges buffered before spilling a run in an out of "
+		 "core build");
 
 	po::variables_map vm;
 	try {
@@ -59,29 +186,317 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
-	// read students and enrollment data
+	if (num_shards < 1 || shard_index < 0 || shard_index >= num_shards) {
+		cerr << "Shard " << shard_index << " of " << num_shards
+			 << " doesn't exist!" << endl;
+		return -1;
+	}
+	if (num_shards > 1 && network_to_build != NetworkType_e::Student) {
+		cerr << "Only the student network can be built in shards!" << endl;
+		return -1;
+	}
+	if (num_shards > 1 && out_of_core) {
+		cerr << "Shards can't be built out of core!" << endl;
+		return -1;
+	}
+	if (filter.min_weight < 0. || filter.min_shared_courses < 1 ||
+			filter.top_k < 0) {
+		cerr << "Edges can't be filtered by " << filter.ToString() << "!"
+			 << endl;
+		return -1;
+	}
+	if (filter.IsActive() && network_to_build != NetworkType_e::Student) {
+		cerr << "Only the student network can be filtered!" << endl;
+		return -1;
+	}
+	if (num_shards > 1 && filter.top_k > 0) {
+		cerr << "Shards don't see every edge of their students, so they "
+			 << "can't keep the top_k!" << endl;
+		return -1;
+	}
+	if (approximate && (network_to_build != NetworkType_e::Student ||
+				num_shards > 1 || out_of_core || !checkpoint_dir.empty())) {
+		cerr << "Only a whole student network can be approximated, in "
+			 << "memory and without checkpoints!" << endl;
+		return -1;
+	}
+	if (minhash_options.num_bands < 1 || minhash_options.band_rows < 1) {
+		cerr << "MinHash signatures need at least a band of a row!" << endl;
+		return -1;
+	}
+	if (temporal_window < 0) {
+		cerr << "Windows can't have " << temporal_window << " terms!" << endl;
+		return -1;
+	}
+	if (temporal_window > 0 && (network_to_build != NetworkType_e::Student ||
+				num_shards > 1 || out_of_core || approximate ||
+				!checkpoint_dir.empty() || filter.IsActive())) {
+		cerr << "Only a whole, unfiltered student network can be built in "
+			 << "snapshots, in memory and without checkpoints!" << endl;
+		return -1;
+	}
+	if (!update_network_path.empty() && (num_shards > 1 || out_of_core ||
+				approximate || !checkpoint_dir.empty() || temporal_window > 0 ||
+				filter.top_k > 0)) {
+		cerr << "Only a whole network without the top_k can be updated, in "
+			 << "memory and without checkpoints!" << endl;
+		return -1;
+	}
+	if (!update_network_path.empty() && new_term == 0) {
+		cerr << "Updating a network needs the new_term it's updated with!"
+			 << endl;
+		return -1;
+	}
+	if (sample_options.IsSampling() &&
+			network_to_build != NetworkType_e::Student) {
+		cerr << "Only the student network can be sampled!" << endl;
+		return -1;
+	}
+	if (!checkpoint_dir.empty() && network_to_build != NetworkType_e::Student) {
+		cerr << "Only the student network can be checkpointed!" << endl;
+		return -1;
+	}
+	if (resume && checkpoint_dir.empty()) {
+		cerr << "Resuming needs the checkpoint_dir to resume from!" << endl;
+		return -1;
+	}
+
+	long memory_budget_kb{0}, spill_buffer_kb{0};
+	try {
+		if (!memory_budget.empty())
+		{ memory_budget_kb = ParseMemorySize(memory_budget); }
+		spill_buffer_kb = ParseMemorySize(spill_buffer);
+	} catch (std::invalid_argument& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{"build", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+	unique_ptr<BuildCheckpoint> checkpoint;
+	std::atomic<BuildCheckpoint*> budget_checkpoint{nullptr};
+
+	// stop before the scheduler kills the job, which gives no explanation,
+	// the sampler only runs with a budget. The workers can't be stopped
+	// partway, so it exits at once, first saving the finished rows, the
+	// metrics report and the trace that unwinding main would have saved.
+	MemorySampler memory_sampler{std::chrono::milliseconds{500},
+		memory_budget_kb, [&, memory_budget_kb](long resident_kb) {
+			cerr << "Resident memory of " << resident_kb << " KB exceeded the "
+				 << "budget of " << memory_budget_kb << " KB, aborting!"
+				 << endl;
+			SetLabel("aborted", "over memory budget");
+			try {
+				if (auto over_budget_checkpoint = budget_checkpoint.load())
+				{ over_budget_checkpoint->Save(); }
+			} catch (CheckpointError& e) {
+				cerr << e.what() << endl;
+			}
+			metrics_reporter.SaveReport();
+			trace_reporter.Save();
+			std::_Exit(EXIT_FAILURE);
+		}};
+
+	// read students and enrollment data, which every node reads
+	NumaInterleave numa_interleave;
+	PhaseTimer load_timer{"load_archives"};
 	ifstream student_archive{student_archive_path};
 	ifstream course_archive{course_archive_path};
     StudentContainer students{
         StudentContainer::LoadFromArchive(student_archive)};
 	CourseContainer courses{
         CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
 	students.UpdateCourses(courses);
+	update_timer.Stop();
+
+	// the courses of the sampled students keep every student's enrollment
+	if (sample_options.IsSampling()) {
+		try {
+			PhaseTimer sample_timer{"sample"};
+			StudentSample sample{students, sample_options};
+			students = sample.GetSampledStudents(students);
+			AddToCounter("students_sampled", sample.size());
+			cerr << "Sampled " << sample.size() << " of "
+				 << sample.population_size() << " students" << endl;
+		} catch (InvalidSample& e) {
+			cerr << e.what() << endl;
+			return -1;
+		}
+	}
+	numa_interleave.Stop();
+	if (numa_placement)
+	{ SetLabel("numa_nodes", to_string(GetNumNumaNodes())); }
+
+	// checkpoints and shards of unfiltered edges aren't combined with those of
+	// filtered builds
+	auto build_label = weighting_function_name;
+	if (filter.IsActive()) { build_label += "," + filter.ToString(); }
+	if (!checkpoint_dir.empty()) {
+		long num_students{static_cast<long>(students.size())};
+		checkpoint.reset(new BuildCheckpoint{checkpoint_dir, build_label,
+			students, GetShardRows(num_students, shard_index, num_shards),
+			checkpoint_period});
+		if (!resume) { checkpoint->Clear(); }
+		budget_checkpoint = checkpoint.get();
+	}
+
+	// count the bytes of the network saved to cout
+	CountingStreamBuffer counting_buffer{cout.rdbuf()};
+	ostream network_output{&counting_buffer};
+
+	// checkpoints and out of core builds fail on bad files or a full disk
+	try {
+		if (!update_network_path.empty()) {
+			// update a network with the new term
+			ifstream network_archive{update_network_path};
+			if (!network_archive.is_open()) {
+				cerr << "Could not open the network \"" << update_network_path
+					 << "\"!" << endl;
+				return -1;
+			}
+			AddToCounter("bytes_read", GetFileSize(update_network_path));
+			PhaseTimer update_network_timer{"update"};
+			if (network_to_build == NetworkType_e::Course) {
+				auto course_network = UpdateCourseNetwork(
+						CourseNetwork{network_archive}, students, new_term);
+				update_network_timer.Stop();
+				cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+				PhaseTimer save_timer{"save"};
+				course_network.Save(network_output);
+			} else {
+				auto student_network = UpdateStudentNetwork(
+						StudentNetwork{network_archive}, students,
+						WeightingFuncFactory(weighting_function_name), new_term,
+						filter);
+				update_network_timer.Stop();
+				cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
 
-	if (network_to_build == NetworkType_e::Course) {
-		// build the course network
-		CourseNetwork course_network{
-			BuildCourseNetworkFromEnrollment(students)};
-		course_network.Save(cout);
-	} else {
-		assert(network_to_build == NetworkType_e::Student);
+				PhaseTimer save_timer{"save"};
+				student_network.Save(network_output);
+			}
+		} else if (network_to_build == NetworkType_e::Course) {
+			// build the course network
+			PhaseTimer build_timer{"build"};
+			CourseNetwork course_network{
+				BuildCourseNetworkFromEnrollment(students)};
+			build_timer.Stop();
+			cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
 
-		// build the student network
-		auto weighting_func = WeightingFuncFactory(weighting_function_name);
-		StudentNetwork student_network{
-			BuildStudentNetworkFromStudents(students, weighting_func)};
-		student_network.Save(cout);
+			PhaseTimer save_timer{"save"};
+			course_network.Save(network_output);
+		} else if (temporal_window > 0) {
+			// build a snapshot of every window of terms
+			auto weighting_func = WeightingFuncFactory(weighting_function_name);
+			PhaseTimer build_timer{"build"};
+			TemporalNetwork temporal_network{BuildTemporalStudentNetwork(
+					students, weighting_func, temporal_window)};
+			build_timer.Stop();
+			cerr << "Built " << temporal_network.snapshots.size()
+				 << " snapshots, edge checksum " << GetLabel("edge_checksum")
+				 << endl;
+
+			PhaseTimer save_timer{"save"};
+			temporal_network.Save(network_output);
+		} else if (num_shards > 1) {
+			// build the edges of one shard of the student network
+			auto weighting_func = WeightingFuncFactory(weighting_function_name);
+			PhaseTimer build_timer{"build"};
+			NetworkShard network_shard{BuildStudentNetworkShard(students,
+					weighting_func, shard_index, num_shards, build_label,
+					checkpoint.get(), filter)};
+			build_timer.Stop();
+			cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+			PhaseTimer save_timer{"save"};
+			network_shard.Save(network_output);
+		} else {
+			assert(network_to_build == NetworkType_e::Student);
+
+			auto required_kb = GetMemoryUsage() +
+				EstimateStudentNetworkMemory(students.size());
+			if (memory_budget_kb > 0 && required_kb > memory_budget_kb &&
+					approximate) {
+				cerr << "Approximating the network of " << students.size()
+					 << " students needs about " << required_kb << " KB, more "
+					 << "than the budget of " << memory_budget_kb << " KB!"
+					 << endl;
+				return -1;
+			}
+			if (memory_budget_kb > 0 && required_kb > memory_budget_kb &&
+					!out_of_core) {
+				cerr << "Building the network of " << students.size()
+					 << " students needs about " << required_kb << " KB, more "
+					 << "than the budget of " << memory_budget_kb << " KB, "
+					 << "building it out of core." << endl;
+				out_of_core = true;
+			}
+
+			auto weighting_func = WeightingFuncFactory(weighting_function_name);
+			if (out_of_core) {
+				// leave room in the budget for the runs being sorted and merged
+				if (memory_budget_kb > 0) {
+					spill_buffer_kb = std::min(spill_buffer_kb,
+							(memory_budget_kb - GetMemoryUsage()) / 2);
+				}
+				if (spill_buffer_kb <= 0) {
+					cerr << "There's no memory left in the budget of "
+						 << memory_budget_kb << " KB to buffer edges!" << endl;
+					return -1;
+				}
+
+				EdgeRuns runs{scratch_dir};
+				PhaseTimer build_timer{"build"};
+				SpillStudentNetworkEdges(students, weighting_func,
+						spill_buffer_kb, runs, checkpoint.get(), filter);
+				build_timer.Stop();
+				cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+				PhaseTimer save_timer{"save"};
+				SaveSpilledNetwork(students, runs, network_output);
+			} else if (approximate) {
+				cerr << "Approximating: pairs of students whose courses are "
+					 << minhash_options.GetSimilarity(0.5) << " alike are "
+					 << "weighted half the time, "
+					 << minhash_options.GetSimilarity(0.9) << " alike 90% of "
+					 << "the time" << endl;
+				PhaseTimer build_timer{"build"};
+				StudentNetwork student_network{BuildApproximateStudentNetwork(
+						students, weighting_func, minhash_options, filter)};
+				build_timer.Stop();
+				cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+				PhaseTimer save_timer{"save"};
+				student_network.Save(network_output);
+			} else {
+				// build the student network
+				PhaseTimer build_timer{"build"};
+				StudentNetwork student_network{BuildStudentNetworkFromStudents(
+						students, weighting_func, checkpoint.get(), filter)};
+				build_timer.Stop();
+				cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+				PhaseTimer save_timer{"save"};
+				student_network.Save(network_output);
+			}
+		}
+	} catch (CheckpointError& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (SpillError& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (InvalidUpdate& e) {
+		cerr << e.what() << endl;
+		return -1;
 	}
+	network_output.flush();
+	AddToCounter("bytes_written", counting_buffer.count());
 
 	return 0;
 }
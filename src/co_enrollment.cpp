@@ -0,0 +1,144 @@
+#include "co_enrollment.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "course.hpp"
+#include "metrics.hpp"
+#include "student.hpp"
+#include "trace.hpp"
+#include "utility.hpp"
+
+
+using std::begin; using std::end;
+using std::bind; using std::placeholders::_1;
+using std::pair;
+using std::size_t;
+using std::thread;
+using std::unordered_map;
+using std::vector;
+
+
+long mega_course_size{1000};
+
+
+// The pairs of a course's students in the blocks [first1, last1) and
+// [first2, last2), a block is paired with itself when they're the same.
+struct PairsUnit {
+	size_t course;
+	long first1, last1, first2, last2;
+	long num_pairs;
+};
+
+
+vector<vector<long>> FindCoEnrolledPairs(const vector<const Course*>& courses,
+		const unordered_map<Student::Id, long>& rows, long num_rows) {
+	TRACE_SCOPE("find_co_enrolled_pairs");
+	// the rows of every course's students, in order
+	vector<vector<long>> course_rows;
+	for (auto course : courses) {
+		vector<long> student_rows;
+		for (auto student : course->students_enrolled()) {
+			auto row_it = rows.find(student);
+			if (row_it != end(rows)) { student_rows.push_back(row_it->second); }
+		}
+		std::sort(begin(student_rows), end(student_rows));
+		if (student_rows.size() > 1)
+		{ course_rows.push_back(std::move(student_rows)); }
+	}
+
+	auto block_size = std::max(mega_course_size, 1L);
+	vector<PairsUnit> units;
+	long num_mega_courses{0};
+	for (size_t course{0}; course < course_rows.size(); ++course) {
+		long num_students{static_cast<long>(course_rows[course].size())};
+		if (num_students > block_size) { ++num_mega_courses; }
+		auto size = std::min(num_students, block_size);
+		for (long first1{0}; first1 < num_students; first1 += size) {
+			auto last1 = std::min(first1 + size, num_students);
+			for (auto first2 = first1; first2 < num_students; first2 += size) {
+				auto last2 = std::min(first2 + size, num_students);
+				auto num_pairs = first1 == first2 ?
+					(last1 - first1) * (last1 - first1 - 1) / 2 :
+					(last1 - first1) * (last2 - first2);
+				units.push_back({course, first1, last1, first2, last2,
+						num_pairs});
+			}
+		}
+	}
+	std::stable_sort(begin(units), end(units),
+			[](const PairsUnit& unit1, const PairsUnit& unit2)
+			{ return unit1.num_pairs > unit2.num_pairs; });
+	AddToCounter("mega_courses", num_mega_courses);
+	AddToCounter("co_enrollment_units", units.size());
+
+	// the workers keep the pairs they find apart until the rows gather them
+	vector<vector<pair<long, long>>> worker_pairs(num_threads);
+	std::atomic<size_t> next_unit{0};
+	vector<thread> thread_pool;
+	for (int i{0}; i < num_threads; ++i) {
+		thread_pool.emplace_back([&, i] {
+			long num_pairs{0};
+			for (auto index = next_unit++; index < units.size();
+					index = next_unit++) {
+				TRACE_SCOPE("co_enrollment_unit");
+				const auto& unit = units[index];
+				const auto& student_rows = course_rows[unit.course];
+				for (auto i1 = unit.first1; i1 < unit.last1; ++i1) {
+					for (auto i2 = std::max(unit.first2, i1 + 1);
+							i2 < unit.last2; ++i2) {
+						worker_pairs[i].emplace_back(
+								student_rows[i1], student_rows[i2]);
+					}
+				}
+				num_pairs += unit.num_pairs;
+			}
+			AddToCounter("co_enrolled_pairs", num_pairs);
+
+			// sorted so the rows can be gathered by range, without the pairs
+			// found again for another shared course
+			auto& pairs = worker_pairs[i];
+			std::sort(begin(pairs), end(pairs));
+			pairs.erase(std::unique(begin(pairs), end(pairs)), end(pairs));
+		});
+	}
+	for_each(begin(thread_pool), end(thread_pool), bind(&thread::join, _1));
+
+	// the rows are gathered in blocks, each from the range of its rows in every
+	// worker's pairs, and a pair found by several workers is kept once
+	TRACE_SCOPE("gather_co_enrolled_pairs");
+	vector<vector<long>> row_columns(num_rows);
+	auto block_rows = std::max(num_rows / (8L * num_threads), 1L);
+	std::atomic<long> next_row{0};
+	thread_pool.clear();
+	for (int i{0}; i < num_threads; ++i) {
+		thread_pool.emplace_back([&] {
+			for (auto first_row = next_row.fetch_add(block_rows);
+					first_row < num_rows;
+					first_row = next_row.fetch_add(block_rows)) {
+				auto last_row = std::min(first_row + block_rows, num_rows);
+				for (const auto& pairs : worker_pairs) {
+					auto pair_it = std::lower_bound(begin(pairs), end(pairs),
+							std::make_pair(first_row, 0L));
+					for (; pair_it != end(pairs) && pair_it->first < last_row;
+							++pair_it)
+					{ row_columns[pair_it->first].push_back(pair_it->second); }
+				}
+				for (auto row = first_row; row < last_row; ++row) {
+					auto& columns = row_columns[row];
+					std::sort(begin(columns), end(columns));
+					auto last = std::unique(begin(columns), end(columns));
+					columns.erase(last, end(columns));
+				}
+			}
+		});
+	}
+	for_each(begin(thread_pool), end(thread_pool), bind(&thread::join, _1));
+	return row_columns;
+}
@@ -0,0 +1,33 @@
+#ifndef CO_ENROLLMENT_H
+#define CO_ENROLLMENT_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "student.hpp"
+
+
+class Course;
+
+// Finding the pairs of students enrolled in the same courses from the
+// courses' enrollments, rather than weighting every pair. Every course adds
+// the clique of its students, so a few huge intro courses hold most of the
+// pairs. The pairs are found in units of work of about the same size: a
+// course is a unit, and the students of a mega course, one of more than
+// mega_course_size students, are split into blocks of that many whose pairs
+// of blocks are the units. The workers take the largest units first.
+
+
+// Set with build --mega_course_size.
+extern long mega_course_size;
+
+
+// Finds the pairs of students sharing one of the courses. rows maps the
+// students to their rows, students it doesn't have are skipped. The columns
+// of a row are the later rows sharing a course with it, in order.
+std::vector<std::vector<long>> FindCoEnrolledPairs(
+		const std::vector<const Course*>& courses,
+		const std::unordered_map<Student::Id, long>& rows, long num_rows);
+
+
+#endif  // CO_ENROLLMENT_H
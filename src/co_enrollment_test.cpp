@@ -0,0 +1,53 @@
+#include "co_enrollment.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "course.hpp"
+#include "setting_guard.hpp"
+#include "student.hpp"
+#include "utility.hpp"
+
+
+using std::unordered_map;
+using std::vector;
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+
+TEST(FindCoEnrolledPairsTest, BlocksOfMegaCourses) {
+	// a course of every student and two small ones, student 60 has no row
+	Course course1{"ENGLISH", 125, 201403}, course2{"CHEM", 210, 201403},
+		   course3{"MATH", 425, 201403};
+	unordered_map<Student::Id, long> rows;
+	for (long row{0}; row < 5; ++row) {
+		rows[10 * (row + 1)] = row;
+		course1.AddStudentEnrolled(10 * (row + 1));
+	}
+	for (auto id : {20, 40}) { course2.AddStudentEnrolled(id); }
+	for (auto id : {30, 60}) { course3.AddStudentEnrolled(id); }
+
+	vector<vector<long>> expected(5);
+	for (long row{0}; row < 5; ++row) {
+		for (auto column = row + 1; column < 5; ++column)
+		{ expected[row].push_back(column); }
+	}
+
+	// the pairs are the same however the mega course is split or threaded
+	for (long size : {1, 2, 3, 1000}) {
+		for (int threads : {1, 3}) {
+			SettingGuard<long> size_guard{mega_course_size, size};
+			SettingGuard<int> threads_guard{num_threads, threads};
+			EXPECT_EQ(expected, FindCoEnrolledPairs(
+						{&course1, &course2, &course3}, rows, 5));
+		}
+	}
+
+	auto row_columns = FindCoEnrolledPairs({&course2, &course3}, rows, 5);
+	EXPECT_THAT(row_columns[1], ElementsAre(3));
+	EXPECT_THAT(row_columns[2], IsEmpty());
+}
@@ -14,6 +14,7 @@
 #include "course.hpp"
 #include "student.hpp"
 #include "student_container.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
@@ -36,6 +37,7 @@ static istream& operator>>(istream& input, Enrollment& enrollment);
 
 
 CourseContainer CourseContainer::LoadFromTsv(istream& enrollment_stream) {
+	TRACE_SCOPE("load_courses_tsv");
     CourseContainer course_container{};
 
 	// Skip the headings line.
@@ -60,6 +62,7 @@ CourseContainer CourseContainer::LoadFromTsv(istream& enrollment_stream) {
 
 
 CourseContainer CourseContainer::LoadFromArchive(istream& input_archive) {
+	TRACE_SCOPE("load_courses_archive");
     CourseContainer course_container{};
 
 	boost::archive::text_iarchive archive{input_archive};
@@ -76,6 +79,7 @@ CourseContainer CourseContainer::LoadFromArchive(string input_path) {
 
 
 void CourseContainer::SaveToArchive(ostream& output) {
+	TRACE_SCOPE("save_courses_archive");
 	boost::archive::text_oarchive archive{output};
 	serialize(archive, 0);
 }
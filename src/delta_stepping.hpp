@@ -0,0 +1,248 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <cmath>
+
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "metrics.hpp"
+#include "network.hpp"
+#include "thread_safe_range_action.hpp"
+
+
+// Single source shortest paths for non-negative edge weights using the
+// delta-stepping algorithm (Meyer and Sanders). Tentative distances are kept in
+// buckets of width delta. The light edges (weight <= delta) of the current
+// bucket are relaxed in parallel until the bucket stops refilling, then its
+// heavy edges are relaxed once. A small delta approaches Dijkstra, a large one
+// approaches Bellman-Ford.
+//
+// The adjacency of the network is extracted once on construction, so a single
+// engine should be reused for every source vertex.
+template <typename Vertex, typename Edge>
+class DeltaStepping {
+ public:
+	using network_t = Network<Vertex, Edge>;
+	using vertex_t = typename network_t::vertex_t;
+
+	DeltaStepping(const network_t& network, Edge delta);
+
+	// Same output as Network::FindWeightedDistances: disconnected vertices and
+	// the start vertex are filtered out of the map.
+	std::map<Vertex, Edge> FindDistances(vertex_t start) const;
+
+	// Distances indexed by vertex descriptor. Unreachable vertices are set to
+	// std::numeric_limits<Edge>::max().
+	std::vector<Edge> FindDistanceVector(vertex_t start) const;
+
+	Edge delta() const { return delta_; }
+
+ private:
+	struct Neighbor {
+		vertex_t target;
+		Edge weight;
+	};
+
+	using request_t = std::pair<vertex_t, Edge>;
+	using buckets_t = std::map<long, std::vector<vertex_t>>;
+
+	// Collects relaxation requests for the edges of every vertex in frontier.
+	// Only requests that improve on the current distance are kept.
+	std::vector<request_t> GenerateRequests(
+			const std::vector<vertex_t>& frontier,
+			const std::vector<std::vector<Neighbor>>& adjacency,
+			const std::vector<Edge>& distances) const;
+
+	void Relax(const std::vector<request_t>& requests,
+			std::vector<Edge>& distances, buckets_t& buckets) const;
+
+	long BucketIndex(Edge distance) const
+	{ return static_cast<long>(std::floor(distance / delta_)); }
+
+	const network_t& network_;
+	Edge delta_;
+	std::vector<std::vector<Neighbor>> light_edges_, heavy_edges_;
+
+	// Below this frontier size threads cost more than they save.
+	static const std::size_t min_parallel_frontier{64};
+};
+
+
+template <typename Vertex, typename Edge>
+DeltaStepping<Vertex, Edge>::DeltaStepping(const network_t& network,
+		Edge delta) : network_(network), delta_{delta},
+		light_edges_(network.GetVertexDescriptors().size()),
+		heavy_edges_(network.GetVertexDescriptors().size()) {
+	if (!(delta_ > 0)) {
+		throw std::invalid_argument{"delta must be positive"};
+	}
+
+	// Split the out edges of every vertex into light and heavy edges. Rows are
+	// independent, so they're extracted in parallel.
+	bool negative_weight{false};
+	std::mutex negative_weight_mutex;
+	auto num_vertices = network_.GetVertexDescriptors().size();
+	PerformFunctionOnRange([this, &negative_weight, &negative_weight_mutex](
+				boost::counting_iterator<vertex_t> first,
+				boost::counting_iterator<vertex_t> last) {
+			for (auto it = first; it != last; ++it) {
+				for (const auto& edge_d : network_.GetOutEdgeDescriptors(*it)) {
+					Neighbor neighbor{
+						network_.GetTargetDescriptor(edge_d), network_[edge_d]};
+					if (neighbor.weight < 0) {
+						std::lock_guard<std::mutex> lg{negative_weight_mutex};
+						negative_weight = true;
+					}
+
+					if (neighbor.weight <= delta_)
+					{ light_edges_[*it].push_back(neighbor); }
+					else { heavy_edges_[*it].push_back(neighbor); }
+				}
+			}
+		},
+		boost::counting_iterator<vertex_t>{0},
+		boost::counting_iterator<vertex_t>{num_vertices});
+
+	if (negative_weight) {
+		throw std::invalid_argument{
+			"delta-stepping requires non-negative edge weights"};
+	}
+}
+
+
+template <typename Vertex, typename Edge>
+std::vector<Edge> DeltaStepping<Vertex, Edge>::FindDistanceVector(
+		vertex_t start) const {
+	std::vector<Edge> distances(
+			light_edges_.size(), std::numeric_limits<Edge>::max());
+	buckets_t buckets;
+	Relax({{start, Edge{}}}, distances, buckets);
+
+	// last_bucket is used to visit each vertex at most once per phase
+	std::vector<long> last_bucket(distances.size(), -1);
+	while (!buckets.empty()) {
+		auto bucket_index = buckets.begin()->first;
+		std::vector<vertex_t> settled;
+
+		// keep relaxing light edges until the bucket stops refilling
+		while (!buckets.empty() && buckets.begin()->first == bucket_index) {
+			std::vector<vertex_t> frontier;
+			for (auto vertex : buckets.begin()->second) {
+				// skip stale entries for vertices that moved to a lower bucket
+				// and duplicates within the bucket
+				if (BucketIndex(distances[vertex]) != bucket_index ||
+						last_bucket[vertex] == bucket_index) { continue; }
+				last_bucket[vertex] = bucket_index;
+				frontier.push_back(vertex);
+			}
+			buckets.erase(buckets.begin());
+
+			Relax(GenerateRequests(frontier, light_edges_, distances),
+				  distances, buckets);
+			settled.insert(std::end(settled), std::begin(frontier),
+						   std::end(frontier));
+
+			// vertices improved inside this bucket must be relaxed again
+			auto refilled = buckets.find(bucket_index);
+			if (refilled != buckets.end()) {
+				for (auto vertex : refilled->second)
+				{ last_bucket[vertex] = -1; }
+			}
+		}
+
+		// heavy edges can never land in the current bucket
+		Relax(GenerateRequests(settled, heavy_edges_, distances),
+			  distances, buckets);
+	}
+
+	return distances;
+}
+
+
+template <typename Vertex, typename Edge>
+std::map<Vertex, Edge> DeltaStepping<Vertex, Edge>::FindDistances(
+		vertex_t start) const {
+	auto distances = FindDistanceVector(start);
+
+	// Descriptors are useless. Remap descriptors to bundled Vertex property.
+	std::map<Vertex, Edge> output;
+	for (vertex_t vertex_descriptor{0}; vertex_descriptor < distances.size();
+			++vertex_descriptor) {
+		auto distance = distances[vertex_descriptor];
+
+		// Filter out disconnected vertices and the start vertex.
+		if (distance == std::numeric_limits<Edge>::max()) { continue; }
+		if (start == vertex_descriptor) { continue; }
+
+		output[network_[vertex_descriptor]] = distance;
+	}
+
+	return output;
+}
+
+
+template <typename Vertex, typename Edge>
+std::vector<typename DeltaStepping<Vertex, Edge>::request_t>
+DeltaStepping<Vertex, Edge>::GenerateRequests(
+		const std::vector<vertex_t>& frontier,
+		const std::vector<std::vector<Neighbor>>& adjacency,
+		const std::vector<Edge>& distances) const {
+	std::vector<request_t> requests;
+	auto generate = [&adjacency, &distances](
+			typename std::vector<vertex_t>::const_iterator first,
+			typename std::vector<vertex_t>::const_iterator last,
+			std::vector<request_t>& output) {
+		for (auto it = first; it != last; ++it) {
+			for (const auto& neighbor : adjacency[*it]) {
+				Edge distance{distances[*it] + neighbor.weight};
+				if (distance < distances[neighbor.target])
+				{ output.emplace_back(neighbor.target, distance); }
+			}
+		}
+	};
+
+	if (frontier.size() < min_parallel_frontier) {
+		generate(std::begin(frontier), std::end(frontier), requests);
+		return requests;
+	}
+
+	// distances are only read while generating, so no locking is needed
+	// until the requests of a thread are appended to the output
+	CountingMutex requests_mutex{"delta_stepping"};
+	PerformFunctionOnRange([&generate, &requests, &requests_mutex](
+				typename std::vector<vertex_t>::const_iterator first,
+				typename std::vector<vertex_t>::const_iterator last) {
+			std::vector<request_t> thread_requests;
+			generate(first, last, thread_requests);
+
+			std::lock_guard<CountingMutex> lg{requests_mutex};
+			requests.insert(std::end(requests), std::begin(thread_requests),
+							std::end(thread_requests));
+		}, frontier.cbegin(), frontier.cend());
+
+	return requests;
+}
+
+
+template <typename Vertex, typename Edge>
+void DeltaStepping<Vertex, Edge>::Relax(const std::vector<request_t>& requests,
+		std::vector<Edge>& distances, buckets_t& buckets) const {
+	for (const auto& request : requests) {
+		if (request.second < distances[request.first]) {
+			distances[request.first] = request.second;
+			// the entry in the old bucket becomes stale and is skipped later
+			buckets[BucketIndex(request.second)].push_back(request.first);
+		}
+	}
+}
+
+
+#endif  // DELTA_STEPPING_H
@@ -0,0 +1,134 @@
+#include "delta_stepping.hpp"
+
+#include <map>
+#include <random>
+#include <stdexcept>
+
+#include <boost/graph/adjacency_matrix.hpp>
+#include "gtest/gtest.h"
+
+#include "student.hpp"
+#include "student_network.hpp"
+#include "utility.hpp"
+
+
+using std::map;
+using std::mt19937;
+using std::uniform_real_distribution;
+
+using boost::add_edge;
+using boost::vertex;
+
+
+class DeltaSteppingTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		StudentNetwork::graph_t graph{6};
+
+		// add vertices
+		auto student1 = vertex(0, graph);
+		graph[student1] = Student::Id{147195};
+		auto student2 = vertex(1, graph);
+		graph[student2] = Student::Id{312995};
+		auto student3 = vertex(2, graph);
+		graph[student3] = Student::Id{352468};
+		auto student4 = vertex(3, graph);
+		graph[student4] = Student::Id{500928};
+		auto student5 = vertex(4, graph);
+		graph[student5] = Student::Id{567890};
+		// student 6 is disconnected
+		auto student6 = vertex(5, graph);
+		graph[student6] = Student::Id{1};
+
+		// add edges
+		add_edge(student1, student2, 3.0, graph);
+		add_edge(student1, student3, 0.25, graph);
+		add_edge(student1, student4, 1.0, graph);
+
+		add_edge(student2, student3, 1.0, graph);
+		add_edge(student2, student4, 3.0, graph);
+
+		add_edge(student3, student4, 0.5, graph);
+		add_edge(student3, student5, 1.5, graph);
+
+		network = StudentNetwork{graph};
+
+		// dense graph with fractional weights like CreditHoursOverEnrollment
+		const int num_random_vertices{200};
+		StudentNetwork::graph_t random_graph{num_random_vertices};
+		mt19937 generator{42};
+		uniform_real_distribution<double> probability{0., 1.};
+		uniform_real_distribution<double> weight{0.01, 2.};
+		for (int i{0}; i < num_random_vertices; ++i) {
+			random_graph[vertex(i, random_graph)] = Student::Id{i};
+			for (int j{0}; j < i; ++j) {
+				if (probability(generator) < 0.1) {
+					add_edge(vertex(i, random_graph), vertex(j, random_graph),
+							 weight(generator), random_graph);
+				}
+			}
+		}
+		random_network = StudentNetwork{random_graph};
+	}
+
+	void TearDown() override { num_threads = 1; }
+
+ protected:
+	void ExpectSameDistances(const StudentNetwork& test_network, double delta) {
+		DeltaStepping<Student::Id, double> delta_stepping{test_network, delta};
+		for (auto vertex_d : test_network.GetVertexDescriptors()) {
+			auto expected = test_network.FindWeightedDistances(vertex_d);
+			auto actual = delta_stepping.FindDistances(vertex_d);
+
+			ASSERT_EQ(expected.size(), actual.size());
+			for (const auto& elt : expected) {
+				ASSERT_EQ(1u, actual.count(elt.first));
+				EXPECT_DOUBLE_EQ(elt.second, actual.at(elt.first));
+			}
+		}
+	}
+
+	StudentNetwork network, random_network;
+};
+
+
+TEST_F(DeltaSteppingTest, FindDistances) {
+	DeltaStepping<Student::Id, double> delta_stepping{network, 1.};
+	auto distances = delta_stepping.FindDistances(
+			network.GetVertexDescriptor(Student::Id{147195}));
+
+	map<Student::Id, double> expected{
+		{312995, 1.25}, {352468, 0.25}, {500928, 0.75}, {567890, 1.75}};
+	ASSERT_EQ(expected.size(), distances.size());
+	for (const auto& elt : expected)
+	{ EXPECT_DOUBLE_EQ(elt.second, distances.at(elt.first)); }
+}
+
+
+TEST_F(DeltaSteppingTest, MatchesDijkstra) {
+	for (double delta : {0.1, 1., 10.}) {
+		ExpectSameDistances(network, delta);
+		ExpectSameDistances(random_network, delta);
+	}
+}
+
+
+TEST_F(DeltaSteppingTest, MatchesDijkstraInParallel) {
+	num_threads = 4;
+	for (double delta : {0.05, 0.5, 5.}) {
+		ExpectSameDistances(network, delta);
+		ExpectSameDistances(random_network, delta);
+	}
+}
+
+
+TEST_F(DeltaSteppingTest, InvalidInput) {
+	EXPECT_THROW((DeltaStepping<Student::Id, double>{network, 0.}),
+				 std::invalid_argument);
+
+	auto student1 = network.GetVertexDescriptor(Student::Id{147195});
+	auto student2 = network.GetVertexDescriptor(Student::Id{312995});
+	network(student1, student2) = -1.;
+	EXPECT_THROW((DeltaStepping<Student::Id, double>{network, 1.}),
+				 std::invalid_argument);
+}
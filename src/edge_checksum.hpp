@@ -0,0 +1,104 @@
+#ifndef EDGE_CHECKSUM_H
+#define EDGE_CHECKSUM_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "utility.hpp"
+
+
+// network.hpp includes this to checksum the edges it saves
+template <typename Vertex, typename Edge>
+class Network;
+
+
+// A checksum of the edge set of a network that doesn't depend on the order
+// the edges were added in or on the direction of an edge, so builds with any
+// number of threads can be compared. Every edge is hashed from the hashes of
+// its two vertex values, smaller first, and its weight rounded to
+// 1 / weight_quantum, and the edge hashes are summed modulo 2^64. Checksums of
+// disjoint sets of edges can be combined in any order.
+class EdgeChecksum {
+ public:
+	static constexpr double weight_quantum{1e6};
+
+	EdgeChecksum() : sum_{0}, num_edges_{0} {}
+
+	void Add(std::uint64_t vertex_hash1, std::uint64_t vertex_hash2,
+			 double weight) {
+		auto quantized_weight = static_cast<std::uint64_t>(
+				std::llround(weight * weight_quantum));
+		auto hash = MixBits(std::min(vertex_hash1, vertex_hash2));
+		hash = MixBits(hash ^ std::max(vertex_hash1, vertex_hash2));
+		sum_ += MixBits(hash ^ quantized_weight);
+		++num_edges_;
+	}
+
+	template <typename Vertex, typename Hasher = std::hash<Vertex>>
+	void AddEdge(const Vertex& vertex1, const Vertex& vertex2, double weight,
+				 Hasher hasher = Hasher{})
+	{ Add(hasher(vertex1), hasher(vertex2), weight); }
+
+	void Combine(const EdgeChecksum& other) {
+		sum_ += other.sum_;
+		num_edges_ += other.num_edges_;
+	}
+
+	long num_edges() const { return num_edges_; }
+
+	// The sum as 16 hex digits.
+	std::string ToString() const {
+		std::ostringstream output;
+		output << std::hex << std::setw(16) << std::setfill('0') << sum_;
+		return output.str();
+	}
+
+	bool operator==(const EdgeChecksum& other) const
+	{ return sum_ == other.sum_ && num_edges_ == other.num_edges_; }
+	bool operator!=(const EdgeChecksum& other) const
+	{ return !(*this == other); }
+
+ private:
+	std::uint64_t sum_;
+	long num_edges_;
+};
+
+
+// The weight read back from one written to a stream with the given precision,
+// so a checksum of the written weights can be checked against the file.
+// Floating point weights are rounded like the stream does, others are exact.
+template <typename Weight>
+double GetWrittenWeight(Weight weight, std::streamsize precision) {
+	if (!std::is_floating_point<Weight>::value) { return weight; }
+	char text[32];
+	std::snprintf(text, sizeof(text), "%.*g", static_cast<int>(precision),
+			static_cast<double>(weight));
+	return std::strtod(text, nullptr);
+}
+
+
+// Computes the checksum of every edge in the network.
+template <typename Vertex, typename Edge,
+		  typename Hasher = std::hash<Vertex>>
+EdgeChecksum ComputeEdgeChecksum(const Network<Vertex, Edge>& network,
+								 Hasher hasher = Hasher{}) {
+	EdgeChecksum checksum;
+	for (const auto& edge_d : network.GetEdgeDescriptors()) {
+		checksum.AddEdge(network.GetSourceValue(edge_d),
+				network.GetTargetValue(edge_d), network[edge_d], hasher);
+	}
+	return checksum;
+}
+
+
+#endif  // EDGE_CHECKSUM_H
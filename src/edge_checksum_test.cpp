@@ -0,0 +1,100 @@
+#include "edge_checksum.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "network.hpp"
+
+
+using std::stringstream;
+using std::vector;
+
+
+TEST(EdgeChecksumTest, OrderAndDirection) {
+	EdgeChecksum checksum1;
+	checksum1.AddEdge(1, 2, 0.5);
+	checksum1.AddEdge(3, 4, 2.);
+	checksum1.AddEdge(1, 3, 1.);
+
+	EdgeChecksum checksum2;
+	checksum2.AddEdge(3, 1, 1.);
+	checksum2.AddEdge(2, 1, 0.5);
+	checksum2.AddEdge(4, 3, 2.);
+
+	EXPECT_EQ(checksum1, checksum2);
+	EXPECT_EQ(checksum1.ToString(), checksum2.ToString());
+	EXPECT_EQ(3, checksum1.num_edges());
+	EXPECT_EQ(16u, checksum1.ToString().size());
+}
+
+
+TEST(EdgeChecksumTest, Differences) {
+	EdgeChecksum checksum;
+	checksum.AddEdge(1, 2, 0.5);
+
+	EdgeChecksum other_weight;
+	other_weight.AddEdge(1, 2, 0.25);
+	EXPECT_NE(checksum, other_weight);
+
+	EdgeChecksum other_vertex;
+	other_vertex.AddEdge(1, 3, 0.5);
+	EXPECT_NE(checksum, other_vertex);
+
+	// weights only differing past the quantum are the same
+	EdgeChecksum rounded_weight;
+	rounded_weight.AddEdge(1, 2, 0.5 + 1e-9);
+	EXPECT_EQ(checksum, rounded_weight);
+
+	EXPECT_NE(EdgeChecksum{}, checksum);
+}
+
+
+TEST(EdgeChecksumTest, Combine) {
+	EdgeChecksum all;
+	vector<EdgeChecksum> parts(3);
+	for (int i{0}; i < 9; ++i) {
+		all.AddEdge(i, i + 1, i / 4.);
+		parts[i % 3].AddEdge(i, i + 1, i / 4.);
+	}
+
+	EdgeChecksum combined;
+	for (int i{2}; i >= 0; --i) { combined.Combine(parts[i]); }
+	EXPECT_EQ(all, combined);
+	EXPECT_EQ(9, combined.num_edges());
+}
+
+
+TEST(EdgeChecksumTest, ComputeEdgeChecksum) {
+	vector<int> values{10, 20, 30, 40};
+	Network<int, double> network{values.begin(), values.end()};
+	auto vertex_it = network.GetVertexDescriptors().begin();
+	network(vertex_it[0], vertex_it[1]) = 1.5;
+	network(vertex_it[2], vertex_it[1]) = 2.;
+	network(vertex_it[3], vertex_it[0]) = 0.25;
+
+	EdgeChecksum expected;
+	expected.AddEdge(20, 30, 2.);
+	expected.AddEdge(10, 40, 0.25);
+	expected.AddEdge(20, 10, 1.5);
+	EXPECT_EQ(expected, ComputeEdgeChecksum(network));
+}
+
+
+TEST(EdgeChecksumTest, SaveEdgewise) {
+	vector<int> values{10, 20, 30};
+	Network<int, double> network{values.begin(), values.end()};
+	auto vertex_it = network.GetVertexDescriptors().begin();
+	network(vertex_it[0], vertex_it[1]) = 1234.56789;
+	network(vertex_it[2], vertex_it[1]) = 2.;
+
+	// the checksum is of the weights as written, so it can be recomputed
+	// from the file
+	stringstream output;
+	EdgeChecksum expected;
+	expected.AddEdge(10, 20, 1234.57);
+	expected.AddEdge(30, 20, 2.);
+	EXPECT_EQ(expected, network.SaveEdgewise(output));
+	EXPECT_NE(ComputeEdgeChecksum(network), network.SaveEdgewise(output));
+}
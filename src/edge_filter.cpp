@@ -0,0 +1,103 @@
+#include "edge_filter.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "student.hpp"
+
+
+using std::begin; using std::end;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+
+bool EdgeFilter::KeepPair(const Student& student1,
+						  const Student& student2) const {
+	if (min_shared_courses <= 1) { return true; }
+
+	// count the courses in common, stopping once there are enough
+	const auto& courses1 = student1.courses_taken();
+	const auto& courses2 = student2.courses_taken();
+	int shared_courses{0};
+	for (auto it1 = begin(courses1), it2 = begin(courses2);
+			it1 != end(courses1) && it2 != end(courses2);) {
+		if (*it1 < *it2) { ++it1; }
+		else if (*it2 < *it1) { ++it2; }
+		else {
+			if (++shared_courses == min_shared_courses) { return true; }
+			++it1;
+			++it2;
+		}
+	}
+	return false;
+}
+
+
+string EdgeFilter::ToString() const {
+	ostringstream output;
+	output.precision(std::numeric_limits<double>::max_digits10);
+	output << "min_weight=" << min_weight << ",min_shared_courses="
+		   << min_shared_courses << ",top_k=" << top_k;
+	return output.str();
+}
+
+
+TopNeighbors::TopNeighbors(long num_students, int k) :
+	k_{k}, neighbors_(num_students) {}
+
+
+void TopNeighbors::Offer(long row, long column, double weight) {
+	Offer(row, {column, weight});
+	Offer(column, {row, weight});
+}
+
+
+void TopNeighbors::Offer(long student, Neighbor neighbor) {
+	auto& neighbors = neighbors_[student];
+	if (static_cast<int>(neighbors.size()) < k_) {
+		neighbors.push_back(neighbor);
+		std::push_heap(begin(neighbors), end(neighbors));
+	} else if (neighbor < neighbors.front()) {
+		std::pop_heap(begin(neighbors), end(neighbors));
+		neighbors.back() = neighbor;
+		std::push_heap(begin(neighbors), end(neighbors));
+	}
+}
+
+
+void TopNeighbors::Merge(const TopNeighbors& other) {
+	for (long student{0}; student < static_cast<long>(neighbors_.size());
+			++student) {
+		for (const auto& neighbor : other.neighbors_[student])
+		{ Offer(student, neighbor); }
+	}
+}
+
+
+vector<RowEdges> TopNeighbors::GetRows() const {
+	vector<RowEdges> rows(neighbors_.size());
+	for (long student{0}; student < static_cast<long>(neighbors_.size());
+			++student) {
+		for (const auto& neighbor : neighbors_[student]) {
+			auto row = std::min(student, neighbor.index);
+			auto column = std::max(student, neighbor.index);
+			rows[row].push_back({column, neighbor.weight});
+		}
+	}
+
+	// an edge in the top k of both its students is found twice
+	for (auto& edges : rows) {
+		std::sort(begin(edges), end(edges),
+				[](const RowEdge& edge1, const RowEdge& edge2)
+				{ return edge1.column < edge2.column; });
+		edges.erase(std::unique(begin(edges), end(edges),
+					[](const RowEdge& edge1, const RowEdge& edge2)
+					{ return edge1.column == edge2.column; }),
+				end(edges));
+	}
+	return rows;
+}
@@ -0,0 +1,76 @@
+#ifndef EDGE_FILTER_H
+#define EDGE_FILTER_H
+
+#include <string>
+#include <vector>
+
+#include "network_shard.hpp"
+
+
+class Student;
+
+
+// Sparsifies the student network as it's built. The workers drop edges that
+// don't pass the filter before they're recorded, so they're never stored or
+// saved.
+struct EdgeFilter {
+	// edges lighter than this are dropped
+	double min_weight{0.};
+	// students sharing fewer courses than this aren't connected
+	int min_shared_courses{1};
+	// if positive, an edge is only kept if it's among the top_k heaviest of
+	// one of its students
+	int top_k{0};
+
+	// Whether the filter drops any edges.
+	bool IsActive() const
+	{ return min_weight > 0. || min_shared_courses > 1 || top_k > 0; }
+
+	// Whether the students share enough courses, checked before weighting.
+	bool KeepPair(const Student& student1, const Student& student2) const;
+
+	bool KeepWeight(double weight) const { return weight >= min_weight; }
+
+	// Describes the filter without spaces, e.g. to label a build with it.
+	std::string ToString() const;
+};
+
+
+// The top k heaviest edges of every student, found a row at a time. Ties go
+// to the neighbor at the lower index, so the edges kept don't depend on the
+// order they're offered in.
+class TopNeighbors {
+ public:
+	TopNeighbors(long num_students, int k);
+
+	// Offers the edge between the students at row and column to both.
+	void Offer(long row, long column, double weight);
+
+	// Adds the neighbors kept by other, e.g. another worker.
+	void Merge(const TopNeighbors& other);
+
+	// Returns the edges among the top k of either of their students, by row,
+	// with columns after the row in increasing order.
+	std::vector<RowEdges> GetRows() const;
+
+ private:
+	struct Neighbor {
+		long index;
+		double weight;
+
+		// a heavier neighbor, or as heavy and at a lower index, is better
+		bool operator<(const Neighbor& other) const {
+			return weight > other.weight ||
+				(weight == other.weight && index < other.index);
+		}
+	};
+
+	void Offer(long student, Neighbor neighbor);
+
+	int k_;
+	// a heap of every student's neighbors, with the worst on top
+	std::vector<std::vector<Neighbor>> neighbors_;
+};
+
+
+#endif  // EDGE_FILTER_H
@@ -0,0 +1,106 @@
+#include "edge_filter.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "course.hpp"
+#include "student.hpp"
+
+
+using std::vector;
+
+
+TEST(EdgeFilterTest, KeepPair) {
+	auto course1 = Course{"ENGLISH", 125, 0, 4};
+	auto course2 = Course{"AAPTIS", 277, 0, 4};
+	auto course3 = Course{"CHEM", 210, 0, 4};
+	Student student1{1};
+	student1.AddCoursesTaken({&course1, &course2, &course3});
+	Student student2{2};
+	student2.AddCoursesTaken({&course3, &course1});
+	Student student3{3};
+	student3.AddCourseTaken(&course2);
+
+	EdgeFilter filter;
+	EXPECT_FALSE(filter.IsActive());
+	EXPECT_TRUE(filter.KeepPair(student2, student3));
+
+	filter.min_shared_courses = 2;
+	EXPECT_TRUE(filter.IsActive());
+	EXPECT_TRUE(filter.KeepPair(student1, student2));
+	EXPECT_TRUE(filter.KeepPair(student2, student1));
+	EXPECT_FALSE(filter.KeepPair(student1, student3));
+
+	filter.min_shared_courses = 3;
+	EXPECT_FALSE(filter.KeepPair(student1, student2));
+	EXPECT_TRUE(filter.KeepPair(student1, student1));
+}
+
+
+TEST(EdgeFilterTest, KeepWeight) {
+	EdgeFilter filter;
+	EXPECT_TRUE(filter.KeepWeight(0.01));
+
+	filter.min_weight = 0.5;
+	EXPECT_TRUE(filter.IsActive());
+	EXPECT_TRUE(filter.KeepWeight(0.5));
+	EXPECT_FALSE(filter.KeepWeight(0.49));
+	EXPECT_EQ("min_weight=0.5,min_shared_courses=1,top_k=0",
+			filter.ToString());
+}
+
+
+TEST(TopNeighborsTest, KeepEitherStudentsTop) {
+	// 0 and 1 are each other's heaviest, 2's heaviest is 0 and 3's heaviest
+	// ties between 1 and 2, so the lower index is kept
+	TopNeighbors top_neighbors{4, 1};
+	top_neighbors.Offer(0, 1, 3.);
+	top_neighbors.Offer(0, 2, 2.);
+	top_neighbors.Offer(1, 2, 1.);
+	top_neighbors.Offer(2, 3, 0.5);
+	top_neighbors.Offer(1, 3, 0.5);
+
+	auto rows = top_neighbors.GetRows();
+	ASSERT_EQ(4u, rows.size());
+	ASSERT_EQ(2u, rows[0].size());
+	EXPECT_EQ(1, rows[0][0].column);
+	EXPECT_DOUBLE_EQ(3., rows[0][0].weight);
+	EXPECT_EQ(2, rows[0][1].column);
+	ASSERT_EQ(1u, rows[1].size());
+	EXPECT_EQ(3, rows[1][0].column);
+	EXPECT_TRUE(rows[2].empty());
+	EXPECT_TRUE(rows[3].empty());
+}
+
+
+TEST(TopNeighborsTest, Merge) {
+	// however the edges are split between workers, the same are kept
+	vector<RowEdges> expected_rows;
+	{
+		TopNeighbors top_neighbors{4, 2};
+		for (long row{0}; row < 4; ++row) {
+			for (long column{row + 1}; column < 4; ++column)
+			{ top_neighbors.Offer(row, column, row + column % 2); }
+		}
+		expected_rows = top_neighbors.GetRows();
+	}
+
+	TopNeighbors worker1{4, 2}, worker2{4, 2};
+	for (long row{3}; row >= 0; --row) {
+		for (long column{row + 1}; column < 4; ++column) {
+			auto& worker = column % 2 ? worker1 : worker2;
+			worker.Offer(row, column, row + column % 2);
+		}
+	}
+	worker2.Merge(worker1);
+	auto rows = worker2.GetRows();
+	ASSERT_EQ(expected_rows.size(), rows.size());
+	for (std::size_t row{0}; row < rows.size(); ++row) {
+		ASSERT_EQ(expected_rows[row].size(), rows[row].size());
+		for (std::size_t i{0}; i < rows[row].size(); ++i) {
+			EXPECT_EQ(expected_rows[row][i].column, rows[row][i].column);
+			EXPECT_EQ(expected_rows[row][i].weight, rows[row][i].weight);
+		}
+	}
+}
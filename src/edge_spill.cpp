@@ -0,0 +1,187 @@
+#include "edge_spill.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_member.hpp>
+
+#include "student_container.hpp"
+#include "trace.hpp"
+
+
+using std::begin; using std::end;
+using std::function;
+using std::ifstream; using std::ofstream; using std::ostream;
+using std::lock_guard;
+using std::priority_queue;
+using std::string; using std::to_string;
+using std::unique_ptr;
+using std::vector;
+
+
+// runs are read this many edges (64 KB) at a time, the merge holds a block of
+// every run
+const std::size_t read_block_size{1 << 12};
+
+
+EdgeRuns::EdgeRuns(const string& scratch_dir) :
+	scratch_dir_{scratch_dir}, num_edges_{0}, next_run_{0},
+	runs_mutex_{"spill"} {}
+
+
+EdgeRuns::~EdgeRuns() {
+	for (const auto& path : paths_) { std::remove(path.c_str()); }
+}
+
+
+void EdgeRuns::Spill(vector<SpilledEdge>& edges) {
+	TRACE_SCOPE("spill_run");
+	std::sort(begin(edges), end(edges));
+
+	// processes sharing the scratch directory don't clash
+	auto path = scratch_dir_ + "/edges_" + to_string(getpid()) + "_" +
+		to_string(next_run_++) + ".run";
+	{
+		lock_guard<CountingMutex> runs_lock_guard{runs_mutex_};
+		paths_.push_back(path);
+		num_edges_ += edges.size();
+	}
+
+	auto num_bytes = edges.size() * sizeof(SpilledEdge);
+	ofstream output{path, std::ios::binary};
+	output.write(reinterpret_cast<const char*>(edges.data()), num_bytes);
+	output.close();
+	if (!output) {
+		throw SpillError{"Could not write a run of " +
+			to_string(edges.size()) + " edges to " + path + "!"};
+	}
+
+	AddToCounter("spill_runs", 1);
+	AddToCounter("edges_spilled", edges.size());
+	AddToCounter("bytes_spilled", num_bytes);
+	edges.clear();
+}
+
+
+// Reads the edges of a run a block at a time.
+class RunReader {
+ public:
+	RunReader(const string& path) :
+			path_{path}, input_{path, std::ios::binary}, position_{0} {
+		if (!input_.is_open())
+		{ throw SpillError{"Could not open the run " + path + "!"}; }
+		Refill();
+	}
+
+	bool done() const { return position_ == block_.size(); }
+	const SpilledEdge& edge() const { return block_[position_]; }
+
+	void Next() { if (++position_ == block_.size()) { Refill(); } }
+
+ private:
+	void Refill() {
+		block_.resize(read_block_size);
+		input_.read(reinterpret_cast<char*>(block_.data()),
+				block_.size() * sizeof(SpilledEdge));
+		if (input_.bad()) { throw SpillError{"Could not read " + path_ + "!"}; }
+		block_.resize(input_.gcount() / sizeof(SpilledEdge));
+		position_ = 0;
+	}
+
+	string path_;
+	ifstream input_;
+	vector<SpilledEdge> block_;
+	std::size_t position_;
+};
+
+
+void EdgeRuns::Merge(const function<void(const SpilledEdge&)>& visit) const {
+	TRACE_SCOPE("merge_runs");
+	vector<unique_ptr<RunReader>> readers;
+	for (const auto& path : paths_)
+	{ readers.emplace_back(new RunReader{path}); }
+
+	// a heap of the readers by their next edge, smallest on top
+	auto greater = [&readers](int reader1, int reader2)
+	{ return readers[reader2]->edge() < readers[reader1]->edge(); };
+	priority_queue<int, vector<int>, decltype(greater)> heap{greater};
+	for (int i{0}; i < static_cast<int>(readers.size()); ++i)
+	{ if (!readers[i]->done()) { heap.push(i); } }
+
+	while (!heap.empty()) {
+		auto reader = heap.top();
+		heap.pop();
+		visit(readers[reader]->edge());
+		readers[reader]->Next();
+		if (!readers[reader]->done()) { heap.push(reader); }
+	}
+}
+
+
+EdgeSpiller::EdgeSpiller(EdgeRuns& runs, std::size_t capacity) :
+	runs_(runs), capacity_{std::max<std::size_t>(capacity, 1)} {
+	edges_.reserve(capacity_);
+}
+
+
+void EdgeSpiller::Flush() { if (!edges_.empty()) { runs_.Spill(edges_); } }
+
+
+// Writes what save() in adj_mat_serialize.hpp writes for a network of the
+// students and the merged runs, so they load like any saved network. The
+// counts are longs rather than ints, the text is the same.
+class SpilledNetwork {
+ public:
+	SpilledNetwork(const StudentContainer& students, const EdgeRuns& runs) :
+		students_(students), runs_(runs) {}
+
+	template <typename Archive>
+	void save(Archive& ar, const unsigned int) const {
+		long V = students_.size();
+		long E = runs_.num_edges();
+		ar << BOOST_SERIALIZATION_NVP(V);
+		ar << BOOST_SERIALIZATION_NVP(E);
+		for (const auto& student : students_) {
+			auto vertex = student.id();
+			ar << boost::serialization::make_nvp("vertex_property", vertex);
+		}
+
+		runs_.Merge([&ar](const SpilledEdge& edge) {
+			long u{edge.row1}, v{edge.row2};
+			auto weight = edge.weight;
+			ar << BOOST_SERIALIZATION_NVP(u);
+			ar << BOOST_SERIALIZATION_NVP(v);
+			ar << boost::serialization::make_nvp("edge_property", weight);
+		});
+	}
+
+	template <typename Archive>
+	void load(Archive&, const unsigned int) {}
+
+	BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+ private:
+	const StudentContainer& students_;
+	const EdgeRuns& runs_;
+};
+
+
+void SaveSpilledNetwork(const StudentContainer& students,
+						const EdgeRuns& runs, ostream& output) {
+	TRACE_SCOPE("save_network");
+	boost::archive::text_oarchive archive{output};
+	const SpilledNetwork network{students, runs};
+	archive << network;
+}
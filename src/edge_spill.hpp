@@ -0,0 +1,102 @@
+#ifndef EDGE_SPILL_H
+#define EDGE_SPILL_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "metrics.hpp"
+
+
+class StudentContainer;
+
+// Out-of-core building of the student network. Workers buffer the edges they
+// find and, whenever a buffer fills, sort it and spill it as a run to a file in
+// a scratch directory. A k-way merge of the runs then writes the edges straight
+// into the network archive, so the network never has to fit in memory.
+
+
+// An edge between the vertices at two indices, row1 > row2, ordered the way
+// Network::Save writes edges.
+struct SpilledEdge {
+	int row1, row2;
+	double weight;
+
+	bool operator<(const SpilledEdge& other) const {
+		return row1 < other.row1 ||
+			(row1 == other.row1 && row2 < other.row2);
+	}
+};
+
+
+// Sorted runs of edges saved in a scratch directory. The files are removed
+// when the runs are destroyed.
+class EdgeRuns {
+ public:
+	EdgeRuns(const std::string& scratch_dir);
+	~EdgeRuns();
+
+	EdgeRuns(const EdgeRuns&) = delete;
+	EdgeRuns& operator=(const EdgeRuns&) = delete;
+
+	// Sorts the edges and saves them as a new run. Throws SpillError if the
+	// run can't be written. Thread-safe.
+	void Spill(std::vector<SpilledEdge>& edges);
+
+	// Calls visit with the edges of every run in sorted order.
+	void Merge(const std::function<void(const SpilledEdge&)>& visit) const;
+
+	long num_edges() const { return num_edges_; }
+	int num_runs() const { return static_cast<int>(paths_.size()); }
+
+ private:
+	std::string scratch_dir_;
+	std::vector<std::string> paths_;
+	long num_edges_;
+	std::atomic<int> next_run_;
+	CountingMutex runs_mutex_;
+};
+
+
+// Buffers the edges of one worker, spilling them whenever capacity edges are
+// held. Flush must be called after the last edge.
+class EdgeSpiller {
+ public:
+	EdgeSpiller(EdgeRuns& runs, std::size_t capacity);
+
+	void Add(int row1, int row2, double weight) {
+		edges_.push_back({row1, row2, weight});
+		if (edges_.size() >= capacity_) { Flush(); }
+	}
+
+	// Spills whatever is buffered.
+	void Flush();
+
+ private:
+	EdgeRuns& runs_;
+	std::size_t capacity_;
+	std::vector<SpilledEdge> edges_;
+};
+
+
+// Saves the network of the students, in order, and the edges of the runs in
+// the format of Network::Save, so it loads as a StudentNetwork.
+void SaveSpilledNetwork(const StudentContainer& students,
+						const EdgeRuns& runs, std::ostream& output);
+
+
+class SpillError : public std::exception {
+ public:
+	SpillError(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // EDGE_SPILL_H
@@ -0,0 +1,99 @@
+#include "edge_spill.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "student.hpp"
+#include "student_container_mock.hpp"
+#include "student_network.hpp"
+
+
+using std::ifstream;
+using std::string; using std::to_string;
+using std::stringstream;
+using std::vector;
+
+using ::testing::NiceMock;
+using ::testing::Return;
+
+
+TEST(EdgeSpillTest, MergeRuns) {
+	vector<SpilledEdge> merged;
+	{
+		EdgeRuns runs{"/tmp"};
+		// three edges per run, every run out of order
+		EdgeSpiller spiller{runs, 3};
+		for (int row1{9}; row1 > 0; --row1) {
+			for (int row2{0}; row2 < row1; row2 += 2)
+			{ spiller.Add(row1, row2, row1 + row2 / 10.); }
+		}
+		spiller.Flush();
+		EXPECT_EQ(25, runs.num_edges());
+		EXPECT_EQ(9, runs.num_runs());
+
+		runs.Merge([&merged](const SpilledEdge& edge)
+				{ merged.push_back(edge); });
+	}
+
+	ASSERT_EQ(25u, merged.size());
+	for (auto i = 1u; i < merged.size(); ++i)
+	{ EXPECT_LT(merged[i - 1], merged[i]); }
+	EXPECT_EQ(1, merged.front().row1);
+	EXPECT_EQ(0, merged.front().row2);
+	EXPECT_EQ(9, merged.back().row1);
+	EXPECT_EQ(8, merged.back().row2);
+	EXPECT_DOUBLE_EQ(9.8, merged.back().weight);
+
+	// the runs are removed with them
+	ifstream first_run{"/tmp/edges_" + to_string(getpid()) + "_0.run"};
+	EXPECT_FALSE(first_run.is_open());
+}
+
+
+TEST(EdgeSpillTest, SaveSpilledNetwork) {
+	NiceMock<MockStudentContainer> students;
+	students.Insert({Student{10}, Student{20}, Student{30}, Student{40}});
+	ON_CALL(students, size()).WillByDefault(Return(4));
+
+	EdgeRuns runs{"/tmp"};
+	EdgeSpiller spiller{runs, 2};
+	spiller.Add(3, 1, 0.25);
+	spiller.Add(1, 0, 0.1 + 0.2);
+	spiller.Add(2, 0, 4.);
+	spiller.Flush();
+
+	stringstream saved;
+	SaveSpilledNetwork(students, runs, saved);
+	StudentNetwork network{saved};
+
+	ASSERT_EQ(4u, network.GetVertexDescriptors().size());
+	EXPECT_EQ(3u, network.GetEdgeDescriptors().size());
+	auto student10_d = network.GetVertexDescriptor(10);
+	auto student20_d = network.GetVertexDescriptor(20);
+	auto student30_d = network.GetVertexDescriptor(30);
+	auto student40_d = network.GetVertexDescriptor(40);
+	EXPECT_EQ(0.1 + 0.2, network.Get(student10_d, student20_d));
+	EXPECT_DOUBLE_EQ(4., network.Get(student10_d, student30_d));
+	EXPECT_DOUBLE_EQ(0.25, network.Get(student20_d, student40_d));
+	EXPECT_THROW(network.Get(student30_d, student40_d), NoEdgeException);
+
+	// saving the loaded network gives the same archive
+	stringstream resaved;
+	network.Save(resaved);
+	EXPECT_EQ(saved.str(), resaved.str());
+}
+
+
+TEST(EdgeSpillTest, UnwritableScratchDir) {
+	EdgeRuns runs{"/nonexistent_scratch_dir"};
+	EdgeSpiller spiller{runs, 10};
+	spiller.Add(1, 0, 1.);
+	EXPECT_THROW(spiller.Flush(), SpillError);
+}
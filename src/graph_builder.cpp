@@ -3,13 +3,17 @@
 #include <cassert>
 
 #include <algorithm>
-#include <chrono>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <set>
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -18,13 +22,23 @@
 
 #include <boost/optional.hpp>
 
+#include "build_checkpoint.hpp"
 #include "course.hpp"
 #include "course_container.hpp"
 #include "course_network.hpp"
-#include "mem_usage.hpp"
+#include "edge_checksum.hpp"
+#include "edge_filter.hpp"
+#include "edge_spill.hpp"
+#include "metrics.hpp"
+#include "minhash.hpp"
+#include "network_shard.hpp"
+#include "numa_placement.hpp"
+#include "progress.hpp"
 #include "student.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "temporal_network.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 #include "weighting_function.hpp"
 
@@ -32,33 +46,54 @@
 using std::begin; using std::end; using std::istream_iterator;
 using std::cerr; using std::cout; using std::endl;
 using std::cref; using std::ref; using std::bind; using std::placeholders::_1;
+using std::function;
 using std::istream;
-using std::lock_guard; using std::mutex;
+using std::lock_guard;
 using std::make_pair; using std::pair;
+using std::map;
 using std::set;
+using std::string;
 using std::thread;
+using std::unique_ptr;
 using std::unordered_map;
 using std::unordered_set;
 using std::vector;
-namespace chr = std::chrono;
 
 using boost::optional;
 
 using weighting_func_ptr = optional<double>(*)(const Student&, const Student&);
+// called with the edges of every finished row
+using finish_row_func = function<void(int worker, long row, const RowEdges&)>;
 
 
-// output timing information every time we have num_pairs % this variable == 0
-const int timing_modulus{10000000};
+int progress_period{0};
+
+// workers add to the shared metrics counters after this many pairs
+const long counter_flush_interval{1 << 16};
 
 
 static unordered_map<Student::Id, unordered_set<Course::Id, Course::Id::Hasher>> 
 GetStudentIdsToCourses(const StudentContainer& students);
 
+StudentNetwork BuildStudentNetwork(const StudentContainer& students,
+		weighting_func_ptr weighting_func, BuildCheckpoint* checkpoint,
+		const EdgeFilter& filter, const MinHashIndex* index);
 class StudentNetworkBuilder;
 void CalculateStudentNetworkEdges(const StudentNetwork& network,
 		const StudentContainer& students,
 		StudentNetworkBuilder& builder,
-		weighting_func_ptr weighting_func);
+		weighting_func_ptr weighting_func, const EdgeFilter& filter,
+		ProgressCounters& progress, int worker, EdgeChecksum& checksum);
+void CalculateRowsEdges(const StudentContainer& students,
+		weighting_func_ptr weighting_func, ShardRows rows,
+		BuildCheckpoint* checkpoint, const EdgeFilter& filter,
+		const finish_row_func& finish_row, const MinHashIndex* index = nullptr);
+void CalculateRowEdges(const StudentContainer& students,
+		weighting_func_ptr weighting_func, ShardRows rows,
+		NodeRows& node_rows, int node, BuildCheckpoint* checkpoint,
+		const EdgeFilter& filter, const MinHashIndex* index,
+		ProgressCounters& progress, int worker,
+		const finish_row_func& finish_row);
 
 
 template <typename T>
@@ -87,16 +122,28 @@ struct PairHasher {
 
 CourseNetwork BuildCourseNetworkFromEnrollment(
 		const StudentContainer& students) {
+	TRACE_SCOPE("build_course_network");
 	auto student_to_courses = GetStudentIdsToCourses(students);
 
 	// aggregate pairs of courses
 	unordered_map<DistinctUnorderedPair<Course::Id>,
 				  int, PairHasher<Course::Id::Hasher>> edge_weights;
 	unordered_set<Course::Id, Course::Id::Hasher> courses;
+
+	// the work is every pair of courses taken by the same student
+	long total_pairs{0};
+	for (const auto& elt : student_to_courses)
+	{ total_pairs += elt.second.size() * (elt.second.size() - 1) / 2; }
+	ProgressCounters progress{1};
+	ProgressReporter progress_reporter{
+		progress, total_pairs, "pairs", progress_period, cerr};
+
+	long num_pairs{0};
 	for (const auto& elt : student_to_courses) {
 		if (elt.second.size() == 1) { courses.insert(*elt.second.begin()); }
 
 		// get all pairs of courses
+		num_pairs += elt.second.size() * (elt.second.size() - 1) / 2;
 		for (auto it = elt.second.cbegin(); it != elt.second.cend(); ++it) {
 			for (auto it2 = it; ++it2 != elt.second.cend();) {
 				DistinctUnorderedPair<Course::Id> e{*it, *it2};
@@ -107,7 +154,9 @@ CourseNetwork BuildCourseNetworkFromEnrollment(
 				courses.insert(*it2);
 			}
 		}
+		progress.Update(0, num_pairs, edge_weights.size());
 	}
+	progress_reporter.Stop();
 
 	// create new graph so all vertices can be added at once
 	CourseNetwork course_network{begin(courses), end(courses)};
@@ -127,6 +176,10 @@ CourseNetwork BuildCourseNetworkFromEnrollment(
 		course_network(vertex1, vertex2) = weight;
 	}
 
+	AddToCounter("pairs_evaluated", num_pairs);
+	AddToCounter("edges_emitted", edge_weights.size());
+	SetLabel("edge_checksum", ComputeEdgeChecksum(
+				course_network, Course::Id::Hasher{}).ToString());
 	return course_network;
 }
 
@@ -135,8 +188,8 @@ class StudentNetworkBuilder {
  public:
 	StudentNetworkBuilder(
 			StudentNetwork& network, const StudentContainer& students) :
-				network_(network), num_pairs_{0},
-				beginning_pairs_time_{chr::system_clock::now()} {
+				network_(network), iterator_mutex_{"iterator"},
+				edges_mutex_{"edges"} {
 		// assign the vertices in the network
 		auto student_it = begin(students);
 		for (auto vertex_it = network_.GetVertexValues().begin();
@@ -153,15 +206,8 @@ class StudentNetworkBuilder {
 	pair<StudentNetwork::vertex_descriptors_t::iterator_t,
 		 StudentNetwork::vertex_descriptors_t::iterator_t>
 	GetNextIteratorPair() {
-		lock_guard<mutex> iterator_lock_guard{iterator_mutex_};
-
-		// output time information for profiling
-		if (++num_pairs_ % timing_modulus == 0) {
-			cerr << num_pairs_ << " " << chr::duration_cast<chr::seconds>(
-				chr::system_clock::now() -
-				beginning_pairs_time_).count() << endl;
-			cerr << "Mem usage: " << GetMemoryUsage() << endl;
-		}
+		TRACE_SCOPE("next_pair");
+		lock_guard<CountingMutex> iterator_lock_guard{iterator_mutex_};
 
 		// Return if we don't hit the end when incrementing the second iterator.
 		if (!ReachedEndOfStudents(++it2_)) { return make_pair(it1_, it2_); }
@@ -173,7 +219,8 @@ class StudentNetworkBuilder {
 
 	void AddEdge(StudentNetwork::vertex_t student1,
 			StudentNetwork::vertex_t student2, double value) {
-		lock_guard<mutex> edge_lock_guard{edges_mutex_};
+		TRACE_SCOPE("add_edge");
+		lock_guard<CountingMutex> edge_lock_guard{edges_mutex_};
 		network_(student1, student2) = value;
 	}
 
@@ -184,27 +231,82 @@ class StudentNetworkBuilder {
  private:
 	StudentNetwork& network_;
 	StudentNetwork::vertex_descriptors_t::iterator_t it1_, it2_;
-	long num_pairs_;
-	chr::time_point<chr::system_clock> beginning_pairs_time_;
 
-	mutex iterator_mutex_, edges_mutex_;
+	CountingMutex iterator_mutex_, edges_mutex_;
 };
 
 
 StudentNetwork BuildStudentNetworkFromStudents(
-		const StudentContainer& students, weighting_func_ptr weighting_func) {
+		const StudentContainer& students, weighting_func_ptr weighting_func,
+		BuildCheckpoint* checkpoint, const EdgeFilter& filter) {
+	TRACE_SCOPE("build_student_network");
+	return BuildStudentNetwork(
+			students, weighting_func, checkpoint, filter, nullptr);
+}
 
+
+StudentNetwork BuildApproximateStudentNetwork(
+		const StudentContainer& students, weighting_func_ptr weighting_func,
+		const MinHashOptions& options, const EdgeFilter& filter) {
+	TRACE_SCOPE("build_approximate_student_network");
+	MinHashIndex index{students, options};
+	return BuildStudentNetwork(
+			students, weighting_func, nullptr, filter, &index);
+}
+
+
+// Weights the pairs of students the index finds, or all of them without one.
+StudentNetwork BuildStudentNetwork(const StudentContainer& students,
+		weighting_func_ptr weighting_func, BuildCheckpoint* checkpoint,
+		const EdgeFilter& filter, const MinHashIndex* index) {
 	// spawn threads to iterate through each pair of students
 	StudentNetwork network{students.size()};
 	StudentNetworkBuilder builder{network, students};
-	vector<thread> thread_pool;
-	for (int i{0}; i < num_threads; ++i) {
-		thread_pool.emplace_back(CalculateStudentNetworkEdges, cref(network),
-				cref(students), ref(builder), weighting_func);
+	vector<EdgeChecksum> checksums(num_threads);
+
+	if (checkpoint || filter.top_k > 0 || index || GetNumNumaNodes() > 1) {
+		// checkpoints record finished rows, top neighbors are picked from whole
+		// rows, the index finds the candidates of a row and nodes have blocks
+		// of rows, so the workers claim rows
+		ShardRows rows{0, static_cast<long>(students.size())};
+		assert(!checkpoint || checkpoint->rows() == rows);
+		auto vertex_it = begin(network.GetVertexDescriptors());
+		auto student_it = begin(students);
+		CalculateRowsEdges(students, weighting_func, rows, checkpoint, filter,
+				[&](int worker, long row, const RowEdges& edges) {
+					for (const auto& edge : edges) {
+						builder.AddEdge(vertex_it[row], vertex_it[edge.column],
+								edge.weight);
+						checksums[worker].AddEdge(student_it[row].id(),
+								student_it[edge.column].id(), edge.weight);
+					}
+				}, index);
+	} else {
+		// every distinct pair of students is weighted
+		long total_pairs{static_cast<long>(students.size()) *
+			(static_cast<long>(students.size()) - 1) / 2};
+		ProgressCounters progress{num_threads};
+		ProgressReporter progress_reporter{
+			progress, total_pairs, "pairs", progress_period, cerr};
+
+		vector<thread> thread_pool;
+		for (int i{0}; i < num_threads; ++i) {
+			thread_pool.emplace_back(CalculateStudentNetworkEdges,
+					cref(network), cref(students), ref(builder),
+					weighting_func, cref(filter), ref(progress), i,
+					ref(checksums[i]));
+		}
+
+		// wait for all threads to complete
+		for_each(begin(thread_pool), end(thread_pool),
+				bind(&thread::join, _1));
 	}
 
-	// wait for all threads to complete
-	for_each(begin(thread_pool), end(thread_pool), bind(&thread::join, _1));
+	// the edges each worker added are disjoint, so their checksums combine
+	EdgeChecksum checksum;
+	for (const auto& worker_checksum : checksums)
+	{ checksum.Combine(worker_checksum); }
+	SetLabel("edge_checksum", checksum.ToString());
 
 	return network;
 }
@@ -213,20 +315,392 @@ StudentNetwork BuildStudentNetworkFromStudents(
 void CalculateStudentNetworkEdges(const StudentNetwork& network,
 								  const StudentContainer& students,
 								  StudentNetworkBuilder& builder,
-								  weighting_func_ptr weighting_func) {
+								  weighting_func_ptr weighting_func,
+								  const EdgeFilter& filter,
+								  ProgressCounters& progress, int worker,
+								  EdgeChecksum& checksum) {
+	long num_pairs{0}, num_edges{0}, num_filtered{0}, total_pairs{0},
+		 total_edges{0};
+	EdgeChecksum worker_checksum;
 	for (auto it_pair = builder.GetNextIteratorPair();
 			!builder.ReachedEndOfStudents(it_pair.first);
 			it_pair = builder.GetNextIteratorPair()) {
 		if (it_pair.first == it_pair.second) { continue; }
+		TRACE_SCOPE("evaluate_pair");
 		// Get the courses each of the students have taken.
 		const Student& student1(students.Find(network[*it_pair.first]));
 		const Student& student2(students.Find(network[*it_pair.second]));
 
-		if (auto connection = weighting_func(student1, student2)) {
+		auto connection = filter.KeepPair(student1, student2) ?
+			weighting_func(student1, student2) : boost::none;
+		if (connection && !filter.KeepWeight(connection.value())) {
+			++num_filtered;
+		} else if (connection) {
 			builder.AddEdge(
 					*it_pair.first, *it_pair.second, connection.value());
+			worker_checksum.AddEdge(
+					student1.id(), student2.id(), connection.value());
+			++num_edges;
+			++total_edges;
+		}
+		progress.Update(worker, ++total_pairs, total_edges);
+
+		// counted locally so workers don't contend on the counters
+		if (++num_pairs == counter_flush_interval) {
+			AddToCounter("pairs_evaluated", num_pairs);
+			AddToCounter("edges_emitted", num_edges);
+			AddToCounter("edges_filtered", num_filtered);
+			num_pairs = num_edges = num_filtered = 0;
+		}
+	}
+
+	AddToCounter("pairs_evaluated", num_pairs);
+	AddToCounter("edges_emitted", num_edges);
+	AddToCounter("edges_filtered", num_filtered);
+	checksum = worker_checksum;
+}
+
+
+NetworkShard BuildStudentNetworkShard(const StudentContainer& students,
+		weighting_func_ptr weighting_func, int shard, int num_shards,
+		const string& label, BuildCheckpoint* checkpoint,
+		const EdgeFilter& filter) {
+	TRACE_SCOPE("build_student_network_shard");
+	long num_students{static_cast<long>(students.size())};
+	NetworkShard network_shard{label, shard, num_shards, num_students,
+		GetStudentsFingerprint(students),
+		GetShardRows(num_students, shard, num_shards), {}};
+	const auto& rows = network_shard.rows;
+	assert(!checkpoint || checkpoint->rows() == rows);
+
+	// the edges of every row are kept apart, so the shard lists its edges in
+	// the same order whatever the threads did
+	vector<vector<ShardEdge>> row_edges(rows.last_row - rows.first_row);
+	auto student_it = begin(students);
+	CalculateRowsEdges(students, weighting_func, rows, checkpoint, filter,
+			[&](int, long row, const RowEdges& edges) {
+				for (const auto& edge : edges) {
+					row_edges[row - rows.first_row].push_back({
+							student_it[row].id(),
+							student_it[edge.column].id(), edge.weight});
+				}
+			});
+
+	for (auto& edges : row_edges) {
+		network_shard.edges.insert(
+				end(network_shard.edges), begin(edges), end(edges));
+	}
+	SetLabel("edge_checksum", network_shard.GetChecksum().ToString());
+	return network_shard;
+}
+
+
+void SpillStudentNetworkEdges(const StudentContainer& students,
+		weighting_func_ptr weighting_func, long buffer_kb, EdgeRuns& runs,
+		BuildCheckpoint* checkpoint, const EdgeFilter& filter) {
+	TRACE_SCOPE("spill_student_network");
+	ShardRows rows{0, static_cast<long>(students.size())};
+	assert(!checkpoint || checkpoint->rows() == rows);
+
+	// the buffer is split evenly between the workers
+	auto capacity = buffer_kb * 1024 / sizeof(SpilledEdge) / num_threads;
+	vector<unique_ptr<EdgeSpiller>> spillers;
+	for (int i{0}; i < num_threads; ++i)
+	{ spillers.emplace_back(new EdgeSpiller{runs, capacity}); }
+
+	vector<EdgeChecksum> checksums(num_threads);
+	auto student_it = begin(students);
+	CalculateRowsEdges(students, weighting_func, rows, checkpoint, filter,
+			[&](int worker, long row, const RowEdges& edges) {
+				for (const auto& edge : edges) {
+					spillers[worker]->Add(edge.column, row, edge.weight);
+					checksums[worker].AddEdge(student_it[row].id(),
+							student_it[edge.column].id(), edge.weight);
+				}
+			});
+	for (auto& spiller : spillers) { spiller->Flush(); }
+
+	EdgeChecksum checksum;
+	for (const auto& worker_checksum : checksums)
+	{ checksum.Combine(worker_checksum); }
+	SetLabel("edge_checksum", checksum.ToString());
+}
+
+
+// Calculates the edges of every row with a pool of workers, each claiming a
+// row at a time. finish_row(worker, row, edges) is called with the edges of
+// every row, rows resumed from the checkpoint first as if worker 0 found them.
+// Given an index, only the candidates it finds are weighted. Rethrows the
+// first exception of any worker once they've all stopped.
+void CalculateRowsEdges(const StudentContainer& students,
+						weighting_func_ptr weighting_func, ShardRows rows,
+						BuildCheckpoint* checkpoint, const EdgeFilter& filter,
+						const finish_row_func& finish_row,
+						const MinHashIndex* index) {
+	long num_students{static_cast<long>(students.size())};
+	if (filter.top_k > 0) {
+		// a student's top neighbors are only known once every row is, so the
+		// workers offer the rows to their own top neighbors and only the edges
+		// kept in the end are finished, as if worker 0 found them
+		assert(rows.first_row == 0 && rows.last_row == num_students);
+		vector<TopNeighbors> top_neighbors(
+				num_threads, TopNeighbors{num_students, filter.top_k});
+		auto row_filter = filter;
+		row_filter.top_k = 0;
+		CalculateRowsEdges(students, weighting_func, rows, checkpoint,
+				row_filter, [&](int worker, long row, const RowEdges& edges) {
+					for (const auto& edge : edges) {
+						top_neighbors[worker].Offer(
+								row, edge.column, edge.weight);
+					}
+				}, index);
+
+		TRACE_SCOPE("keep_top_neighbors");
+		for (int i{1}; i < num_threads; ++i)
+		{ top_neighbors[0].Merge(top_neighbors[i]); }
+		auto kept_rows = top_neighbors[0].GetRows();
+		long num_kept{0};
+		for (long row{0}; row < num_students; ++row) {
+			finish_row(0, row, kept_rows[row]);
+			num_kept += kept_rows[row].size();
+		}
+		AddToCounter("edges_kept_top_k", num_kept);
+		return;
+	}
+
+	if (checkpoint) {
+		for (const auto& resumed_row : checkpoint->Resume())
+		{ finish_row(0, resumed_row.first, resumed_row.second); }
+	}
+
+	// row i pairs student i with every later student, the candidates of a row
+	// aren't known ahead so with an index the rows are counted
+	long total_work{0};
+	for (auto row = rows.first_row; row < rows.last_row; ++row) {
+		if (!checkpoint || !checkpoint->IsRowResumed(row))
+		{ total_work += index ? 1 : num_students - 1 - row; }
+	}
+	ProgressCounters progress{num_threads};
+	ProgressReporter progress_reporter{progress, total_work,
+		index ? "rows" : "pairs", progress_period, cerr};
+
+	// the workers of a node are pinned to it before they allocate anything
+	auto num_nodes = GetNumNumaNodes();
+	NodeRows node_rows{num_students, rows, num_nodes};
+	vector<std::exception_ptr> errors(num_threads);
+	vector<thread> thread_pool;
+	for (int i{0}; i < num_threads; ++i) {
+		thread_pool.emplace_back([&, i] {
+			auto node = GetWorkerNode(i, num_threads, num_nodes);
+			if (num_nodes > 1) { RunOnNumaNode(node); }
+			try {
+				CalculateRowEdges(students, weighting_func, rows, node_rows,
+						node, checkpoint, filter, index, progress, i,
+						finish_row);
+			} catch (...) { errors[i] = std::current_exception(); }
+		});
+	}
+	for_each(begin(thread_pool), end(thread_pool), bind(&thread::join, _1));
+	progress_reporter.Stop();
+
+	for (const auto& error : errors)
+	{ if (error) { std::rethrow_exception(error); } }
+	if (checkpoint) { checkpoint->Save(); }
+}
+
+
+void CalculateRowEdges(const StudentContainer& students,
+					   weighting_func_ptr weighting_func, ShardRows rows,
+					   NodeRows& node_rows, int node,
+					   BuildCheckpoint* checkpoint, const EdgeFilter& filter,
+					   const MinHashIndex* index, ProgressCounters& progress,
+					   int worker, const finish_row_func& finish_row) {
+	long num_students{static_cast<long>(students.size())};
+	long num_pairs{0}, num_edges{0}, num_filtered{0}, num_skipped{0},
+		 total_work{0}, total_edges{0}, num_local_rows{0}, num_remote_rows{0};
+	auto student_it = begin(students);
+	RowEdges edges;
+	vector<long> candidates;
+	bool local{true};
+	for (auto row = node_rows.Claim(node, local); row < rows.last_row;
+			row = node_rows.Claim(node, local)) {
+		if (checkpoint && checkpoint->IsRowResumed(row)) { continue; }
+		++(local ? num_local_rows : num_remote_rows);
+
+		const Student& student1(student_it[row]);
+		edges.clear();
+		auto num_columns = num_students - 1 - row;
+		if (index) {
+			num_skipped += index->GetCandidates(row, candidates);
+			num_columns = candidates.size();
+		}
+		for (long i{0}; i < num_columns; ++i) {
+			TRACE_SCOPE("evaluate_pair");
+			auto column = index ? candidates[i] : row + 1 + i;
+			const Student& student2(student_it[column]);
+			auto connection = filter.KeepPair(student1, student2) ?
+				weighting_func(student1, student2) : boost::none;
+			if (connection && !filter.KeepWeight(connection.value())) {
+				++num_filtered;
+			} else if (connection) {
+				edges.push_back({column, connection.value()});
+				++num_edges;
+				++total_edges;
+			}
+			if (!index) { progress.Update(worker, ++total_work, total_edges); }
+
+			if (++num_pairs == counter_flush_interval) {
+				AddToCounter("pairs_evaluated", num_pairs);
+				AddToCounter("edges_emitted", num_edges);
+				AddToCounter("edges_filtered", num_filtered);
+				num_pairs = num_edges = num_filtered = 0;
+			}
+		}
+
+		if (index) { progress.Update(worker, ++total_work, total_edges); }
+
+		finish_row(worker, row, edges);
+		if (checkpoint) { checkpoint->FinishRow(row, edges); }
+	}
+
+	AddToCounter("pairs_evaluated", num_pairs);
+	AddToCounter("edges_emitted", num_edges);
+	AddToCounter("edges_filtered", num_filtered);
+	if (index) { AddToCounter("candidates_skipped", num_skipped); }
+	if (GetNumNumaNodes() > 1) {
+		AddToCounter("numa_rows_local", num_local_rows);
+		AddToCounter("numa_rows_remote", num_remote_rows);
+	}
+}
+
+
+TemporalNetwork BuildTemporalStudentNetwork(const StudentContainer& students,
+		weighting_func_ptr weighting_func, int window_terms) {
+	TRACE_SCOPE("build_temporal_student_network");
+	set<int> term_set;
+	for (const auto& student : students) {
+		for (const auto& course : student.courses_taken())
+		{ term_set.insert(course->term()); }
+	}
+	vector<int> terms(begin(term_set), end(term_set));
+	auto windows = GetTermWindows(terms.size(), window_terms);
+
+	TemporalNetwork temporal_network;
+	for (const auto& student : students)
+	{ temporal_network.students.push_back(student.id()); }
+	for (const auto& window : windows) {
+		temporal_network.snapshots.push_back(
+				{terms[window.first], terms[window.second - 1], {}});
+	}
+
+	// every student is split into one taking their courses of each window
+	// they took courses in, ordered by window
+	auto window_size = windows.empty() ? 0 :
+		windows.front().second - windows.front().first;
+	vector<vector<pair<std::size_t, Student>>> window_students;
+	for (const auto& student : students) {
+		map<std::size_t, Student> student_windows;
+		for (const auto& course : student.courses_taken()) {
+			std::size_t term = std::lower_bound(begin(terms), end(terms),
+					course->term()) - begin(terms);
+			// a term is in the last window_size windows up to its own
+			auto first_window = term + 1 > window_size ?
+				term + 1 - window_size : 0;
+			auto last_window = std::min(term + 1, windows.size());
+			for (auto window = first_window; window < last_window; ++window) {
+				auto window_it = student_windows.find(window);
+				if (window_it == end(student_windows)) {
+					window_it = student_windows.emplace(window, student).first;
+					window_it->second.ClearCoursesTaken();
+				}
+				window_it->second.AddCourseTaken(course);
+			}
 		}
+		window_students.emplace_back(
+				begin(student_windows), end(student_windows));
 	}
+
+	// the workers claim rows, and the windows' edges of a row are kept with
+	// it, so snapshots are ordered by row and column whatever the threads did
+	long num_students{static_cast<long>(students.size())};
+	vector<vector<pair<std::size_t, RowEdge>>> row_edges(num_students);
+	ProgressCounters progress{num_threads};
+	ProgressReporter progress_reporter{progress,
+		num_students * (num_students - 1) / 2, "pairs", progress_period, cerr};
+	std::atomic<long> next_row{0};
+	vector<thread> thread_pool;
+	for (int i{0}; i < num_threads; ++i) {
+		thread_pool.emplace_back([&, i] {
+			long num_pairs{0}, num_edges{0}, total_pairs{0}, total_edges{0};
+			for (auto row = next_row++; row < num_students; row = next_row++) {
+				const auto& row_windows = window_students[row];
+				for (auto column = row + 1; column < num_students; ++column) {
+					TRACE_SCOPE("evaluate_pair");
+					// only the windows both students took courses in are
+					// weighted
+					const auto& column_windows = window_students[column];
+					auto row_it = begin(row_windows);
+					auto column_it = begin(column_windows);
+					while (row_it != end(row_windows) &&
+							column_it != end(column_windows)) {
+						if (row_it->first < column_it->first) {
+							++row_it;
+						} else if (column_it->first < row_it->first) {
+							++column_it;
+						} else {
+							auto connection = weighting_func(
+									row_it->second, column_it->second);
+							if (connection) {
+								row_edges[row].push_back({row_it->first,
+										{column, connection.value()}});
+								++num_edges;
+								++total_edges;
+							}
+							++row_it;
+							++column_it;
+						}
+					}
+					progress.Update(i, ++total_pairs, total_edges);
+
+					if (++num_pairs == counter_flush_interval) {
+						AddToCounter("pairs_evaluated", num_pairs);
+						AddToCounter("edges_emitted", num_edges);
+						num_pairs = num_edges = 0;
+					}
+				}
+			}
+			AddToCounter("pairs_evaluated", num_pairs);
+			AddToCounter("edges_emitted", num_edges);
+		});
+	}
+	for_each(begin(thread_pool), end(thread_pool), bind(&thread::join, _1));
+	progress_reporter.Stop();
+
+	TRACE_SCOPE("gather_snapshots");
+	for (long row{0}; row < num_students; ++row) {
+		for (const auto& edge : row_edges[row]) {
+			temporal_network.snapshots[edge.first].edges.push_back(
+					{row, edge.second.column, edge.second.weight});
+		}
+		row_edges[row] = {};
+	}
+
+	// the checksums of the snapshots summed, to compare temporal builds
+	EdgeChecksum checksum;
+	for (const auto& snapshot : temporal_network.snapshots)
+	{ checksum.Combine(temporal_network.GetChecksum(snapshot)); }
+	SetLabel("edge_checksum", checksum.ToString());
+	return temporal_network;
+}
+
+
+long EstimateStudentNetworkMemory(std::size_t num_students) {
+	// undirected adjacency matrices store the lower triangle
+	auto matrix_entries = num_students * (num_students + 1) / 2;
+	auto matrix_bytes =
+		matrix_entries * sizeof(StudentNetwork::graph_t::StoredEdge);
+	auto vertex_bytes = num_students * sizeof(Student::Id);
+	return (matrix_bytes + vertex_bytes) / 1024 + 1;
 }
 
 
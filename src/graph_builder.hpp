@@ -1,15 +1,29 @@
 #ifndef GRAPH_BUILDER_H
 #define GRAPH_BUILDER_H
 
+#include <cstddef>
 #include <iosfwd>
+#include <string>
 
 #include <boost/optional.hpp>
 
+#include "edge_filter.hpp"
 
+
+class BuildCheckpoint;
 class CourseNetwork;
+class EdgeRuns;
+struct MinHashOptions;
+struct NetworkShard;
 class Student;
 class StudentContainer;
 class StudentNetwork;
+struct TemporalNetwork;
+
+
+// If positive, builders write their progress to stderr every this many
+// seconds.
+extern int progress_period;
 
 
 // Builds a graph for the network from the given course tab.
@@ -20,10 +34,65 @@ StudentNetwork BuildStudentNetworkFromEnrollment(
 		std::istream& enrollment_stream);
 
 
+// Builds the network of every pair of students. Given a checkpoint of rows
+// 0 to the number of students (see build_checkpoint.hpp), rows it finished
+// are resumed and rows finished here are saved to it. Edges that don't pass
+// the filter (see edge_filter.hpp) are dropped, checkpoints hold the edges
+// before the top k are picked.
 StudentNetwork BuildStudentNetworkFromStudents(
 		const StudentContainer& students,
 		boost::optional<double>(*weighting_func)(
-			const Student&, const Student&));
+			const Student&, const Student&),
+		BuildCheckpoint* checkpoint = nullptr,
+		const EdgeFilter& filter = EdgeFilter{});
+
+// Builds an approximation of the student network, only weighting the pairs
+// of students found similar by MinHash (see minhash.hpp). The edges found
+// have their exact weights, some edges are missed.
+StudentNetwork BuildApproximateStudentNetwork(
+		const StudentContainer& students,
+		boost::optional<double>(*weighting_func)(
+			const Student&, const Student&),
+		const MinHashOptions& options,
+		const EdgeFilter& filter = EdgeFilter{});
+
+// Builds one shard of the student network (see network_shard.hpp). Only the
+// edges in the shard's rows are kept, the network itself isn't allocated. A
+// checkpoint must be of the shard's rows. A shard doesn't see every edge of
+// its students, so the filter can't pick the top k. The label tells builds
+// apart when merging, e.g. by weighting function and filter.
+NetworkShard BuildStudentNetworkShard(
+		const StudentContainer& students,
+		boost::optional<double>(*weighting_func)(
+			const Student&, const Student&),
+		int shard, int num_shards, const std::string& label,
+		BuildCheckpoint* checkpoint = nullptr,
+		const EdgeFilter& filter = EdgeFilter{});
+
+// Finds the edges of the student network without allocating it, spilling
+// them to the runs (see edge_spill.hpp) whenever buffer_kb of them are held.
+// Save the network with SaveSpilledNetwork.
+void SpillStudentNetworkEdges(
+		const StudentContainer& students,
+		boost::optional<double>(*weighting_func)(
+			const Student&, const Student&),
+		long buffer_kb, EdgeRuns& runs, BuildCheckpoint* checkpoint = nullptr,
+		const EdgeFilter& filter = EdgeFilter{});
+
+// Builds the student network of every window of window_terms consecutive
+// terms (see temporal_network.hpp) in a single pass over the pairs of
+// students. A pair is weighted once for every window both students took
+// courses in, as if they'd only taken the window's courses, so a snapshot is
+// exactly the network of its courses.
+TemporalNetwork BuildTemporalStudentNetwork(
+		const StudentContainer& students,
+		boost::optional<double>(*weighting_func)(
+			const Student&, const Student&),
+		int window_terms);
+
+// Estimates the memory in KB taken by a student network of the given size.
+// The adjacency matrix dominates, growing with the square of the students.
+long EstimateStudentNetworkMemory(std::size_t num_students);
 
 #endif  // GRAPH_BUILDER_H
 
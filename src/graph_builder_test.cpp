@@ -1,20 +1,41 @@
 #include "graph_builder.hpp"
 
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
+#include "build_checkpoint.hpp"
 #include "course.hpp"
+#include "edge_checksum.hpp"
+#include "edge_filter.hpp"
+#include "edge_spill.hpp"
+#include "metrics.hpp"
+#include "minhash.hpp"
+#include "network_shard.hpp"
+#include "setting_guard.hpp"
 #include "student.hpp"
 #include "student_container_mock.hpp"
 #include "student_network.hpp"
+#include "temporal_network.hpp"
 #include "test_data_streams.hpp"
+#include "utility.hpp"
+#include "weighting_function.hpp"
 
 
+using std::string;
 using std::stringstream;
+using std::vector;
 
 using ::testing::AtLeast;
 using ::testing::Const;
+using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::ReturnRef;
 
@@ -110,6 +131,254 @@ TEST(GraphBuilderTest, BuildStudentNetworkFromStudents) {
 }
 
 
+// The students of BuildStudentNetworkFromStudents, for the other ways to build
+// their network that should give the same edges.
+class StudentNetworkBuildTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		student1.AddCoursesTaken({&course5, &course2, &course1});
+		student2.AddCoursesTaken({&course1, &course3, &course4, &course2});
+		student3.AddCoursesTaken({&course1, &course5, &course6});
+		student4.AddCoursesTaken({&course1, &course3});
+		student5.AddCourseTaken(&course6);
+		students.Insert({student1, student2, student3, student4, student5});
+		ON_CALL(students, size()).WillByDefault(Return(5));
+		ON_CALL(Const(students), Find(147195))
+			.WillByDefault(ReturnRef(student1));
+		ON_CALL(Const(students), Find(312995))
+			.WillByDefault(ReturnRef(student2));
+		ON_CALL(Const(students), Find(352468))
+			.WillByDefault(ReturnRef(student3));
+		ON_CALL(Const(students), Find(500928))
+			.WillByDefault(ReturnRef(student4));
+		ON_CALL(Const(students), Find(567890))
+			.WillByDefault(ReturnRef(student5));
+
+		for (const auto& student : {student1, student2, student3, student4})
+		{ course1.AddStudentEnrolled(student.id()); }
+		for (const auto& student : {student1, student2})
+		{ course2.AddStudentEnrolled(student.id()); }
+		for (const auto& student : {student2, student4})
+		{ course3.AddStudentEnrolled(student.id()); }
+		course4.AddStudentEnrolled(student2.id());
+		for (const auto& student : {student1, student3})
+		{ course5.AddStudentEnrolled(student.id()); }
+		for (const auto& student : {student3, student5})
+		{ course6.AddStudentEnrolled(student.id()); }
+
+		network = BuildStudentNetworkFromStudents(students, TestWeightingFunc);
+		checksum = ComputeEdgeChecksum(network);
+	}
+
+ protected:
+	Course course1{"ENGLISH", 125, 0, 4}, course2{"AAPTIS", 277, 0, 4},
+		   course3{"CHEM", 210, 0, 4}, course4{"CHEM", 211, 0, 1},
+		   course5{"ENVIRON", 311, 0, 4}, course6{"MATH", 425, 0, 3};
+	Student student1{147195}, student2{312995}, student3{352468},
+			student4{500928}, student5{567890};
+	NiceMock<MockStudentContainer> students;
+	StudentNetwork network;
+	EdgeChecksum checksum;
+};
+
+
+TEST_F(StudentNetworkBuildTest, Checksum) {
+	// the checksum of the edges doesn't depend on the number of threads
+	EXPECT_EQ(6, checksum.num_edges());
+	EXPECT_EQ(checksum.ToString(), GetLabel("edge_checksum"));
+
+	SettingGuard<int> threads_guard{num_threads, 3};
+	StudentNetwork threaded_network{
+		BuildStudentNetworkFromStudents(students, TestWeightingFunc)};
+	EXPECT_EQ(checksum, ComputeEdgeChecksum(threaded_network));
+	EXPECT_EQ(checksum.ToString(), GetLabel("edge_checksum"));
+}
+
+
+TEST_F(StudentNetworkBuildTest, ShardsMerge) {
+	// merged shards give the same network however many there are
+	for (int num_shards{1}; num_shards <= 6; ++num_shards) {
+		vector<NetworkShard> shards;
+		for (int shard{0}; shard < num_shards; ++shard) {
+			shards.push_back(BuildStudentNetworkShard(students,
+					TestWeightingFunc, shard, num_shards, "test"));
+		}
+		auto merged_network = MergeShards(students, shards);
+		EXPECT_EQ(checksum, ComputeEdgeChecksum(merged_network));
+		EXPECT_DOUBLE_EQ(3.0, merged_network.Get(
+					merged_network.GetVertexDescriptor(Student::Id{352468}),
+					merged_network.GetVertexDescriptor(Student::Id{500928})));
+	}
+}
+
+
+TEST_F(StudentNetworkBuildTest, OutOfCore) {
+	// an out of core build saves the same archive
+	stringstream saved;
+	network.Save(saved);
+	EdgeRuns runs{"/tmp"};
+	SpillStudentNetworkEdges(students, TestWeightingFunc, 1, runs);
+	EXPECT_EQ(checksum.ToString(), GetLabel("edge_checksum"));
+	stringstream spilled;
+	SaveSpilledNetwork(students, runs, spilled);
+	EXPECT_EQ(saved.str(), spilled.str());
+}
+
+
+TEST_F(StudentNetworkBuildTest, CheckpointResume) {
+	// a build resumed from the checkpoints of a killed one finishes the same,
+	// here a checkpoint is saved for every row and the last two are lost
+	char checkpoint_dir[] = "/tmp/checkpoint_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(checkpoint_dir));
+	auto rows = GetShardRows(students.size(), 0, 1);
+	{
+		BuildCheckpoint checkpoint{checkpoint_dir, "test", students, rows, 0};
+		StudentNetwork checkpointed_network{BuildStudentNetworkFromStudents(
+				students, TestWeightingFunc, &checkpoint)};
+		EXPECT_EQ(checksum, ComputeEdgeChecksum(checkpointed_network));
+	}
+	for (auto lost : {"/checkpoint_3.txt", "/checkpoint_4.txt"})
+	{ EXPECT_EQ(0, std::remove((string{checkpoint_dir} + lost).c_str())); }
+	BuildCheckpoint checkpoint{checkpoint_dir, "test", students, rows, 0};
+	StudentNetwork resumed_network{BuildStudentNetworkFromStudents(
+			students, TestWeightingFunc, &checkpoint)};
+	EXPECT_TRUE(checkpoint.IsRowResumed(2));
+	EXPECT_FALSE(checkpoint.IsRowResumed(3));
+	EXPECT_EQ(checksum, ComputeEdgeChecksum(resumed_network));
+	EXPECT_EQ(checksum.ToString(), GetLabel("edge_checksum"));
+	checkpoint.Clear();
+	EXPECT_EQ(0, rmdir(checkpoint_dir));
+}
+
+
+TEST_F(StudentNetworkBuildTest, Filters) {
+	// filtered builds drop edges as they're found
+	EdgeFilter shared_courses_filter;
+	shared_courses_filter.min_shared_courses = 2;
+	StudentNetwork shared_courses_network{BuildStudentNetworkFromStudents(
+			students, TestWeightingFunc, nullptr, shared_courses_filter)};
+	EXPECT_EQ(3u, shared_courses_network.GetEdgeDescriptors().size());
+	EXPECT_DOUBLE_EQ(3.0, shared_courses_network.Get(
+				shared_courses_network.GetVertexDescriptor(Student::Id{147195}),
+				shared_courses_network.GetVertexDescriptor(
+					Student::Id{312995})));
+	EXPECT_DOUBLE_EQ(2.0, shared_courses_network.Get(
+				shared_courses_network.GetVertexDescriptor(Student::Id{312995}),
+				shared_courses_network.GetVertexDescriptor(
+					Student::Id{500928})));
+
+	EdgeFilter weight_filter;
+	weight_filter.min_weight = 2.5;
+	StudentNetwork weight_network{BuildStudentNetworkFromStudents(
+			students, TestWeightingFunc, nullptr, weight_filter)};
+	EXPECT_EQ(3, ComputeEdgeChecksum(weight_network).num_edges());
+}
+
+
+TEST_F(StudentNetworkBuildTest, TopK) {
+	// the heaviest edge of every student happens to weigh 3 here, with ties
+	// going to the neighbor first in order, so the top edges are those of at
+	// least 2.5
+	EdgeFilter weight_filter;
+	weight_filter.min_weight = 2.5;
+	auto weight_checksum = ComputeEdgeChecksum(BuildStudentNetworkFromStudents(
+				students, TestWeightingFunc, nullptr, weight_filter));
+
+	EdgeFilter top_filter;
+	top_filter.top_k = 1;
+	for (int threads : {1, 3}) {
+		SettingGuard<int> threads_guard{num_threads, threads};
+		StudentNetwork top_network{BuildStudentNetworkFromStudents(
+				students, TestWeightingFunc, nullptr, top_filter)};
+		EXPECT_EQ(weight_checksum, ComputeEdgeChecksum(top_network));
+
+		EdgeRuns top_runs{"/tmp"};
+		SpillStudentNetworkEdges(
+				students, TestWeightingFunc, 1, top_runs, nullptr, top_filter);
+		EXPECT_EQ(weight_checksum.ToString(), GetLabel("edge_checksum"));
+		stringstream top_saved, top_spilled;
+		top_network.Save(top_saved);
+		SaveSpilledNetwork(students, top_runs, top_spilled);
+		EXPECT_EQ(top_saved.str(), top_spilled.str());
+	}
+}
+
+
+TEST_F(StudentNetworkBuildTest, Approximate) {
+	// the least similar students here share a course of four, which many
+	// bands of a row find with all but a 1e-6 chance
+	MinHashOptions minhash_options;
+	minhash_options.num_bands = 50;
+	minhash_options.band_rows = 1;
+	StudentNetwork approximate_network{BuildApproximateStudentNetwork(
+			students, TestWeightingFunc, minhash_options)};
+	EXPECT_EQ(checksum, ComputeEdgeChecksum(approximate_network));
+	EXPECT_EQ(checksum.ToString(), GetLabel("edge_checksum"));
+
+	// no two students took the same courses
+	minhash_options.min_similarity = 1.;
+	StudentNetwork identical_network{BuildApproximateStudentNetwork(
+			students, TestWeightingFunc, minhash_options)};
+	EXPECT_EQ(0u, identical_network.GetEdgeDescriptors().size());
+}
+
+
+TEST(GraphBuilderTest, BuildTemporalStudentNetwork) {
+	// the students share a course in every term
+	Course course1{"ENGLISH", 125, 201403, 4}, course2{"CHEM", 210, 201405, 4},
+		   course3{"MATH", 425, 201407, 3};
+	Student student1{1}, student2{2}, student3{3};
+	student1.AddCoursesTaken({&course1, &course2});
+	student2.AddCoursesTaken({&course1, &course2, &course3});
+	student3.AddCoursesTaken({&course1, &course3});
+	for (auto id : {1, 2, 3}) { course1.AddStudentEnrolled(id); }
+	for (auto id : {1, 2}) { course2.AddStudentEnrolled(id); }
+	for (auto id : {2, 3}) { course3.AddStudentEnrolled(id); }
+	NiceMock<MockStudentContainer> students;
+	students.Insert({student1, student2, student3});
+	ON_CALL(students, size()).WillByDefault(Return(3));
+	ON_CALL(Const(students), Find(1)).WillByDefault(ReturnRef(student1));
+	ON_CALL(Const(students), Find(2)).WillByDefault(ReturnRef(student2));
+	ON_CALL(Const(students), Find(3)).WillByDefault(ReturnRef(student3));
+
+	auto by_term = BuildTemporalStudentNetwork(students, InverseEnrollment, 1);
+	EXPECT_EQ((vector<Student::Id>{1, 2, 3}), by_term.students);
+	ASSERT_EQ(3u, by_term.snapshots.size());
+	EXPECT_EQ(201403, by_term.snapshots[0].first_term);
+	EXPECT_EQ(201403, by_term.snapshots[0].last_term);
+	ASSERT_EQ(3u, by_term.snapshots[0].edges.size());
+	EXPECT_DOUBLE_EQ(1. / 3., by_term.snapshots[0].edges[2].weight);
+	ASSERT_EQ(1u, by_term.snapshots[1].edges.size());
+	EXPECT_EQ(0, by_term.snapshots[1].edges[0].row);
+	EXPECT_EQ(1, by_term.snapshots[1].edges[0].column);
+	EXPECT_DOUBLE_EQ(0.5, by_term.snapshots[1].edges[0].weight);
+	ASSERT_EQ(1u, by_term.snapshots[2].edges.size());
+	EXPECT_EQ(1, by_term.snapshots[2].edges[0].row);
+	EXPECT_EQ(2, by_term.snapshots[2].edges[0].column);
+
+	auto sliding = BuildTemporalStudentNetwork(students, InverseEnrollment, 2);
+	ASSERT_EQ(2u, sliding.snapshots.size());
+	EXPECT_EQ(201403, sliding.snapshots[0].first_term);
+	EXPECT_EQ(201405, sliding.snapshots[0].last_term);
+	ASSERT_EQ(3u, sliding.snapshots[0].edges.size());
+	EXPECT_DOUBLE_EQ(5. / 6., sliding.snapshots[0].edges[0].weight);
+	EXPECT_EQ(201405, sliding.snapshots[1].first_term);
+	EXPECT_EQ(2u, sliding.snapshots[1].edges.size());
+
+	// a window of every term is the whole network, with any threads
+	auto network = BuildStudentNetworkFromStudents(students, InverseEnrollment);
+	auto checksum = ComputeEdgeChecksum(network);
+	for (int threads : {1, 2, 3}) {
+		SettingGuard<int> threads_guard{num_threads, threads};
+		auto whole = BuildTemporalStudentNetwork(
+				students, InverseEnrollment, 10);
+		ASSERT_EQ(1u, whole.snapshots.size());
+		EXPECT_EQ(201407, whole.snapshots[0].last_term);
+		EXPECT_EQ(checksum, whole.GetChecksum(whole.snapshots[0]));
+	}
+}
+
+
 optional<double> TestWeightingFunc(const Student& student1,
 								   const Student& student2) {
 	if ((student1 == Student{147195} && student2 == Student{147195}) ||
@@ -1,34 +1,111 @@
 #include "mem_usage.hpp"
 
-#include <cstdlib>
-#include <cstdio>
-#include <cstring>
+#include <cctype>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
-int ParseLine(char* line);
 
+using std::function;
+using std::ifstream; using std::istringstream;
+using std::invalid_argument;
+using std::map;
+using std::string;
+namespace chr = std::chrono;
 
-int GetMemoryUsage() {
-	FILE* file = fopen("/proc/self/status", "r");
-	int result = -1;
-	char line[128];
 
+// Sleep in steps no longer than this so the sampler stops promptly.
+const chr::milliseconds max_sampler_sleep{50};
 
-	while (fgets(line, 128, file) != NULL) {
-		if (strncmp(line, "VmSize:", 7) == 0) {
-			result = ParseLine(line);
-			break;
-		}
+
+MemoryUsage ReadMemoryUsage() {
+	MemoryUsage usage{-1, -1, -1};
+	ifstream status{"/proc/self/status"};
+
+	// lines look like "VmRSS:\t  123456 kB"
+	string line;
+	while (getline(status, line)) {
+		auto separator = line.find(':');
+		if (separator == string::npos) { continue; }
+
+		auto field = line.substr(0, separator);
+		long* value{nullptr};
+		if (field == "VmRSS") { value = &usage.resident_kb; }
+		else if (field == "VmHWM") { value = &usage.peak_resident_kb; }
+		else if (field == "VmSize") { value = &usage.virtual_kb; }
+		else { continue; }
+
+		istringstream value_stream{line.substr(separator + 1)};
+		long kb;
+		string unit;
+		if (value_stream >> kb >> unit && unit == "kB") { *value = kb; }
 	}
-	fclose(file);
-	return result;
+
+	return usage;
+}
+
+
+int GetMemoryUsage() { return ReadMemoryUsage().resident_kb; }
+
+
+long ParseMemorySize(const string& size) {
+	const map<string, double> kb_per_unit{
+		{"", 1024.}, {"k", 1.}, {"kb", 1.}, {"m", 1024.}, {"mb", 1024.},
+		{"g", 1024. * 1024.}, {"gb", 1024. * 1024.},
+		{"t", 1024. * 1024. * 1024.}, {"tb", 1024. * 1024. * 1024.},
+	};
+
+	istringstream size_stream{size};
+	double amount;
+	string unit;
+	if (!(size_stream >> amount) || amount <= 0.)
+	{ throw invalid_argument{"Invalid memory size \"" + size + "\""}; }
+	size_stream >> unit;
+	std::transform(begin(unit), end(unit), begin(unit),
+			[](char c) { return std::tolower(c); });
+
+	auto unit_it = kb_per_unit.find(unit);
+	if (unit_it == kb_per_unit.end() || !size_stream.eof()) {
+		throw invalid_argument{"Invalid memory unit in \"" + size + "\""};
+	}
+	return static_cast<long>(amount * unit_it->second);
+}
+
+
+MemorySampler::MemorySampler(chr::milliseconds interval, long budget_kb,
+							 function<void(long)> over_budget) :
+		stop_{false} {
+	if (budget_kb <= 0) { return; }
+	sampler_thread_ = std::thread{
+		[this, interval, budget_kb, over_budget]() {
+			bool reported{false};
+			auto next_sample = chr::steady_clock::now();
+			while (!stop_) {
+				if (chr::steady_clock::now() < next_sample) {
+					std::this_thread::sleep_for(std::min(
+								max_sampler_sleep, interval));
+					continue;
+				}
+				next_sample += interval;
+
+				auto resident_kb = ReadMemoryUsage().resident_kb;
+				if (resident_kb > budget_kb && !reported) {
+					reported = true;
+					over_budget(resident_kb);
+				}
+			}
+		}};
 }
 
 
-int ParseLine(char* line) {
-	int i = strlen(line);
-	while (*line < '0' || *line > '9') line++;
-	line[i-3] = '\0';
-	i = atoi(line);
-	return i;
+MemorySampler::~MemorySampler() {
+	stop_ = true;
+	if (sampler_thread_.joinable()) { sampler_thread_.join(); }
 }
@@ -1,7 +1,49 @@
 #ifndef MEM_USAGE_H
 #define MEM_USAGE_H
 
-// Note: this value is in KB!
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+
+// Memory of this process in KB as reported by /proc/self/status. Fields that
+// can't be read are -1.
+struct MemoryUsage {
+	long resident_kb;  // VmRSS, what the scheduler's mem= limit enforces
+	long peak_resident_kb;  // VmHWM
+	long virtual_kb;  // VmSize
+};
+
+MemoryUsage ReadMemoryUsage();
+
+// Note: this value is in KB! Returns the resident set size.
 int GetMemoryUsage();
 
+// Parses sizes like "35gb", "512MB", "2048kb" or "1.5g" into KB, a number
+// without a unit is in MB. Throws std::invalid_argument.
+long ParseMemorySize(const std::string& size);
+
+
+// Samples resident memory on a background thread every interval, calling
+// over_budget from the sampling thread the first time it exceeds budget_kb.
+// Without a positive budget there's nothing to watch, so no thread is started.
+// The peak is VmHWM, see ReadMemoryUsage.
+class MemorySampler {
+ public:
+	MemorySampler(std::chrono::milliseconds interval, long budget_kb,
+				  std::function<void(long resident_kb)> over_budget);
+	~MemorySampler();
+
+	MemorySampler(const MemorySampler&) = delete;
+	MemorySampler& operator=(const MemorySampler&) = delete;
+
+
+ private:
+	std::atomic<bool> stop_;
+	std::thread sampler_thread_;
+};
+
+
 #endif  // MEM_USAGE_H
@@ -0,0 +1,58 @@
+#include "mem_usage.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+
+using std::invalid_argument;
+namespace chr = std::chrono;
+
+
+TEST(MemUsageTest, ReadMemoryUsage) {
+	auto usage = ReadMemoryUsage();
+	EXPECT_GT(usage.resident_kb, 0);
+	EXPECT_GE(usage.peak_resident_kb, usage.resident_kb);
+	EXPECT_GE(usage.virtual_kb, usage.resident_kb);
+	EXPECT_GT(GetMemoryUsage(), 0);
+}
+
+
+TEST(MemUsageTest, ParseMemorySize) {
+	EXPECT_EQ(35l * 1024 * 1024, ParseMemorySize("35gb"));
+	EXPECT_EQ(512l * 1024, ParseMemorySize("512MB"));
+	EXPECT_EQ(2048l, ParseMemorySize("2048kb"));
+	EXPECT_EQ(1536l * 1024, ParseMemorySize("1.5g"));
+	EXPECT_EQ(100l * 1024, ParseMemorySize("100"));
+
+	for (auto size : {"", "gb", "-1gb", "0", "35 gigabytes", "35gb extra"})
+	{ EXPECT_THROW(ParseMemorySize(size), invalid_argument) << size; }
+}
+
+
+TEST(MemUsageTest, MemorySampler) {
+	std::atomic<long> over_budget_kb{0};
+	{
+		// any process is over a 1 KB budget
+		MemorySampler sampler{chr::milliseconds{1}, 1,
+			[&over_budget_kb](long resident_kb)
+			{ over_budget_kb = resident_kb; }};
+
+		for (int i{0}; i < 200 && over_budget_kb == 0; ++i)
+		{ std::this_thread::sleep_for(chr::milliseconds{5}); }
+	}
+	EXPECT_GT(over_budget_kb, 0);
+
+	// without a budget nothing is sampled
+	over_budget_kb = 0;
+	{
+		MemorySampler sampler{chr::milliseconds{1}, 0,
+			[&over_budget_kb](long resident_kb)
+			{ over_budget_kb = resident_kb; }};
+		std::this_thread::sleep_for(chr::milliseconds{20});
+	}
+	EXPECT_EQ(0, over_budget_kb);
+}
@@ -0,0 +1,113 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "metrics.hpp"
+#include "network_shard.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+
+
+using std::cerr; using std::cout; using std::endl;
+using std::ifstream; using std::ostream;
+using std::string;
+using std::vector;
+
+namespace po = boost::program_options;
+
+
+int main(int argc, char* argv[]) {
+	po::options_description desc{"Merge the shards of a student network:"};
+	string student_archive_path, metrics_path, trace_path;
+	vector<string> shard_paths;
+	int metrics_period;
+	desc.add_options()
+		("help,h", "Show this help message")
+		("student_archive_path",
+		 po::value<string>(&student_archive_path)->required(),
+		 "Set the path at which to find the student archive the shards were "
+		 "built from")
+		("shard_paths",
+		 po::value<vector<string>>(&shard_paths)->required()->multitoken(),
+		 "Paths of every shard written by build --num_shards")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
+
+	po::positional_options_description positional;
+	positional.add("shard_paths", -1);
+
+	po::variables_map vm;
+	try {
+		po::store(po::command_line_parser(argc, argv).options(desc)
+				.positional(positional).run(), vm);
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 0;
+		}
+		po::notify(vm);
+	} catch (po::error& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{"merge", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
+	PhaseTimer load_timer{"load"};
+	ifstream student_archive{student_archive_path};
+	if (!student_archive.is_open()) {
+		cerr << "Could not open student archive \"" << student_archive_path
+			 << "\"!" << endl;
+		return -1;
+	}
+	StudentContainer students{
+		StudentContainer::LoadFromArchive(student_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path));
+
+	vector<NetworkShard> shards;
+	try {
+		for (const auto& shard_path : shard_paths) {
+			ifstream shard_stream{shard_path};
+			if (!shard_stream.is_open()) {
+				cerr << "Could not open shard \"" << shard_path << "\"!"
+					 << endl;
+				return -1;
+			}
+			shards.push_back(NetworkShard::Load(shard_stream));
+			AddToCounter("bytes_read", GetFileSize(shard_path));
+		}
+	} catch (InvalidShard& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+	load_timer.Stop();
+
+	PhaseTimer merge_timer{"merge"};
+	StudentNetwork student_network;
+	try {
+		student_network = MergeShards(students, shards);
+	} catch (InvalidShard& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+	merge_timer.Stop();
+	cerr << "Edge checksum " << GetLabel("edge_checksum") << endl;
+
+	PhaseTimer save_timer{"save"};
+	CountingStreamBuffer counting_buffer{cout.rdbuf()};
+	ostream network_output{&counting_buffer};
+	student_network.Save(network_output);
+	network_output.flush();
+	AddToCounter("bytes_written", counting_buffer.count());
+
+	return 0;
+}
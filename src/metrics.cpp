@@ -0,0 +1,285 @@
+#include "metrics.hpp"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "mem_usage.hpp"
+
+
+using std::clock; using std::clock_t;
+using std::lock_guard; using std::mutex;
+using std::map;
+using std::ofstream; using std::ostream;
+using std::streamsize;
+using std::string;
+using std::vector;
+namespace chr = std::chrono;
+
+
+// How often the reporter thread checks whether it should stop.
+const chr::milliseconds reporter_poll_interval{100};
+
+
+struct Phase {
+	string name;
+	chr::steady_clock::time_point wall_start;
+	clock_t cpu_start;
+	double wall_seconds, cpu_seconds;
+	bool running;
+	AllocationCounts allocations_start, allocations;
+};
+
+
+// Everything recorded by the process, guarded by metrics_mutex.
+static mutex metrics_mutex;
+static vector<Phase> phases;
+static map<string, long> counters;
+static map<string, string> labels;
+static const auto program_wall_start = chr::steady_clock::now();
+static const auto program_cpu_start = clock();
+
+
+static double WallSecondsSince(chr::steady_clock::time_point start) {
+	return chr::duration<double>(chr::steady_clock::now() - start).count();
+}
+
+
+static double CpuSecondsSince(clock_t start)
+{ return static_cast<double>(clock() - start) / CLOCKS_PER_SEC; }
+
+
+static AllocationCounts AllocationsSince(const AllocationCounts& start) {
+	auto counts = GetAllocationCounts();
+	return {counts.allocations - start.allocations,
+		counts.deallocations - start.deallocations,
+		counts.allocated_bytes - start.allocated_bytes};
+}
+
+
+// Writes the counts as JSON members following other members.
+static void WriteAllocationCounts(ostream& output,
+								  const AllocationCounts& counts) {
+	output << ", \"allocations\": " << counts.allocations
+		   << ", \"deallocations\": " << counts.deallocations
+		   << ", \"allocated_bytes\": " << counts.allocated_bytes;
+}
+
+
+PhaseTimer::PhaseTimer(const string& name) : running_{true} {
+	lock_guard<mutex> lg{metrics_mutex};
+	phase_index_ = phases.size();
+	phases.push_back({name, chr::steady_clock::now(), clock(), 0., 0., true,
+			GetAllocationCounts(), {0, 0, 0}});
+}
+
+
+void PhaseTimer::Stop() {
+	if (!running_) { return; }
+	running_ = false;
+
+	lock_guard<mutex> lg{metrics_mutex};
+	auto& phase = phases[phase_index_];
+	phase.wall_seconds = WallSecondsSince(phase.wall_start);
+	phase.cpu_seconds = CpuSecondsSince(phase.cpu_start);
+	phase.allocations = AllocationsSince(phase.allocations_start);
+	phase.running = false;
+}
+
+
+void AddToCounter(const string& name, long value) {
+	lock_guard<mutex> lg{metrics_mutex};
+	counters[name] += value;
+}
+
+
+long GetCounter(const string& name) {
+	lock_guard<mutex> lg{metrics_mutex};
+	auto counter_it = counters.find(name);
+	return counter_it == counters.end() ? 0 : counter_it->second;
+}
+
+
+void SetLabel(const string& name, const string& value) {
+	lock_guard<mutex> lg{metrics_mutex};
+	labels[name] = value;
+}
+
+
+string GetLabel(const string& name) {
+	lock_guard<mutex> lg{metrics_mutex};
+	auto label_it = labels.find(name);
+	return label_it == labels.end() ? "" : label_it->second;
+}
+
+
+long GetFileSize(const string& path) {
+	struct stat file_stat;
+	if (stat(path.c_str(), &file_stat) != 0) { return -1; }
+	return file_stat.st_size;
+}
+
+
+// Writes s as a quoted JSON string.
+static void WriteJsonString(ostream& output, const string& s) {
+	output << '"';
+	for (char c : s) {
+		if (c == '"' || c == '\\') { output << '\\' << c; }
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			output << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+				   << static_cast<int>(c) << std::dec << std::setfill(' ');
+		} else { output << c; }
+	}
+	output << '"';
+}
+
+
+void SaveMetricsReport(const string& program, ostream& output) {
+	// fall back to getrusage if /proc can't be read
+	auto memory_usage = ReadMemoryUsage();
+	if (memory_usage.peak_resident_kb < 0) {
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		memory_usage.peak_resident_kb = usage.ru_maxrss;
+	}
+
+	lock_guard<mutex> lg{metrics_mutex};
+	output << "{\"program\": ";
+	WriteJsonString(output, program);
+	output << ", \"wall_seconds\": " << WallSecondsSince(program_wall_start)
+		   << ", \"cpu_seconds\": " << CpuSecondsSince(program_cpu_start)
+		   << ", \"rss_kb\": " << memory_usage.resident_kb
+		   << ", \"peak_rss_kb\": " << memory_usage.peak_resident_kb;
+	if (AllocationCountingEnabled())
+	{ WriteAllocationCounts(output, GetAllocationCounts()); }
+	output << ",\n \"phases\": [";
+
+	for (std::size_t i{0}; i < phases.size(); ++i) {
+		const auto& phase = phases[i];
+		output << (i == 0 ? "\n  " : ",\n  ") << "{\"name\": ";
+		WriteJsonString(output, phase.name);
+		output << ", \"wall_seconds\": " << (phase.running ?
+				WallSecondsSince(phase.wall_start) : phase.wall_seconds)
+			   << ", \"cpu_seconds\": " << (phase.running ?
+				CpuSecondsSince(phase.cpu_start) : phase.cpu_seconds)
+			   << ", \"running\": " << (phase.running ? "true" : "false");
+		if (AllocationCountingEnabled()) {
+			WriteAllocationCounts(output, phase.running ?
+					AllocationsSince(phase.allocations_start) :
+					phase.allocations);
+		}
+		output << '}';
+	}
+
+	output << "],\n \"labels\": {";
+	for (auto label_it = labels.cbegin(); label_it != labels.cend();
+			++label_it) {
+		output << (label_it == labels.cbegin() ? "\n  " : ",\n  ");
+		WriteJsonString(output, label_it->first);
+		output << ": ";
+		WriteJsonString(output, label_it->second);
+	}
+	output << "},\n \"counters\": {";
+	for (auto counter_it = counters.cbegin(); counter_it != counters.cend();
+			++counter_it) {
+		output << (counter_it == counters.cbegin() ? "\n  " : ",\n  ");
+		WriteJsonString(output, counter_it->first);
+		output << ": " << counter_it->second;
+	}
+	output << "}}\n";
+}
+
+
+MetricsReporter::MetricsReporter(const string& program, const string& path,
+								 int period_seconds) :
+		program_{program}, path_{path}, stop_{false} {
+	if (path_.empty() || period_seconds <= 0) { return; }
+
+	reporter_thread_ = std::thread{[this, period_seconds]() {
+		auto next_report = chr::steady_clock::now() +
+			chr::seconds{period_seconds};
+		while (!stop_) {
+			std::this_thread::sleep_for(reporter_poll_interval);
+			if (chr::steady_clock::now() < next_report) { continue; }
+			SaveReport();
+			next_report += chr::seconds{period_seconds};
+		}
+	}};
+}
+
+
+MetricsReporter::~MetricsReporter() {
+	stop_ = true;
+	if (reporter_thread_.joinable()) { reporter_thread_.join(); }
+	SaveReport();
+}
+
+
+void MetricsReporter::SaveReport() const {
+	if (path_.empty()) { return; }
+
+	lock_guard<mutex> save_lock_guard{save_mutex_};
+	// write a temporary file and move it into place so readers never see a
+	// partial report
+	auto temporary_path = path_ + ".tmp";
+	{
+		ofstream output{temporary_path};
+		if (!output.is_open()) {
+			std::cerr << "Could not write metrics to \"" << temporary_path
+					  << "\"!" << std::endl;
+			return;
+		}
+		SaveMetricsReport(program_, output);
+	}
+	std::rename(temporary_path.c_str(), path_.c_str());
+}
+
+
+CountingMutex::~CountingMutex() {
+	if (acquisitions_ == 0) { return; }
+	AddToCounter(name_ + "_lock_acquisitions", acquisitions_);
+	AddToCounter(name_ + "_lock_waits", waits_);
+	AddToCounter(name_ + "_lock_wait_us",
+			chr::duration_cast<chr::microseconds>(wait_time_).count());
+}
+
+
+void CountingMutex::lock() {
+	if (mutex_.try_lock()) {
+		++acquisitions_;
+		return;
+	}
+
+	auto wait_start = chr::steady_clock::now();
+	mutex_.lock();
+	++acquisitions_;
+	++waits_;
+	wait_time_ += chr::steady_clock::now() - wait_start;
+}
+
+
+CountingStreamBuffer::int_type CountingStreamBuffer::overflow(int_type c) {
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+	{ return traits_type::not_eof(c); }
+	++count_;
+	return destination_->sputc(traits_type::to_char_type(c));
+}
+
+
+streamsize CountingStreamBuffer::xsputn(const char* s, streamsize n) {
+	auto written = destination_->sputn(s, n);
+	count_ += written;
+	return written;
+}
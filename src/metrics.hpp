@@ -0,0 +1,136 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+
+// Run metrics shared by every binary: wall and CPU time of named phases,
+// counters and peak memory. Everything is process wide and thread-safe, the
+// report is JSON of the form
+//     {"program": "build", "wall_seconds": 12.5, "cpu_seconds": 40.1,
+//      "rss_kb": 100000, "peak_rss_kb": 123456,
+//      "phases": [{"name": "load_archives", "wall_seconds": 1.2,
+//                  "cpu_seconds": 1.2, "running": false}, ...],
+//      "labels": {"edge_checksum": "0123456789abcdef", ...},
+//      "counters": {"pairs_evaluated": 1000, ...}}
+// Phases are listed in the order they started, a phase still running reports
+// its time so far. Builds counting allocations (see allocation_counter.hpp)
+// add "allocations", "deallocations" and "allocated_bytes" to the process and
+// to every phase, counting every thread's allocations while it ran.
+
+
+// Times a phase from construction until Stop is called or it's destroyed.
+class PhaseTimer {
+ public:
+	PhaseTimer(const std::string& name);
+	~PhaseTimer() { Stop(); }
+
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+	void Stop();
+
+ private:
+	int phase_index_;
+	bool running_;
+};
+
+
+// Adds to the counter of the given name, creating it at 0 if necessary.
+void AddToCounter(const std::string& name, long value);
+
+// Returns the counter's value, 0 if it doesn't exist.
+long GetCounter(const std::string& name);
+
+// Sets a label, e.g. a checksum, replacing any earlier value.
+void SetLabel(const std::string& name, const std::string& value);
+
+// Returns the label's value, empty if it doesn't exist.
+std::string GetLabel(const std::string& name);
+
+// Returns the size of the file in bytes, or -1 if it can't be read.
+long GetFileSize(const std::string& path);
+
+// Writes the JSON report of everything recorded so far.
+void SaveMetricsReport(const std::string& program, std::ostream& output);
+
+
+// Writes the report to path when destroyed and, if period_seconds is
+// positive, every period_seconds until then. Does nothing for an empty path.
+// Reports replace the file atomically so it can be watched while running.
+class MetricsReporter {
+ public:
+	MetricsReporter(const std::string& program, const std::string& path,
+					int period_seconds);
+	~MetricsReporter();
+
+	MetricsReporter(const MetricsReporter&) = delete;
+	MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+	// Saves the report now, e.g. before exiting without unwinding.
+	void SaveReport() const;
+
+ private:
+
+	std::string program_, path_;
+	std::atomic<bool> stop_;
+	std::thread reporter_thread_;
+	// the reporter thread and SaveReport callers share the temporary file
+	mutable std::mutex save_mutex_;
+};
+
+
+// A mutex that measures its contention, for use with std::lock_guard. When
+// destroyed it adds the number of times it was locked, the number of those
+// that had to wait and the total time spent waiting to the counters
+// "<name>_lock_acquisitions", "<name>_lock_waits" and
+// "<name>_lock_wait_us". An uncontended lock costs one try_lock, only waits
+// are timed.
+class CountingMutex {
+ public:
+	CountingMutex(const std::string& name) :
+		name_{name}, acquisitions_{0}, waits_{0}, wait_time_{0} {}
+	~CountingMutex();
+
+	CountingMutex(const CountingMutex&) = delete;
+	CountingMutex& operator=(const CountingMutex&) = delete;
+
+	void lock();
+	void unlock() { mutex_.unlock(); }
+
+ private:
+	std::string name_;
+	std::mutex mutex_;
+	// only changed while holding mutex_
+	long acquisitions_, waits_;
+	std::chrono::steady_clock::duration wait_time_;
+};
+
+
+// Forwards output to another stream buffer and counts the bytes written,
+// e.g. to count what's saved to std::cout.
+class CountingStreamBuffer : public std::streambuf {
+ public:
+	CountingStreamBuffer(std::streambuf* destination) :
+		destination_{destination}, count_{0} {}
+
+	long count() const { return count_; }
+
+ protected:
+	int_type overflow(int_type c) override;
+	std::streamsize xsputn(const char* s, std::streamsize n) override;
+	int sync() override { return destination_->pubsync(); }
+
+ private:
+	std::streambuf* destination_;
+	long count_;
+};
+
+
+#endif  // METRICS_H
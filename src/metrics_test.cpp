@@ -0,0 +1,108 @@
+#include "metrics.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+
+using std::ostream;
+using std::ostringstream;
+using std::string; using std::to_string;
+
+
+// The metrics are global, so the tests check what they add to them and can
+// be repeated.
+TEST(MetricsTest, Counters) {
+	EXPECT_EQ(0, GetCounter("metrics_test_unused_counter"));
+	auto start = GetCounter("metrics_test_counter");
+	AddToCounter("metrics_test_counter", 5);
+	AddToCounter("metrics_test_counter", 7);
+	EXPECT_EQ(start + 12, GetCounter("metrics_test_counter"));
+}
+
+
+TEST(MetricsTest, Labels) {
+	EXPECT_EQ("", GetLabel("metrics_test_unused_label"));
+	SetLabel("metrics_test_label", "first");
+	SetLabel("metrics_test_label", "second");
+	EXPECT_EQ("second", GetLabel("metrics_test_label"));
+}
+
+
+TEST(MetricsTest, Report) {
+	{
+		PhaseTimer stopped_timer{"metrics_test_stopped"};
+		stopped_timer.Stop();
+	}
+	PhaseTimer running_timer{"metrics_test \"running\""};
+	auto start = GetCounter("metrics_test_report");
+	AddToCounter("metrics_test_report", 3);
+	SetLabel("metrics_test_report_label", "abc");
+
+	ostringstream report;
+	SaveMetricsReport("metrics_test", report);
+	auto report_str = report.str();
+
+	EXPECT_EQ(0u, report_str.find("{\"program\": \"metrics_test\""));
+	EXPECT_NE(string::npos, report_str.find("\"peak_rss_kb\": "));
+	EXPECT_NE(string::npos, report_str.find(
+				"{\"name\": \"metrics_test_stopped\", \"wall_seconds\": "));
+	EXPECT_NE(string::npos,
+			report_str.find("{\"name\": \"metrics_test \\\"running\\\"\""));
+#ifdef ENABLE_ALLOCATION_TRACKING
+	EXPECT_NE(string::npos,
+			report_str.find("\"running\": true, \"allocations\": "));
+#else
+	EXPECT_NE(string::npos, report_str.find("\"running\": true}"));
+#endif  // ENABLE_ALLOCATION_TRACKING
+	EXPECT_NE(string::npos, report_str.find(
+				"\"metrics_test_report\": " + to_string(start + 3)));
+	EXPECT_NE(string::npos,
+			report_str.find("\"metrics_test_report_label\": \"abc\""));
+	EXPECT_EQ("}}\n", report_str.substr(report_str.size() - 3));
+}
+
+
+TEST(MetricsTest, CountingStreamBuffer) {
+	ostringstream destination;
+	CountingStreamBuffer counting_buffer{destination.rdbuf()};
+	ostream output{&counting_buffer};
+	output << "twelve bytes" << 'x' << 42;
+	output.flush();
+
+	EXPECT_EQ("twelve bytesx42", destination.str());
+	EXPECT_EQ(15, counting_buffer.count());
+}
+
+
+TEST(MetricsTest, CountingMutex) {
+	auto start_acquisitions = GetCounter("metrics_test_lock_acquisitions");
+	auto start_waits = GetCounter("metrics_test_lock_waits");
+	auto start_wait_us = GetCounter("metrics_test_lock_wait_us");
+	{
+		CountingMutex counting_mutex{"metrics_test"};
+		{ std::lock_guard<CountingMutex> lg{counting_mutex}; }
+
+		// hold the lock until the other thread is about to wait for it
+		counting_mutex.lock();
+		std::thread waiter{[&counting_mutex]()
+			{ std::lock_guard<CountingMutex> lg{counting_mutex}; }};
+		std::this_thread::sleep_for(std::chrono::milliseconds{20});
+		counting_mutex.unlock();
+		waiter.join();
+	}
+
+	EXPECT_EQ(start_acquisitions + 3,
+			  GetCounter("metrics_test_lock_acquisitions"));
+	EXPECT_EQ(start_waits + 1, GetCounter("metrics_test_lock_waits"));
+	EXPECT_GT(GetCounter("metrics_test_lock_wait_us"), start_wait_us);
+}
+
+
+TEST(MetricsTest, GetFileSize)
+{ EXPECT_EQ(-1, GetFileSize("/nonexistent/metrics_test")); }
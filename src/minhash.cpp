@@ -0,0 +1,151 @@
+#include "minhash.hpp"
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "course.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "trace.hpp"
+#include "utility.hpp"
+
+
+using std::begin; using std::end;
+using std::map;
+using std::pair;
+using std::uint64_t;
+using std::vector;
+
+
+// Numbers the courses taken by the students in the order of their IDs, so
+// signatures don't depend on where the courses are in memory.
+static map<const Course*, uint64_t> NumberCourses(
+		const StudentContainer& students) {
+	vector<const Course*> courses;
+	for (const auto& student : students) {
+		courses.insert(end(courses), begin(student.courses_taken()),
+				end(student.courses_taken()));
+	}
+	std::sort(begin(courses), end(courses));
+	courses.erase(std::unique(begin(courses), end(courses)), end(courses));
+	std::sort(begin(courses), end(courses),
+			[](const Course* course1, const Course* course2) {
+				return std::make_tuple(course1->subject(), course1->number(),
+						course1->term()) < std::make_tuple(course2->subject(),
+						course2->number(), course2->term());
+			});
+
+	map<const Course*, uint64_t> course_numbers;
+	for (const auto& course : courses)
+	{ course_numbers.emplace(course, course_numbers.size()); }
+	return course_numbers;
+}
+
+
+double MinHashOptions::GetCandidateProbability(double similarity) const {
+	return 1. - std::pow(1. - std::pow(similarity, band_rows), num_bands);
+}
+
+
+double MinHashOptions::GetSimilarity(double candidate_probability) const {
+	return std::pow(1. - std::pow(1. - candidate_probability, 1. / num_bands),
+			1. / band_rows);
+}
+
+
+MinHashIndex::MinHashIndex(const StudentContainer& students,
+						   const MinHashOptions& options) :
+		options_(options),
+		signature_size_{options.num_bands * options.band_rows},
+		signatures_(students.size() * signature_size_,
+				std::numeric_limits<uint64_t>::max()),
+		band_students_(options.num_bands),
+		buckets_(options.num_bands, vector<pair<long, long>>(students.size())) {
+	TRACE_SCOPE("build_minhash_index");
+	assert(options.num_bands > 0 && options.band_rows > 0);
+	auto course_numbers = NumberCourses(students);
+	vector<uint64_t> hash_seeds(signature_size_);
+	for (int i{0}; i < signature_size_; ++i)
+	{ hash_seeds[i] = MixBits(options.seed + MixBits(i)); }
+
+	long num_students{static_cast<long>(students.size())};
+	auto student_it = begin(students);
+	for (long student{0}; student < num_students; ++student) {
+		auto student_signature = &signatures_[student * signature_size_];
+		for (const auto& course : student_it[student].courses_taken()) {
+			auto course_number = course_numbers.at(course);
+			for (int i{0}; i < signature_size_; ++i) {
+				student_signature[i] = std::min(student_signature[i],
+						MixBits(course_number ^ hash_seeds[i]));
+			}
+		}
+	}
+
+	// sort the students of every band by the hash of their band, which
+	// puts every bucket in a range ordered by index
+	vector<pair<uint64_t, long>> band_keys;
+	for (int band{0}; band < options.num_bands; ++band) {
+		band_keys.clear();
+		for (long student{0}; student < num_students; ++student) {
+			if (student_it[student].courses_taken().empty()) { continue; }
+			uint64_t key{MixBits(band)};
+			auto band_signature = signature(student) + band * options.band_rows;
+			for (int i{0}; i < options.band_rows; ++i)
+			{ key = MixBits(key ^ band_signature[i]); }
+			band_keys.emplace_back(key, student);
+		}
+		std::sort(begin(band_keys), end(band_keys));
+
+		auto& students_by_bucket = band_students_[band];
+		for (std::size_t first{0}, last{0}; first < band_keys.size();
+				first = last) {
+			while (last < band_keys.size() &&
+					band_keys[last].first == band_keys[first].first)
+			{ ++last; }
+			for (auto i = first; i < last; ++i) {
+				students_by_bucket.push_back(band_keys[i].second);
+				buckets_[band][band_keys[i].second] = {first, last};
+			}
+		}
+	}
+}
+
+
+long MinHashIndex::GetCandidates(long row, vector<long>& columns) const {
+	columns.clear();
+	for (int band{0}; band < options_.num_bands; ++band) {
+		const auto& bucket = buckets_[band][row];
+		auto bucket_begin = begin(band_students_[band]) + bucket.first;
+		auto bucket_end = begin(band_students_[band]) + bucket.second;
+		columns.insert(end(columns),
+				std::upper_bound(bucket_begin, bucket_end, row), bucket_end);
+	}
+	std::sort(begin(columns), end(columns));
+	columns.erase(std::unique(begin(columns), end(columns)), end(columns));
+
+	if (options_.min_similarity <= 0.) { return 0; }
+	auto num_candidates = columns.size();
+	columns.erase(std::remove_if(begin(columns), end(columns),
+				[this, row](long column) {
+					return EstimateSimilarity(row, column) <
+						options_.min_similarity;
+				}), end(columns));
+	return num_candidates - columns.size();
+}
+
+
+double MinHashIndex::EstimateSimilarity(long student1, long student2) const {
+	auto signature1 = signature(student1);
+	auto signature2 = signature(student2);
+	int num_equal{0};
+	for (int i{0}; i < signature_size_; ++i)
+	{ num_equal += signature1[i] == signature2[i]; }
+	return num_equal / static_cast<double>(signature_size_);
+}
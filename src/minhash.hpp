@@ -0,0 +1,68 @@
+#ifndef MINHASH_H
+#define MINHASH_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+class StudentContainer;
+
+// Approximate building of the student network. Every student gets a MinHash
+// signature of their courses: the smallest value of each of
+// num_bands * band_rows hash functions over the courses. Two students agree
+// on a value with probability equal to the Jaccard similarity of their
+// courses. Signatures are split into bands of band_rows values, and students
+// whose signatures agree on a whole band are candidates. Only candidates are
+// weighted, so students sharing few of their courses are likely missed.
+
+
+// More bands find more of the less similar pairs (recall), more rows per band
+// find fewer of them, so fewer pairs are weighted for nothing (precision).
+struct MinHashOptions {
+	int num_bands{20};
+	int band_rows{3};
+	// candidates whose whole signatures agree on less than this fraction of
+	// values aren't weighted
+	double min_similarity{0.};
+	std::uint64_t seed{0};
+
+	// The probability a pair of the given Jaccard similarity is a candidate.
+	double GetCandidateProbability(double similarity) const;
+	// The Jaccard similarity of pairs that are candidates with the given
+	// probability.
+	double GetSimilarity(double candidate_probability) const;
+};
+
+
+// The signatures and band buckets of the students, by their index in the
+// container. Students without courses are never candidates.
+class MinHashIndex {
+ public:
+	MinHashIndex(const StudentContainer& students,
+				 const MinHashOptions& options);
+
+	// Sets columns to the candidates of the student at row that come after
+	// it, in increasing order. Returns the number left out for being less
+	// similar than min_similarity.
+	long GetCandidates(long row, std::vector<long>& columns) const;
+
+	// Estimates the Jaccard similarity of the courses of two students from
+	// their signatures.
+	double EstimateSimilarity(long student1, long student2) const;
+
+ private:
+	const std::uint64_t* signature(long student) const
+	{ return &signatures_[student * signature_size_]; }
+
+	MinHashOptions options_;
+	int signature_size_;
+	std::vector<std::uint64_t> signatures_;
+	// the students of every band, ordered by bucket and then index
+	std::vector<std::vector<long>> band_students_;
+	// the range of a student's bucket in band_students_, by band and student
+	std::vector<std::vector<std::pair<long, long>>> buckets_;
+};
+
+
+#endif  // MINHASH_H
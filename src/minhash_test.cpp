@@ -0,0 +1,109 @@
+#include "minhash.hpp"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "course.hpp"
+#include "student.hpp"
+#include "student_container_mock.hpp"
+
+
+using std::vector;
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+
+TEST(MinHashOptionsTest, CandidateProbability) {
+	MinHashOptions options;
+	options.num_bands = 20;
+	options.band_rows = 3;
+	EXPECT_DOUBLE_EQ(0., options.GetCandidateProbability(0.));
+	EXPECT_DOUBLE_EQ(1., options.GetCandidateProbability(1.));
+	EXPECT_NEAR(0.5, options.GetCandidateProbability(
+				options.GetSimilarity(0.5)), 1e-9);
+
+	// more rows per band find fewer of the same pairs
+	auto similarity = options.GetSimilarity(0.5);
+	options.band_rows = 5;
+	EXPECT_LT(options.GetCandidateProbability(similarity), 0.5);
+}
+
+
+class MinHashIndexTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		// 1 and 2 took the same courses, 3 shares one of them, 4 none and 5
+		// took no courses at all
+		Student student1{1}, student2{2}, student3{3}, student4{4};
+		student1.AddCoursesTaken({&course1, &course2, &course3});
+		student2.AddCoursesTaken({&course3, &course2, &course1});
+		student3.AddCoursesTaken({&course1, &course4, &course5, &course6});
+		student4.AddCourseTaken(&course7);
+		students.Insert({student1, student2, student3, student4, Student{5}});
+		ON_CALL(students, size()).WillByDefault(Return(5));
+	}
+
+ protected:
+	Course course1{"ENGLISH", 125, 0, 4}, course2{"AAPTIS", 277, 0, 4},
+		   course3{"CHEM", 210, 0, 4}, course4{"CHEM", 211, 0, 1},
+		   course5{"ENVIRON", 311, 0, 4}, course6{"MATH", 425, 0, 3},
+		   course7{"MATH", 215, 0, 4};
+	NiceMock<MockStudentContainer> students;
+};
+
+
+TEST_F(MinHashIndexTest, Candidates) {
+	MinHashOptions options;
+	options.num_bands = 50;
+	options.band_rows = 1;
+	MinHashIndex index{students, options};
+
+	EXPECT_DOUBLE_EQ(1., index.EstimateSimilarity(0, 1));
+	EXPECT_DOUBLE_EQ(0., index.EstimateSimilarity(0, 3));
+
+	// a similarity of 1/6 is found with all but a 1e-4 chance
+	vector<long> columns;
+	EXPECT_EQ(0, index.GetCandidates(0, columns));
+	EXPECT_THAT(columns, ElementsAre(1, 2));
+	index.GetCandidates(1, columns);
+	EXPECT_THAT(columns, ElementsAre(2));
+	index.GetCandidates(2, columns);
+	EXPECT_THAT(columns, IsEmpty());
+	index.GetCandidates(3, columns);
+	EXPECT_THAT(columns, IsEmpty());
+	index.GetCandidates(4, columns);
+	EXPECT_THAT(columns, IsEmpty());
+}
+
+
+TEST_F(MinHashIndexTest, MinSimilarity) {
+	MinHashOptions options;
+	options.num_bands = 50;
+	options.band_rows = 1;
+	options.min_similarity = 0.9;
+	MinHashIndex index{students, options};
+
+	vector<long> columns;
+	EXPECT_EQ(1, index.GetCandidates(0, columns));
+	EXPECT_THAT(columns, ElementsAre(1));
+}
+
+
+TEST_F(MinHashIndexTest, Seed) {
+	// a band of many rows only finds the identical students
+	MinHashOptions options;
+	options.num_bands = 1;
+	options.band_rows = 40;
+	for (std::uint64_t seed : {0, 1, 2}) {
+		options.seed = seed;
+		MinHashIndex index{students, options};
+		vector<long> columns;
+		index.GetCandidates(0, columns);
+		EXPECT_THAT(columns, ElementsAre(1));
+	}
+}
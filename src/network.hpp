@@ -7,6 +7,7 @@
 #include <iterator>
 #include <map>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/archive/text_iarchive.hpp>
@@ -20,6 +21,8 @@
 
 #include "adj_mat_serialize.hpp"
 #include "bgl_value_iterator.hpp"
+#include "edge_checksum.hpp"
+#include "trace.hpp"
 
 class NoEdgeException{};
 class NoVertexException{};
@@ -70,6 +73,10 @@ class Network {
 	// find the descriptor for a vertex given its value, takes O(|V|) time
 	vertex_t GetVertexDescriptor(const Vertex& vertex) const;
 
+	// maps every vertex value to its descriptor in O(|V|) time, use it in place
+	// of repeated calls to GetVertexDescriptor
+	std::unordered_map<Vertex, vertex_t> GetVertexIndex() const;
+
 	Edge& operator[](const edge_t& edge) { return graph_[edge]; }
 	const Edge& operator[](const edge_t& edge) const { return graph_[edge]; }
 
@@ -106,7 +113,9 @@ class Network {
 
 	void Save(std::ostream& output_graph_archive) const;
 	void Load(std::istream& input_graph_archive);
-	void SaveEdgewise(std::ostream& output) const;
+	// Saves a "<vertex>\t<vertex>\t<edge>" line for every edge, returning the
+	// checksum of the edges as written.
+	EdgeChecksum SaveEdgewise(std::ostream& output) const;
 
 	// classes declared to provide iterator access to vertices
 	// constructors are private to require access through GetVertices() and
@@ -390,6 +399,17 @@ Network<Vertex, Edge>::GetVertexDescriptor(const Vertex& vertex) const {
 }
 
 
+template <typename Vertex, typename Edge>
+std::unordered_map<Vertex, typename Network<Vertex, Edge>::vertex_t>
+Network<Vertex, Edge>::GetVertexIndex() const {
+	std::unordered_map<Vertex, vertex_t> index;
+	index.reserve(GetVertexDescriptors().size());
+	for (auto vertex_d : GetVertexDescriptors())
+	{ index.emplace(operator[](vertex_d), vertex_d); }
+	return index;
+}
+
+
 template <typename Vertex, typename Edge>
 std::map<Vertex, int> Network<Vertex, Edge>::FindUnweightedDistances(
 		vertex_t start) const {
@@ -474,6 +494,7 @@ Network<Vertex, Edge>::CalculateUnweightedBetweennessCentrality() const {
 
 template <typename Vertex, typename Edge>
 void Network<Vertex, Edge>::Save(std::ostream& output_graph_archive) const {
+	TRACE_SCOPE("save_network");
 	// create boost archive from ostream and save the graph
 	boost::archive::text_oarchive archive{output_graph_archive};
 	archive << graph_;	
@@ -482,17 +503,22 @@ void Network<Vertex, Edge>::Save(std::ostream& output_graph_archive) const {
 
 template <typename Vertex, typename Edge>
 void Network<Vertex, Edge>::Load(std::istream& input_graph_archive) {
+	TRACE_SCOPE("load_network");
 	boost::archive::text_iarchive archive{input_graph_archive};
 	archive >> graph_;
 }
 
 template <typename Vertex, typename Edge>
-void Network<Vertex, Edge>::SaveEdgewise(std::ostream& output) const {
+EdgeChecksum Network<Vertex, Edge>::SaveEdgewise(std::ostream& output) const {
 	// output all edges in "vertex1 vertex2 edge" form
+	EdgeChecksum checksum;
 	for (const auto& edge_d : GetEdgeDescriptors()) {
 		output << GetSourceValue(edge_d) << "\t" << GetTargetValue(edge_d)
 			   << "\t" << operator[](edge_d) << std::endl;
+		checksum.AddEdge(GetSourceValue(edge_d), GetTargetValue(edge_d),
+				GetWrittenWeight(operator[](edge_d), output.precision()));
 	}
+	return checksum;
 }
 
 
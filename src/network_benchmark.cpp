@@ -0,0 +1,190 @@
+#include <cmath>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "network.hpp"
+#include "reduce_network.hpp"
+
+
+using std::begin; using std::end;
+using std::map;
+using std::mt19937; using std::uniform_real_distribution;
+using std::ostringstream;
+using std::tuple; using std::make_tuple;
+using std::unique_ptr;
+using std::vector;
+
+
+// Every benchmark takes the number of vertices, the expected density of the
+// graph in percent and the skew of the degree distribution in tenths, so
+// Args({2000, 5, 10}) is a graph of 2000 vertices with 5% of all possible
+// edges whose degrees follow a Zipf distribution with exponent 1.
+//
+// Benchmarks are templated on the network so every storage backend can be
+// registered with BENCHMARK_TEMPLATE. Network only stores graphs in an
+// adjacency matrix for now, which takes O(|V|^2) memory whatever the density.
+using MatrixNetwork = Network<int, double>;
+
+// Distances are found from this many sources, cycling through them.
+const int num_sources{16};
+
+// Number of groups of vertices ReduceNetwork reduces the graph to.
+const int num_reduced_groups{16};
+
+
+// Random graphs are generated once per set of arguments and shared.
+template <typename NetworkType>
+static const NetworkType& GetGraph(const benchmark::State& state) {
+	static map<tuple<int, int, int>, unique_ptr<NetworkType>> cache;
+	auto num_vertices = static_cast<int>(state.range(0));
+	auto density = state.range(1) / 100.;
+	auto skew = state.range(2) / 10.;
+	auto& network = cache[make_tuple(
+			num_vertices, state.range(1), state.range(2))];
+	if (network) { return *network; }
+
+	// Chung-Lu graphs: vertices i and j are adjacent with probability
+	// proportional to w_i * w_j, where the weights fall off with the rank of
+	// the vertex like Zipf's law. The expected degrees follow the weights,
+	// though skewed graphs come out sparser since probabilities cap at 1.
+	vector<double> weights;
+	for (int rank{1}; rank <= num_vertices; ++rank)
+	{ weights.push_back(1. / std::pow(rank, skew)); }
+	auto mean_weight = std::accumulate(begin(weights), end(weights), 0.) /
+		num_vertices;
+	auto scale = density / (mean_weight * mean_weight);
+
+	vector<int> values(num_vertices);
+	std::iota(begin(values), end(values), 0);
+	network.reset(new NetworkType{begin(values), end(values)});
+
+	mt19937 engine{1};
+	uniform_real_distribution<double> uniform{0., 1.};
+	auto vertex_it = begin(network->GetVertexDescriptors());
+	for (int i{0}; i < num_vertices; ++i) {
+		for (int j{0}; j < i; ++j) {
+			if (uniform(engine) >= scale * weights[i] * weights[j]) { continue; }
+			(*network)(vertex_it[i], vertex_it[j]) = 1. - uniform(engine);
+		}
+	}
+	return *network;
+}
+
+
+// Reports the edges visited per second, each iteration visiting them all.
+template <typename NetworkType>
+static void SetEdgesProcessed(benchmark::State& state,
+							  const NetworkType& network) {
+	state.counters["edges"] = network.GetEdgeDescriptors().size();
+	state.counters["edges/s"] = benchmark::Counter(
+			static_cast<double>(network.GetEdgeDescriptors().size()) *
+			state.iterations(), benchmark::Counter::kIsRate);
+}
+
+
+template <typename NetworkType>
+static void BM_FindUnweightedDistances(benchmark::State& state) {
+	const auto& network = GetGraph<NetworkType>(state);
+	auto vertex_it = begin(network.GetVertexDescriptors());
+	int source{0};
+	while (state.KeepRunning()) {
+		auto distances = network.FindUnweightedDistances(
+				vertex_it[source++ % num_sources]);
+		benchmark::DoNotOptimize(distances);
+	}
+	SetEdgesProcessed(state, network);
+}
+
+
+template <typename NetworkType>
+static void BM_FindWeightedDistances(benchmark::State& state) {
+	const auto& network = GetGraph<NetworkType>(state);
+	auto vertex_it = begin(network.GetVertexDescriptors());
+	int source{0};
+	while (state.KeepRunning()) {
+		auto distances = network.FindWeightedDistances(
+				vertex_it[source++ % num_sources]);
+		benchmark::DoNotOptimize(distances);
+	}
+	SetEdgesProcessed(state, network);
+}
+
+
+template <typename NetworkType>
+static void BM_CalculateUnweightedBetweennessCentrality(
+		benchmark::State& state) {
+	const auto& network = GetGraph<NetworkType>(state);
+	while (state.KeepRunning()) {
+		auto centrality = network.CalculateUnweightedBetweennessCentrality();
+		benchmark::DoNotOptimize(centrality);
+	}
+	SetEdgesProcessed(state, network);
+}
+
+
+template <typename NetworkType>
+static void BM_SaveEdgewise(benchmark::State& state) {
+	const auto& network = GetGraph<NetworkType>(state);
+	while (state.KeepRunning()) {
+		ostringstream output;
+		network.SaveEdgewise(output);
+		benchmark::DoNotOptimize(output);
+	}
+	SetEdgesProcessed(state, network);
+}
+
+
+template <typename NetworkType>
+static void BM_ReduceNetwork(benchmark::State& state) {
+	const auto& network = GetGraph<NetworkType>(state);
+	while (state.KeepRunning()) {
+		auto reduced = ReduceNetwork(network,
+				[](int vertex) { return vertex % num_reduced_groups; },
+				[](double edge, double sum) { return sum + edge; }, 0.);
+		benchmark::DoNotOptimize(reduced);
+	}
+	SetEdgesProcessed(state, network);
+}
+
+
+// Sparse and dense graphs, with uniform and skewed degrees.
+static void GraphArguments(benchmark::internal::Benchmark* benchmark) {
+	for (int num_vertices : {500, 2000, 5000}) {
+		for (int density : {1, 10}) {
+			for (int skew : {0, 10})
+			{ benchmark->Args({num_vertices, density, skew}); }
+		}
+	}
+	benchmark->Unit(benchmark::kMillisecond);
+}
+
+
+// Betweenness centrality takes O(|V||E|) time, so only small graphs.
+static void SmallGraphArguments(benchmark::internal::Benchmark* benchmark) {
+	for (int density : {1, 10}) {
+		for (int skew : {0, 10}) { benchmark->Args({500, density, skew}); }
+	}
+	benchmark->Unit(benchmark::kMillisecond);
+}
+
+
+BENCHMARK_TEMPLATE(BM_FindUnweightedDistances, MatrixNetwork)
+	->Apply(GraphArguments);
+BENCHMARK_TEMPLATE(BM_FindWeightedDistances, MatrixNetwork)
+	->Apply(GraphArguments);
+BENCHMARK_TEMPLATE(BM_CalculateUnweightedBetweennessCentrality, MatrixNetwork)
+	->Apply(SmallGraphArguments);
+BENCHMARK_TEMPLATE(BM_SaveEdgewise, MatrixNetwork)->Apply(GraphArguments);
+BENCHMARK_TEMPLATE(BM_ReduceNetwork, MatrixNetwork)->Apply(GraphArguments);
+
+
+BENCHMARK_MAIN();
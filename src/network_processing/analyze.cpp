@@ -0,0 +1,124 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "course_container.hpp"
+#include "metrics.hpp"
+#include "pipeline.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+#include "utility.hpp"
+
+
+using std::cerr; using std::cout; using std::endl;
+using std::exception;
+using std::ifstream;
+using std::string;
+using std::vector;
+
+namespace po = boost::program_options;
+
+
+int main(int argc, char* argv[]) {
+	po::options_description desc{"Run an analysis pipeline over a network:"};
+	string student_archive_path, course_archive_path,
+		   student_network_archive_path, pipeline_path,
+		   metrics_path, trace_path;
+	int metrics_period;
+	desc.add_options()
+		("help,h", "Show this help message")
+		("student_network_archive_path",
+		 po::value<string>(&student_network_archive_path)->required(),
+		 "Set the path at which to find the archive student network")
+		("student_archive_path",
+		 po::value<string>(&student_archive_path)->required(),
+		 "Set the path at which to find the student file")
+		("course_archive_path",
+		 po::value<string>(&course_archive_path)->required(),
+		 "Set the path at which to find the enrollment file")
+		("pipeline_path", po::value<string>(&pipeline_path)->required(),
+		 "Set the path at which to find the pipeline description, see "
+		 "src/pipeline.hpp for the format")
+		("threads,t", po::value<int>(&num_threads)->default_value(1),
+		 "Number of threads to use within each stage")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
+
+	po::variables_map vm;
+
+	try {
+		po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 0;
+		}
+		po::notify(vm);
+	} catch (po::required_option& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (po::error& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	// parse the pipeline before spending time loading the inputs
+	ifstream pipeline_stream{pipeline_path};
+	if (!pipeline_stream.is_open()) {
+		cerr << "Could not open pipeline file \"" << pipeline_path << "\"!"
+			 << endl;
+		return -1;
+	}
+	vector<PipelineStage> stages;
+	try {
+		stages = ParsePipeline(pipeline_stream);
+	} catch (PipelineError& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{
+		"analyze", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
+	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
+	ifstream student_archive{student_archive_path};
+	ifstream course_archive{course_archive_path};
+    StudentContainer students{
+        StudentContainer::LoadFromArchive(student_archive)};
+	CourseContainer courses{
+        CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
+	students.UpdateCourses(courses);
+	update_timer.Stop();
+
+	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
+	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
+
+	PhaseTimer pipeline_timer{"pipeline"};
+
+	try {
+		RunPipeline(stages, student_network, students);
+	} catch (exception& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	return 0;
+}
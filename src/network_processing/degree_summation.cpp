@@ -1,18 +1,21 @@
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <iterator>
+#include <stdexcept>
 #include <string>
 
 #include <boost/program_options.hpp>
 
+#include "analysis_stages.hpp"
 #include "course_container.hpp"
-#include "reduce_network.hpp"
+#include "metrics.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "student_sample.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
-using std::begin; using std::end;
 using std::cerr; using std::cout; using std::endl;
 using std::ifstream; using std::ofstream;
 using std::string;
@@ -23,7 +26,10 @@ namespace po = boost::program_options;
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Sum degrees of students in network:"};
 	string student_archive_path, course_archive_path,
-		   course_network_archive_path, student_network_archive_path;
+		   course_network_archive_path, student_network_archive_path,
+		   metrics_path, trace_path;
+	int metrics_period;
+	SampleOptions sample_options;
 	desc.add_options()
 		("help,h", "Show this help message")
 		("student_network_archive_path",
@@ -34,7 +40,23 @@ int main(int argc, char* argv[]) {
 		 "Set the path at which to find the student file")
 		("course_archive_path",
 		 po::value<string>(&course_archive_path)->required(),
-		 "Set the path at which to find the enrollment file");
+		 "Set the path at which to find the enrollment file")
+		("sample_rate",
+		 po::value<double>(&sample_options.rate)->default_value(1.),
+		 "The network is that of build's sample of this fraction of the "
+		 "students, estimate the degree sums of the whole network from it")
+		("sample_seed", po::value<std::uint64_t>(
+			&sample_options.seed)->default_value(0),
+		 "Seed build sampled the students with")
+		("stratify_by", po::value<string>(&sample_options.stratify_by),
+		 "What build stratified the sample by, if anything")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
 
 	po::variables_map vm;
 
@@ -53,28 +75,54 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
+	MetricsReporter metrics_reporter{
+		"degree_summation", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
 	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
 	ifstream student_archive{student_archive_path};
 	ifstream course_archive{course_archive_path};
     StudentContainer students{
         StudentContainer::LoadFromArchive(student_archive)};
 	CourseContainer courses{
         CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
 	students.UpdateCourses(courses);
+	update_timer.Stop();
 
 	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
 	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
+
+	PhaseTimer degree_sum_timer{"degree_sum"};
 
 	ofstream weighted_students{"output/student_weighted_summation.tsv"};
 	ofstream unweighted_students{"output/student_unweighted_summation.tsv"};
-	for (const auto& student_d : student_network.GetVertexDescriptors()) {
-		auto out_edges = student_network.GetOutEdgeValues(student_d);
-		auto weighted_sum = accumulate(
-				begin(out_edges), end(out_edges), 0.);
-		auto unweighted_sum = out_edges.size();
-		weighted_students << student_network[student_d] << '\t' << weighted_sum
-						  << endl;
-		unweighted_students << student_network[student_d] << '\t'
-							<< unweighted_sum << endl;
+	if (!sample_options.IsSampling()) {
+		SaveDegreeSums(student_network, weighted_students, unweighted_students);
+		return 0;
 	}
+
+	// the sample is drawn again from every student, as build drew it
+	try {
+		StudentSample sample{students, sample_options};
+		ofstream summary{"output/student_summation_estimates.tsv"};
+		SaveDegreeSumEstimates(student_network, sample, weighted_students,
+				unweighted_students, summary);
+	} catch (InvalidSample& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (std::invalid_argument& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	return 0;
 }
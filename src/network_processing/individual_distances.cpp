@@ -1,47 +1,38 @@
-#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <iterator>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include <boost/algorithm/string/join.hpp>
 #include <boost/program_options.hpp>
 
+#include "analysis_stages.hpp"
 #include "course_container.hpp"
+#include "metrics.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
-using std::transform;
-using std::begin; using std::back_inserter; using std::end;
 using std::cerr; using std::cout; using std::endl;
 using std::ifstream; using std::ofstream;
-using std::pair;
-using std::string; using std::to_string;
+using std::make_pair; using std::pair;
+using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace po = boost::program_options;
-using boost::algorithm::join;
-
-
-template <typename FilterFunc>
-static void SaveWeightedDistances(const StudentNetwork& network,
-								   const string& filename,
-								   FilterFunc filter);
-
-template <typename FilterFunc>
-static void SaveUnweightedDistances(const StudentNetwork& network,
-									 const string& filename,
-									 FilterFunc filter);
 
 
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Options for saving individual distances:"};
 	string student_archive_path, course_archive_path,
-		   course_network_archive_path, student_network_archive_path;
+		   course_network_archive_path, student_network_archive_path,
+		   metrics_path, trace_path;
+	int metrics_period;
+	double delta;
 	desc.add_options()
 		("help,h", "Show this help message")
 		("student_network_archive_path",
@@ -52,7 +43,19 @@ int main(int argc, char* argv[]) {
 		 "Set the path at which to find the student file")
 		("course_archive_path",
 		 po::value<string>(&course_archive_path)->required(),
-		 "Set the path at which to find the enrollment file");
+		 "Set the path at which to find the enrollment file")
+		("delta", po::value<double>(&delta),
+		 "Use parallel delta-stepping with this bucket width for weighted "
+		 "distances instead of Dijkstra")
+		("threads,t", po::value<int>(&num_threads)->default_value(1),
+		 "Number of threads to use for delta-stepping")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
 
 	po::variables_map vm;
 
@@ -71,124 +74,63 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
+	MetricsReporter metrics_reporter{
+		"individual_distances", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
 	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
 	ifstream student_archive{student_archive_path};
 	ifstream course_archive{course_archive_path};
     StudentContainer students{
         StudentContainer::LoadFromArchive(student_archive)};
 	CourseContainer courses{
         CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
 	students.UpdateCourses(courses);
+	update_timer.Stop();
 
 	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
 	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
 
-	SaveWeightedDistances(
-			student_network,
-			"musical_theatre_weighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"Musical Theatre."; });
-
-	SaveUnweightedDistances(
-			student_network,
-			"musical_theatre_unweighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"Musical Theatre."; });
-
-	SaveWeightedDistances(
-			student_network,
-			"general_studies_weighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"General Studies"; });
-
-
-	SaveUnweightedDistances(
-			student_network,
-			"general_studies_unweighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"General Studies"; });
-
-	SaveWeightedDistances(
-			student_network,
-			"philosophy_weighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"Philosophy"; });
-
-	SaveUnweightedDistances(
-			student_network,
-			"philosophy_unweighted_distances.tsv",
-			[&students](Student::Id id)
-			{ return students.Find(id).GetMajor1Description() ==
-			"Philosophy"; });
-
-	return 0;
-}
+	PhaseTimer distances_timer{"distances"};
 
-/* Gets dijkstra shortest path for a set of vertices to every other (connected)
- * vertex on the graph and writes it to stats_dijkstra.tsv. Applies a filter to
- * determine if it should compute for the given student.
- * FilterFunc should be a function that accepts a student ID and returns a
- * boolean value for whether shortest paths should be found for that student.
- */
-template <typename FilterFunc>
-void SaveWeightedDistances(const StudentNetwork& network,
-						   const string& filename,
-						   FilterFunc filter) {
-	ofstream dijkstra_file{filename};
-	for (auto vertex_d : network.GetVertexDescriptors()) {
-		auto student_id = network[vertex_d];
-
-		// Determine whether or not we should process this student.
-		if (!filter(student_id)) { continue; }
-
-		dijkstra_file << student_id << "\t";
-
-		// weighted distance stats
-		auto weighted_distances = network.FindWeightedDistances(vertex_d);
-
-		// get the second member of the pair
-		auto distance_values = vector<string>{};
-		transform(begin(weighted_distances), end(weighted_distances),
-				back_inserter(distance_values),
-				[](pair<Student::Id, double> elt)
-				{ return to_string(elt.second); });
-		dijkstra_file << join(distance_values, "\t") << endl;
+	// the engine extracts the adjacency once and is shared by every cohort
+	unique_ptr<student_delta_stepping_t> delta_stepping;
+	if (vm.count("delta")) {
+		if (delta <= 0.) {
+			cerr << "--delta must be positive" << endl;
+			return -1;
+		}
+		delta_stepping = make_unique<student_delta_stepping_t>(
+				student_network, delta);
 	}
-}
 
-/* Gets unweighted shortest path for a set of vertices to every other
- * (connected) vertex on the graph and writes it to stats_dijkstra.tsv. Applies
- * a filter to determine if it should compute for the given student. FilterFunc
- * should be a function that accepts a student ID and returns a boolean value
- * for whether shortest paths should be found for that student.
- */
-template <typename FilterFunc>
-void SaveUnweightedDistances(const StudentNetwork& network,
-							 const string& filename,
-							 FilterFunc filter) {
-	ofstream bfs_file{filename};
-	for (auto vertex_d : network.GetVertexDescriptors()) {
-		auto student_id = network[vertex_d];
-
-		// Determine whether or not we should process this student.
-		if (!filter(student_id)) { continue; }
-
-		bfs_file << network[vertex_d] << "\t";
-
-		// unweighted distance stats
-		auto unweighted_distances = network.FindUnweightedDistances(vertex_d);
-
-		// get the second member of the pair
-		auto distance_values = vector<string>{};
-		transform(begin(unweighted_distances), end(unweighted_distances),
-				back_inserter(distance_values),
-				[](pair<Student::Id, double> elt)
-				{ return to_string(elt.second); });
-		bfs_file << join(distance_values, "\t") << endl;
+	// cohort => prefix of the output files
+	const vector<pair<string, string>> cohorts{
+		make_pair("major1:Musical Theatre.", "musical_theatre"),
+		make_pair("major1:General Studies", "general_studies"),
+		make_pair("major1:Philosophy", "philosophy"),
+	};
+
+	for (const auto& cohort : cohorts) {
+		auto filter = ParseCohortFilter(cohort.first);
+
+		ofstream weighted_output{cohort.second + "_weighted_distances.tsv"};
+		SaveWeightedDistances(student_network, students, filter,
+				weighted_output, delta_stepping.get());
+
+		ofstream unweighted_output{cohort.second + "_unweighted_distances.tsv"};
+		SaveUnweightedDistances(
+				student_network, students, filter, unweighted_output);
 	}
+
+	return 0;
 }
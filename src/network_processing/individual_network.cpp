@@ -1,40 +1,40 @@
-#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <boost/program_options.hpp>
 
+#include "analysis_stages.hpp"
 #include "course_container.hpp"
-#include "course_network.hpp"
-#include "mem_usage.hpp"
-#include "reduce_network.hpp"
+#include "metrics.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
-using std::copy_if; using std::for_each;
-using std::begin; using std::end; using std::back_inserter;
 using std::cerr; using std::cout; using std::endl;
-using std::ifstream; using std::ofstream; 
-using std::string; using std::to_string;
+using std::exception;
+using std::ifstream;
+using std::istream_iterator;
+using std::make_pair; using std::pair;
+using std::string;
 using std::vector;
 
 namespace po = boost::program_options;
 
 
-static void SaveIndividualStudentNetwork(const StudentNetwork& network, 
-		StudentNetwork::vertex_t student_d, const string& file_name);
-
-
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Options for saving individual networks:"};
 	string student_archive_path, course_archive_path, 
-		   course_network_archive_path, student_network_archive_path;
+		   course_network_archive_path, student_network_archive_path,
+		   student_ids_path, format,
+		   metrics_path, trace_path;
+	int metrics_period;
 	desc.add_options()
 		("help,h", "Show this help message")
 		("student_network_archive_path",
@@ -45,7 +45,22 @@ int main(int argc, char* argv[]) {
 		 "Set the path at which to find the student file")
 		("course_archive_path", 
 		 po::value<string>(&course_archive_path)->required(),
-		 "Set the path at which to find the enrollment file");
+		 "Set the path at which to find the enrollment file")
+		("student_ids_path", po::value<string>(&student_ids_path),
+		 "Save the networks of the students listed in this file, one ID per "
+		 "line, to output/ego_networks instead of the default cohorts")
+		("format", po::value<string>(&format)->default_value("indexed"),
+		 "\"indexed\" to save all networks to one file with an offset index, "
+		 "\"files\" to save a file per student")
+		("threads,t", po::value<int>(&num_threads)->default_value(1),
+		 "Number of threads used to format the indexed networks")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
 
 	po::variables_map vm;
 
@@ -64,79 +79,92 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
+	if (format != "indexed" && format != "files") {
+		cerr << "format must be indexed or files" << endl;
+		return -1;
+	}
+	if (!student_ids_path.empty() && format != "indexed") {
+		cerr << "student_ids_path requires the indexed format" << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{
+		"individual_network", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
 	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
 	ifstream student_archive{student_archive_path};
 	ifstream course_archive{course_archive_path};
     StudentContainer students{
         StudentContainer::LoadFromArchive(student_archive)};
 	CourseContainer courses{
         CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
 	students.UpdateCourses(courses);
+	update_timer.Stop();
 
 	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
 	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
 
-	vector<Student> musical_theater;
-		copy_if(begin(students), end(students), back_inserter(musical_theater),
-				[](const Student& student) {
-					return student.GetMajor1Description() == 
-						"Musical Theatre."; });
-
-		vector<Student> general_studies;
-		copy_if(begin(students), end(students), back_inserter(musical_theater),
-				[](const Student& student) {
-					return student.GetMajor1Description() == 
-						"General Studies"; });
-
-		vector<Student> philosophy;
-		copy_if(begin(students), end(students), back_inserter(musical_theater),
-				[](const Student& student) {
-					return student.GetMajor1Description() == 
-						"Philosophy"; });
-
-
-		for_each(begin(philosophy), end(philosophy),
-				[&student_network](const Student& student) {
-					SaveIndividualStudentNetwork(
-							student_network, 
-							student_network.GetVertexDescriptor(student.id()), 
-							"output/philosophy_" + to_string(student.id()) + 
-								".tsv"); });
-
-		for_each(begin(general_studies), end(general_studies),
-				[&student_network](const Student& student) {
-					SaveIndividualStudentNetwork(
-							student_network, 
-							student_network.GetVertexDescriptor(student.id()), 
-							"output/general_studies_" + 
-								to_string(student.id()) + ".tsv"); });
-
-		for_each(begin(musical_theater), end(musical_theater),
-				[&student_network](const Student& student) {
-					SaveIndividualStudentNetwork(
-							student_network,
-							student_network.GetVertexDescriptor(student.id()),
-							"output/musical_theatre_" + 
-								to_string(student.id()) + ".tsv"); });
+	PhaseTimer ego_networks_timer{"ego_networks"};
 
-	return 0;
-}
+	// cohort => prefix of the output files
+	const vector<pair<string, string>> cohorts{
+		make_pair("major1:Philosophy", "output/philosophy_"),
+		make_pair("major1:General Studies", "output/general_studies_"),
+		make_pair("major1:Musical Theatre.", "output/musical_theatre_"),
+	};
 
+	try {
+		if (!student_ids_path.empty()) {
+			ifstream student_ids_stream{student_ids_path};
+			if (!student_ids_stream.is_open()) {
+				cerr << "Could not open \"" << student_ids_path << "\"!"
+					 << endl;
+				return -1;
+			}
+			vector<Student::Id> student_ids{
+				istream_iterator<Student::Id>{student_ids_stream},
+				istream_iterator<Student::Id>{}};
+
+			auto data_output = OpenOutputFile("output/ego_networks.tsv");
+			auto index_output = OpenOutputFile("output/ego_networks.index");
+			ReportSavedEdges("output/ego_networks.tsv", SaveEgoNetworks(
+						student_network, FindStudentVertices(
+							student_network, student_ids),
+						data_output, index_output));
+			return 0;
+		}
 
-/* Saves an indidivual student's network to the given file in the form:
- * <connected student 1>\t<edge weight of connected student 1>
- * <connected student 2>\t<edge weight of connected student 2>
- * ...
- * <connected student n>\t<edge weight of connected student n>
- */
-void SaveIndividualStudentNetwork(const StudentNetwork& network, 
-		StudentNetwork::vertex_t student_d, const string& file_name) {
-	ofstream individual_network{file_name};
-	for (const auto& edge_d : network.GetOutEdgeDescriptors(student_d)) {
-		individual_network << network.GetTargetValue(edge_d) << "\t"
-						   << network[edge_d] << endl;
+		for (const auto& cohort : cohorts) {
+			auto filter = ParseCohortFilter(cohort.first);
+			if (format == "files") {
+				SaveIndividualStudentNetworks(
+						student_network, students, filter, cohort.second);
+				continue;
+			}
+
+			auto data_output =
+				OpenOutputFile(cohort.second + "ego_networks.tsv");
+			auto index_output =
+				OpenOutputFile(cohort.second + "ego_networks.index");
+			ReportSavedEdges(cohort.second + "ego_networks.tsv",
+					SaveEgoNetworks(student_network, FindCohortVertices(
+							student_network, students, filter),
+						data_output, index_output));
+		}
+	} catch (exception& e) {
+		cerr << e.what() << endl;
+		return -1;
 	}
-}
-
-
 
+	return 0;
+}
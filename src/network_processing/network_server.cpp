@@ -0,0 +1,134 @@
+#include <csignal>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "analysis_stages.hpp"
+#include "course_container.hpp"
+#include "metrics.hpp"
+#include "query_server.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+#include "utility.hpp"
+
+
+using std::atomic;
+using std::cerr; using std::cout; using std::endl;
+using std::exception;
+using std::ifstream;
+using std::string;
+using std::unique_ptr;
+
+namespace po = boost::program_options;
+
+
+// set by SIGINT and SIGTERM to shut the server down cleanly
+atomic<bool> stop_server{false};
+
+extern "C" void StopServer(int) { stop_server = true; }
+
+
+int main(int argc, char* argv[]) {
+	po::options_description desc{"Serve queries against a loaded network:"};
+	string student_archive_path, course_archive_path,
+		   student_network_archive_path, socket_path,
+		   metrics_path, trace_path;
+	int metrics_period;
+	double delta;
+	desc.add_options()
+		("help,h", "Show this help message")
+		("student_network_archive_path",
+		 po::value<string>(&student_network_archive_path)->required(),
+		 "Set the path at which to find the archive student network")
+		("student_archive_path",
+		 po::value<string>(&student_archive_path)->required(),
+		 "Set the path at which to find the student file")
+		("course_archive_path",
+		 po::value<string>(&course_archive_path)->required(),
+		 "Set the path at which to find the enrollment file")
+		("socket_path", po::value<string>(&socket_path)->required(),
+		 "Set the path of the Unix-domain socket to listen on, see "
+		 "src/query_server.hpp for the protocol")
+		("delta", po::value<double>(&delta),
+		 "Use delta-stepping with this bucket width for weighted distances")
+		("threads,t", po::value<int>(&num_threads)->default_value(1),
+		 "Number of threads to use within each delta-stepping query")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
+
+	po::variables_map vm;
+
+	try {
+		po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 0;
+		}
+		po::notify(vm);
+	} catch (po::required_option& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (po::error& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{
+		"network_server", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
+	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
+	ifstream student_archive{student_archive_path};
+	ifstream course_archive{course_archive_path};
+	StudentContainer students{
+		StudentContainer::LoadFromArchive(student_archive)};
+	CourseContainer courses{
+		CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
+	students.UpdateCourses(courses);
+	update_timer.Stop();
+
+	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
+	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
+
+	PhaseTimer serve_timer{"serve"};
+
+	unique_ptr<student_delta_stepping_t> delta_stepping;
+	try {
+		if (vm.count("delta")) {
+			delta_stepping = make_unique<student_delta_stepping_t>(
+					student_network, delta);
+		}
+
+		std::signal(SIGINT, StopServer);
+		std::signal(SIGTERM, StopServer);
+
+		QueryHandler handler{student_network, students, delta_stepping.get()};
+		cerr << "Serving on " << socket_path << endl;
+		ServeUnixSocket(socket_path, handler, stop_server);
+	} catch (exception& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	return 0;
+}
@@ -1,19 +1,26 @@
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
+#include "analysis_stages.hpp"
 #include "course_container.hpp"
-#include "reduce_network.hpp"
+#include "metrics.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
+#include "student_sample.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
 using std::cerr; using std::cout; using std::endl;
 using std::ifstream; using std::ofstream;
-using std::string; using std::to_string;
+using std::string;
+using std::vector;
 
 namespace po = boost::program_options;
 
@@ -21,7 +28,10 @@ namespace po = boost::program_options;
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Options for reducing network:"};
 	string student_archive_path, course_archive_path,
-		   course_network_archive_path, student_network_archive_path;
+		   course_network_archive_path, student_network_archive_path,
+		   metrics_path, trace_path;
+	int metrics_period;
+	SampleOptions sample_options;
 	desc.add_options()
 		("help,h", "Show this help message")
 		("student_network_archive_path",
@@ -32,7 +42,25 @@ int main(int argc, char* argv[]) {
 		 "Set the path at which to find the student file")
 		("course_archive_path",
 		 po::value<string>(&course_archive_path)->required(),
-		 "Set the path at which to find the enrollment file");
+		 "Set the path at which to find the enrollment file")
+		("threads,t", po::value<int>(&num_threads)->default_value(1),
+		 "Number of threads to use to reduce the network")
+		("sample_rate",
+		 po::value<double>(&sample_options.rate)->default_value(1.),
+		 "The network is that of build's sample of this fraction of the "
+		 "students, estimate the reductions of the whole network from it")
+		("sample_seed", po::value<std::uint64_t>(
+			&sample_options.seed)->default_value(0),
+		 "Seed build sampled the students with")
+		("stratify_by", po::value<string>(&sample_options.stratify_by),
+		 "What build stratified the sample by, if anything")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
 
 	po::variables_map vm;
 
@@ -51,66 +79,69 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
+	MetricsReporter metrics_reporter{
+		"reduce_network", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
 	// read students and enrollment data
+	PhaseTimer load_timer{"load_archives"};
 	ifstream student_archive{student_archive_path};
 	ifstream course_archive{course_archive_path};
     StudentContainer students{
         StudentContainer::LoadFromArchive(student_archive)};
 	CourseContainer courses{
         CourseContainer::LoadFromArchive(course_archive)};
+	AddToCounter("bytes_read", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
+	load_timer.Stop();
+
+	PhaseTimer update_timer{"update_courses"};
 	students.UpdateCourses(courses);
+	update_timer.Stop();
 
 	ifstream student_network_archive{student_network_archive_path};
+	PhaseTimer network_timer{"load_network"};
 	StudentNetwork student_network{student_network_archive};
+	AddToCounter("bytes_read", GetFileSize(student_network_archive_path));
+	network_timer.Stop();
+
+	PhaseTimer reduce_timer{"reduce"};
+
+	vector<ReductionOutput> reductions{
+			{"major1", EdgeAggregate_e::Sum,
+				"output/network_major1_weighted.tsv"},
+			{"major1", EdgeAggregate_e::Count,
+				"output/network_major1_unweighted.tsv"},
+			{"school", EdgeAggregate_e::Sum,
+				"output/network_school_weighted.tsv"},
+			{"school", EdgeAggregate_e::Count,
+				"output/network_school_unweighted.tsv"},
+			{"ethnicity", EdgeAggregate_e::Sum,
+				"output/network_ethnicity_weighted.tsv"},
+			{"ethnicity", EdgeAggregate_e::Count,
+				"output/network_ethnicity_unweighted.tsv"}};
+
+	// every reduction is computed in a single pass over the edges
+	if (!sample_options.IsSampling()) {
+		SaveReductions(student_network, students, reductions);
+		return 0;
+	}
 
-	auto weighted_func = [](double edge, double current_edge)
-				{ return edge + current_edge; };
-	auto unweighted_func = [](double, int current_edge)
-				{ return 1 + current_edge; };
-
-	// major
-	auto major1_func = [&students](const Student::Id& id)
-		{ return students.Find(id).GetMajor1Description(); };
-
-	auto major1_weighted_reduced_network = ReduceNetwork(
-			student_network, major1_func, weighted_func, 0.);
-	ofstream major1_weighted_output{"output/network_major1_weighted.tsv"};
-	major1_weighted_reduced_network.SaveEdgewise(major1_weighted_output);
-
-	auto major1_unweighted_reduced_network = ReduceNetwork(
-			student_network, major1_func, unweighted_func, 0);
-	ofstream major1_unweighted_output{"output/network_major1_unweighted.tsv"};
-	major1_unweighted_reduced_network.SaveEdgewise(major1_unweighted_output);
-
-	// school
-	auto school_func = [&students](const Student::Id& id)
-		{ return students.Find(id).school(); };
-
-	auto school_weighted_student_network = ReduceNetwork(
-			student_network, school_func, weighted_func, 0.);
-	ofstream school_weighted_output{"output/network_school_weighted.tsv"};
-	school_weighted_student_network.SaveEdgewise(school_weighted_output);
-
-	auto school_unweighted_student_network = ReduceNetwork(
-			student_network, school_func, unweighted_func, 0);
-	ofstream school_unweighted_output{"output/network_school_unweighted.tsv"};
-	school_unweighted_student_network.SaveEdgewise(school_unweighted_output);
-
-	// ethnicity
-	auto ethnicity_func = [&students](const Student::Id& id)
-		{ return students.Find(id).ethnicity(); };
-
-	auto ethnicity_weighted_student_network = ReduceNetwork(
-			student_network, ethnicity_func, weighted_func, 0.);
-	ofstream ethnicity_weighted_output{"output/network_ethnicity_weighted.tsv"};
-	ethnicity_weighted_student_network.SaveEdgewise(ethnicity_weighted_output);
-
-	auto ethnicity_unweighted_student_network = ReduceNetwork(
-			student_network, ethnicity_func, unweighted_func, 0.);
-	ofstream ethnicity_unweighted_output{
-		"output/network_ethnicity_unweighted.tsv"};
-	ethnicity_unweighted_student_network.SaveEdgewise(
-			ethnicity_unweighted_output);
+	// the sample is drawn again from every student, as build drew it
+	try {
+		StudentSample sample{students, sample_options};
+		for (const auto& reduction : reductions) {
+			auto output = OpenOutputFile(reduction.output_path);
+			SaveReductionEstimate(student_network, students, sample,
+					reduction, output);
+		}
+	} catch (InvalidSample& e) {
+		cerr << e.what() << endl;
+		return -1;
+	} catch (std::invalid_argument& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
 
 	return 0;
 }
@@ -0,0 +1,236 @@
+#include "network_shard.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+
+
+using std::begin; using std::end;
+using std::endl;
+using std::istream; using std::ostream;
+using std::istringstream; using std::ostringstream;
+using std::string; using std::to_string;
+using std::unordered_map;
+using std::vector;
+
+
+// Number of pairs in the rows before the given row.
+static long PairsBeforeRow(long num_students, long row)
+{ return row * (num_students - 1) - row * (row - 1) / 2; }
+
+
+ShardRows GetShardRows(long num_students, int shard, int num_shards)
+{ return SplitShardRows(num_students, {0, num_students}, shard, num_shards); }
+
+
+ShardRows SplitShardRows(
+		long num_students, ShardRows rows, int block, int num_blocks) {
+	// the first row of a block is the first whose pairs reach its share
+	auto pairs_before = [num_students, rows](long row) {
+		return PairsBeforeRow(num_students, row) -
+			PairsBeforeRow(num_students, rows.first_row);
+	};
+	auto first_row_of = [&](int index) {
+		if (index == num_blocks) { return rows.last_row; }
+		long total_pairs{pairs_before(rows.last_row)};
+		long low{rows.first_row}, high{rows.last_row};
+		while (low < high) {
+			auto middle = low + (high - low) / 2;
+			if (pairs_before(middle) * num_blocks < total_pairs * index) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		return low;
+	};
+	return {first_row_of(block), first_row_of(block + 1)};
+}
+
+
+string GetStudentsFingerprint(const StudentContainer& students) {
+	std::uint64_t fingerprint{0};
+	for (const auto& student : students) {
+		fingerprint = fingerprint * 1099511628211ull ^
+			std::hash<Student::Id>{}(student.id());
+	}
+	ostringstream output;
+	output << std::hex << std::setw(16) << std::setfill('0') << fingerprint;
+	return output.str();
+}
+
+
+EdgeChecksum NetworkShard::GetChecksum() const {
+	EdgeChecksum checksum;
+	for (const auto& edge : edges)
+	{ checksum.AddEdge(edge.student1, edge.student2, edge.weight); }
+	return checksum;
+}
+
+
+void NetworkShard::Save(ostream& output) const {
+	TRACE_SCOPE("save_shard");
+	output << "shard\t" << label << '\t' << shard << '\t' << num_shards << '\t'
+		   << num_students << '\t' << students_fingerprint << '\t'
+		   << rows.first_row << '\t' << rows.last_row << '\n';
+
+	// weights are written exactly so merging gives the unsharded network
+	auto precision =
+		output.precision(std::numeric_limits<double>::max_digits10);
+	for (const auto& edge : edges) {
+		output << edge.student1 << '\t' << edge.student2 << '\t' << edge.weight
+			   << '\n';
+	}
+	output.precision(precision);
+
+	output << "end\t" << edges.size() << '\t' << GetChecksum().ToString()
+		   << endl;
+}
+
+
+NetworkShard NetworkShard::Load(istream& input) {
+	TRACE_SCOPE("load_shard");
+	NetworkShard network_shard;
+	string line, keyword;
+	if (!getline(input, line)) { throw InvalidShard{"The shard is empty!"}; }
+	istringstream header{line};
+	header >> keyword >> network_shard.label >> network_shard.shard
+		   >> network_shard.num_shards >> network_shard.num_students
+		   >> network_shard.students_fingerprint
+		   >> network_shard.rows.first_row >> network_shard.rows.last_row;
+	if (!header || keyword != "shard")
+	{ throw InvalidShard{"Bad shard header: " + line}; }
+
+	auto name = "Shard " + to_string(network_shard.shard) + " of " +
+		to_string(network_shard.num_shards);
+	while (getline(input, line)) {
+		istringstream fields{line};
+		if (line.compare(0, 4, "end\t") == 0) {
+			long num_edges;
+			string checksum;
+			fields >> keyword >> num_edges >> checksum;
+			if (num_edges != static_cast<long>(network_shard.edges.size())) {
+				throw InvalidShard{name + " has " +
+					to_string(network_shard.edges.size()) + " edges but " +
+					"should have " + to_string(num_edges) + "!"};
+			}
+			if (checksum != network_shard.GetChecksum().ToString()) {
+				throw InvalidShard{name + " doesn't match its checksum!"};
+			}
+			return network_shard;
+		}
+
+		ShardEdge edge;
+		fields >> edge.student1 >> edge.student2 >> edge.weight;
+		if (!fields) { throw InvalidShard{name + " has a bad edge: " + line}; }
+		network_shard.edges.push_back(edge);
+	}
+	throw InvalidShard{name + " is truncated!"};
+}
+
+
+StudentNetwork MergeShards(const StudentContainer& students,
+						   const vector<NetworkShard>& shards) {
+	TRACE_SCOPE("merge_shards");
+	if (shards.empty()) { throw InvalidShard{"There are no shards to merge!"}; }
+
+	// every shard must be there once and cover the rows it should
+	const auto& label = shards.front().label;
+	auto num_shards = shards.front().num_shards;
+	long num_students{static_cast<long>(students.size())};
+	auto students_fingerprint = GetStudentsFingerprint(students);
+	vector<const NetworkShard*> shards_by_index(num_shards, nullptr);
+	for (const auto& network_shard : shards) {
+		auto name = "Shard " + to_string(network_shard.shard) + " of " +
+			to_string(network_shard.num_shards);
+		if (network_shard.label != label) {
+			throw InvalidShard{name + " is from the build \"" +
+				network_shard.label + "\", not \"" + label + "\"!"};
+		}
+		if (network_shard.num_shards != num_shards) {
+			throw InvalidShard{name + " is from a build of " +
+				to_string(num_shards) + " shards!"};
+		}
+		if (network_shard.num_students != num_students) {
+			throw InvalidShard{name + " was built from " +
+				to_string(network_shard.num_students) + " students, not " +
+				to_string(num_students) + "!"};
+		}
+		if (network_shard.students_fingerprint != students_fingerprint)
+		{ throw InvalidShard{name + " was built from other students!"}; }
+		if (network_shard.shard < 0 || network_shard.shard >= num_shards)
+		{ throw InvalidShard{name + " doesn't exist!"}; }
+		if (shards_by_index[network_shard.shard])
+		{ throw InvalidShard{name + " is given twice!"}; }
+		if (!(network_shard.rows == GetShardRows(
+						num_students, network_shard.shard, num_shards)))
+		{ throw InvalidShard{name + " covers the wrong rows!"}; }
+		shards_by_index[network_shard.shard] = &network_shard;
+	}
+	for (int i{0}; i < num_shards; ++i) {
+		if (!shards_by_index[i]) {
+			throw InvalidShard{"Shard " + to_string(i) + " of " +
+				to_string(num_shards) + " is missing!"};
+		}
+	}
+
+	// the vertices are in the order of the students, like an unsharded build
+	StudentNetwork network{students.size()};
+	unordered_map<Student::Id, long> rows;
+	long row{0};
+	auto vertex_value_it = network.GetVertexValues().begin();
+	for (const auto& student : students) {
+		rows[student.id()] = row++;
+		*vertex_value_it = student.id();
+		++vertex_value_it;
+	}
+
+	auto vertex_it = begin(network.GetVertexDescriptors());
+	EdgeChecksum checksum;
+	for (const auto& network_shard : shards) {
+		auto name = "Shard " + to_string(network_shard.shard);
+		for (const auto& edge : network_shard.edges) {
+			auto row1_it = rows.find(edge.student1);
+			auto row2_it = rows.find(edge.student2);
+			if (row1_it == end(rows) || row2_it == end(rows)) {
+				throw InvalidShard{name + " has an edge of unknown students " +
+					to_string(edge.student1) + " and " +
+					to_string(edge.student2) + "!"};
+			}
+
+			auto edge_row = std::min(row1_it->second, row2_it->second);
+			if (row1_it->second == row2_it->second ||
+					edge_row < network_shard.rows.first_row ||
+					edge_row >= network_shard.rows.last_row) {
+				throw InvalidShard{name + " has an edge outside its rows!"};
+			}
+
+			auto vertex1 = vertex_it[row1_it->second];
+			auto vertex2 = vertex_it[row2_it->second];
+			if (network.GetEdgeDescriptor(vertex1, vertex2)) {
+				throw InvalidShard{name + " repeats the edge of " +
+					to_string(edge.student1) + " and " +
+					to_string(edge.student2) + "!"};
+			}
+			network(vertex1, vertex2) = edge.weight;
+		}
+		checksum.Combine(network_shard.GetChecksum());
+	}
+
+	AddToCounter("edges_merged", checksum.num_edges());
+	SetLabel("edge_checksum", checksum.ToString());
+	return network;
+}
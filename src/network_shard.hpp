@@ -0,0 +1,102 @@
+#ifndef NETWORK_SHARD_H
+#define NETWORK_SHARD_H
+
+#include <exception>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "edge_checksum.hpp"
+#include "student.hpp"
+
+
+class StudentContainer;
+class StudentNetwork;
+
+
+// A sharded build splits the pairs of students between independent runs of
+// build, e.g. the tasks of a job array. Students are numbered by their order
+// in the student archive and every shard gets a block of consecutive rows,
+// where row i holds the pairs of student i with every later student. Rows get
+// shorter towards the end, so the blocks are sized to hold about the same
+// number of pairs rather than the same number of rows.
+struct ShardRows {
+	long first_row, last_row;  // last_row is one past the block
+
+	bool operator==(const ShardRows& other) const
+	{ return first_row == other.first_row && last_row == other.last_row; }
+};
+
+// Returns the rows of the given shard of num_students students.
+ShardRows GetShardRows(long num_students, int shard, int num_shards);
+
+// Splits rows into num_blocks blocks the same way, returning the given one.
+ShardRows SplitShardRows(
+		long num_students, ShardRows rows, int block, int num_blocks);
+
+// Hashes the IDs of the students in order, so shards and checkpoints of other
+// students, or of the same students in another order, are told apart.
+std::string GetStudentsFingerprint(const StudentContainer& students);
+
+// An edge found in a row, between the row's student and the student at the
+// column.
+struct RowEdge {
+	long column;
+	double weight;
+};
+
+using RowEdges = std::vector<RowEdge>;
+
+
+struct ShardEdge {
+	Student::Id student1, student2;
+	double weight;
+};
+
+
+// The edges found by one shard. Saved as a tab separated file of the form
+//     shard	<label>	<shard>	<num_shards>	<num_students>	<fingerprint>
+//         <first_row>	<last_row>
+//     <student1>	<student2>	<weight>
+//     ...
+//     end	<num_edges>	<edge checksum>
+// where the header is one line. The label tells builds apart, like a
+// checkpoint's, the fingerprint is of the students (GetStudentsFingerprint),
+// and the trailing line tells a complete file from a truncated one.
+struct NetworkShard {
+	std::string label;
+	int shard, num_shards;
+	long num_students;
+	std::string students_fingerprint;
+	ShardRows rows;
+	std::vector<ShardEdge> edges;
+
+	EdgeChecksum GetChecksum() const;
+
+	void Save(std::ostream& output) const;
+
+	// Throws InvalidShard if the file is malformed, truncated or its edges
+	// don't match the checksum it was saved with.
+	static NetworkShard Load(std::istream& input);
+};
+
+
+// Merges the shards built from the given students into one network after
+// checking they are exactly the shards 0 to num_shards - 1 of one build of
+// these students, with the same label and students fingerprint, and that
+// every edge lies in the rows of its shard. Throws InvalidShard otherwise.
+StudentNetwork MergeShards(const StudentContainer& students,
+						   const std::vector<NetworkShard>& shards);
+
+
+class InvalidShard : public std::exception {
+ public:
+	InvalidShard(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // NETWORK_SHARD_H
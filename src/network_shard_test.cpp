@@ -0,0 +1,195 @@
+#include "network_shard.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "edge_checksum.hpp"
+#include "student.hpp"
+#include "student_container_mock.hpp"
+#include "student_network.hpp"
+
+
+using std::stringstream;
+using std::vector;
+
+using ::testing::NiceMock;
+using ::testing::Return;
+
+
+TEST(GetShardRowsTest, CoverEveryRow) {
+	for (long num_students : {0, 1, 2, 7, 100, 1001}) {
+		long total_pairs{num_students * (num_students - 1) / 2};
+		for (int num_shards : {1, 2, 3, 8, 16}) {
+			long next_row{0};
+			for (int shard{0}; shard < num_shards; ++shard) {
+				auto rows = GetShardRows(num_students, shard, num_shards);
+				EXPECT_EQ(next_row, rows.first_row);
+				EXPECT_LE(rows.first_row, rows.last_row);
+				next_row = rows.last_row;
+
+				// a shard is at most a row away from an even share
+				long num_pairs{0};
+				for (auto row = rows.first_row; row < rows.last_row; ++row)
+				{ num_pairs += num_students - 1 - row; }
+				EXPECT_LE(num_pairs, total_pairs / num_shards + num_students);
+			}
+			EXPECT_EQ(num_students, next_row);
+		}
+	}
+}
+
+
+TEST(GetShardRowsTest, SplitShardRows) {
+	// the blocks of a shard cover it, the shard is as if split from the start
+	auto rows = GetShardRows(1001, 1, 3);
+	long next_row{rows.first_row};
+	for (int block{0}; block < 4; ++block) {
+		auto block_rows = SplitShardRows(1001, rows, block, 4);
+		EXPECT_EQ(next_row, block_rows.first_row);
+		next_row = block_rows.last_row;
+	}
+	EXPECT_EQ(rows.last_row, next_row);
+	EXPECT_EQ(GetShardRows(1001, 2, 3),
+			  SplitShardRows(1001, ShardRows{0, 1001}, 2, 3));
+}
+
+
+class NetworkShardTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		students.Insert({Student{1}, Student{2}, Student{3}, Student{4}});
+		ON_CALL(students, size()).WillByDefault(Return(4));
+
+		// shard 0 is the first student's row, shard 1 the rest
+		auto fingerprint = GetStudentsFingerprint(students);
+		shard0 = NetworkShard{"test", 0, 2, 4, fingerprint,
+			GetShardRows(4, 0, 2), {{1, 2, 0.1 + 0.2}, {1, 4, 2.}}};
+		shard1 = NetworkShard{"test", 1, 2, 4, fingerprint,
+			GetShardRows(4, 1, 2), {{2, 3, 1.}, {3, 4, 0.5}}};
+	}
+
+	static NetworkShard SaveAndLoad(const NetworkShard& network_shard) {
+		stringstream stream;
+		network_shard.Save(stream);
+		return NetworkShard::Load(stream);
+	}
+
+ protected:
+	NiceMock<MockStudentContainer> students;
+	NetworkShard shard0, shard1;
+};
+
+
+TEST_F(NetworkShardTest, SaveAndLoad) {
+	auto loaded = SaveAndLoad(shard0);
+	EXPECT_EQ(shard0.label, loaded.label);
+	EXPECT_EQ(shard0.shard, loaded.shard);
+	EXPECT_EQ(shard0.num_shards, loaded.num_shards);
+	EXPECT_EQ(shard0.num_students, loaded.num_students);
+	EXPECT_EQ(shard0.students_fingerprint, loaded.students_fingerprint);
+	EXPECT_EQ(shard0.rows, loaded.rows);
+	ASSERT_EQ(2u, loaded.edges.size());
+	EXPECT_EQ(1, loaded.edges[0].student1);
+	EXPECT_EQ(2, loaded.edges[0].student2);
+	// weights survive exactly
+	EXPECT_EQ(0.1 + 0.2, loaded.edges[0].weight);
+	EXPECT_EQ(shard0.GetChecksum(), loaded.GetChecksum());
+}
+
+
+TEST_F(NetworkShardTest, LoadInvalid) {
+	stringstream saved;
+	shard0.Save(saved);
+	auto contents = saved.str();
+
+	// missing the trailing line
+	stringstream truncated{contents.substr(0, contents.rfind("end"))};
+	EXPECT_THROW(NetworkShard::Load(truncated), InvalidShard);
+
+	// an edge changed after it was saved
+	auto changed_contents = contents;
+	changed_contents.replace(changed_contents.find("\n1\t2\t"), 4, "\n1\t3");
+	stringstream changed{changed_contents};
+	EXPECT_THROW(NetworkShard::Load(changed), InvalidShard);
+
+	stringstream bad_header{"student\t0\t2\n"};
+	EXPECT_THROW(NetworkShard::Load(bad_header), InvalidShard);
+
+	stringstream empty;
+	EXPECT_THROW(NetworkShard::Load(empty), InvalidShard);
+}
+
+
+TEST_F(NetworkShardTest, MergeShards) {
+	// shards may come in any order
+	auto network = MergeShards(students, {SaveAndLoad(shard1), shard0});
+	EXPECT_EQ(4u, network.GetVertexDescriptors().size());
+	EXPECT_EQ(4u, network.GetEdgeDescriptors().size());
+
+	auto student1_d = network.GetVertexDescriptor(1);
+	auto student2_d = network.GetVertexDescriptor(2);
+	auto student3_d = network.GetVertexDescriptor(3);
+	auto student4_d = network.GetVertexDescriptor(4);
+	EXPECT_EQ(0.1 + 0.2, network.Get(student2_d, student1_d));
+	EXPECT_DOUBLE_EQ(2., network.Get(student1_d, student4_d));
+	EXPECT_DOUBLE_EQ(1., network.Get(student2_d, student3_d));
+	EXPECT_DOUBLE_EQ(0.5, network.Get(student3_d, student4_d));
+	EXPECT_THROW(network.Get(student1_d, student3_d), NoEdgeException);
+
+	auto checksum = shard0.GetChecksum();
+	checksum.Combine(shard1.GetChecksum());
+	EXPECT_EQ(checksum, ComputeEdgeChecksum(network));
+}
+
+
+TEST_F(NetworkShardTest, MergeInvalidShards) {
+	EXPECT_THROW(MergeShards(students, {}), InvalidShard);
+	EXPECT_THROW(MergeShards(students, {shard0}), InvalidShard);
+	EXPECT_THROW(MergeShards(students, {shard0, shard0}), InvalidShard);
+
+	auto other_students = shard1;
+	other_students.num_students = 5;
+	EXPECT_THROW(MergeShards(students, {shard0, other_students}),
+			InvalidShard);
+
+	// as many students, but not the same ones
+	NiceMock<MockStudentContainer> different_students;
+	different_students.Insert(
+			{Student{1}, Student{2}, Student{3}, Student{5}});
+	auto other_fingerprint = shard1;
+	other_fingerprint.students_fingerprint =
+		GetStudentsFingerprint(different_students);
+	EXPECT_THROW(MergeShards(students, {shard0, other_fingerprint}),
+			InvalidShard);
+
+	// e.g. another weighting function or filter
+	auto other_label = shard1;
+	other_label.label = "other";
+	EXPECT_THROW(MergeShards(students, {shard0, other_label}), InvalidShard);
+
+	auto other_count = shard1;
+	other_count.num_shards = 3;
+	EXPECT_THROW(MergeShards(students, {shard0, other_count}), InvalidShard);
+
+	auto wrong_rows = shard1;
+	wrong_rows.rows.first_row = 2;
+	EXPECT_THROW(MergeShards(students, {shard0, wrong_rows}), InvalidShard);
+
+	// the edge of 1 and 3 belongs in shard 0's row
+	auto outside_rows = shard1;
+	outside_rows.edges.push_back({3, 1, 1.});
+	EXPECT_THROW(MergeShards(students, {shard0, outside_rows}), InvalidShard);
+
+	auto unknown_student = shard1;
+	unknown_student.edges.push_back({2, 5, 1.});
+	EXPECT_THROW(MergeShards(students, {shard0, unknown_student}),
+			InvalidShard);
+
+	auto repeated_edge = shard1;
+	repeated_edge.edges.push_back({3, 2, 1.});
+	EXPECT_THROW(MergeShards(students, {shard0, repeated_edge}), InvalidShard);
+}
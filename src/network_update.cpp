@@ -0,0 +1,223 @@
+#include "network_update.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "co_enrollment.hpp"
+#include "course.hpp"
+#include "course_network.hpp"
+#include "edge_checksum.hpp"
+#include "graph_builder.hpp"
+#include "metrics.hpp"
+#include "network_shard.hpp"
+#include "progress.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+#include "utility.hpp"
+
+
+using std::begin; using std::end;
+using std::cerr;
+using std::set;
+using std::string; using std::to_string;
+using std::thread;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+using boost::optional;
+
+using weighting_func_ptr = optional<double>(*)(const Student&, const Student&);
+
+
+StudentNetwork UpdateStudentNetwork(const StudentNetwork& network,
+		const StudentContainer& students, weighting_func_ptr weighting_func,
+		int new_term, const EdgeFilter& filter) {
+	TRACE_SCOPE("update_student_network");
+	if (filter.top_k > 0)
+	{ throw InvalidUpdate{"The top_k of a network can't be updated!"}; }
+
+	// the vertices are in the order of the students, like a build
+	long num_students{static_cast<long>(students.size())};
+	StudentNetwork updated{students.size()};
+	unordered_map<Student::Id, long> rows;
+	long row{0};
+	auto vertex_value_it = updated.GetVertexValues().begin();
+	for (const auto& student : students) {
+		rows[student.id()] = row++;
+		*vertex_value_it++ = student.id();
+	}
+
+	// every edge is copied, the new term only adds to them
+	auto vertex_it = begin(updated.GetVertexDescriptors());
+	for (const auto& student : network.GetVertexValues()) {
+		if (!rows.count(student)) {
+			throw InvalidUpdate{"Student " + to_string(student) + " of the "
+				"network isn't one of the students!"};
+		}
+	}
+	for (const auto& edge_d : network.GetEdgeDescriptors()) {
+		updated(vertex_it[rows.at(network.GetSourceValue(edge_d))],
+				vertex_it[rows.at(network.GetTargetValue(edge_d))]) =
+			network[edge_d];
+	}
+
+	// the pairs sharing a course of the new term are found from the
+	// enrollments of its courses, each in the row of its first student
+	set<const Course*> course_set;
+	for (const auto& student : students) {
+		for (const auto& course : student.courses_taken())
+		{ if (course->term() == new_term) { course_set.insert(course); } }
+	}
+	if (course_set.empty()) {
+		throw InvalidUpdate{"No student took a course of term " +
+			to_string(new_term) + "!"};
+	}
+	auto row_columns = FindCoEnrolledPairs(
+			{begin(course_set), end(course_set)}, rows, num_students);
+	vector<long> new_term_rows;
+	for (row = 0; row < num_students; ++row)
+	{ if (!row_columns[row].empty()) { new_term_rows.push_back(row); } }
+	auto student_it = begin(students);
+
+	long total_pairs{0};
+	for (auto new_term_row : new_term_rows)
+	{ total_pairs += row_columns[new_term_row].size(); }
+	ProgressCounters progress{num_threads};
+	ProgressReporter progress_reporter{
+		progress, total_pairs, "pairs", progress_period, cerr};
+
+	// the workers claim rows and keep their edges apart, so the network is
+	// updated in the same order whatever the threads did
+	vector<RowEdges> row_edges(num_students);
+	std::atomic<std::size_t> next_row{0};
+	auto weigh_rows = [&](int worker) {
+		long num_pairs{0}, num_filtered{0}, total_edges{0};
+		for (auto index = next_row++; index < new_term_rows.size();
+				index = next_row++) {
+			auto row = new_term_rows[index];
+			const Student& student1(student_it[row]);
+			for (auto column : row_columns[row]) {
+				TRACE_SCOPE("evaluate_pair");
+				const Student& student2(student_it[column]);
+				auto connection = filter.KeepPair(student1, student2) ?
+					weighting_func(student1, student2) : boost::none;
+				if (connection && !filter.KeepWeight(connection.value())) {
+					++num_filtered;
+				} else if (connection) {
+					row_edges[row].push_back({column, connection.value()});
+					++total_edges;
+				}
+				progress.Update(worker, ++num_pairs, total_edges);
+			}
+		}
+		AddToCounter("pairs_evaluated", num_pairs);
+		AddToCounter("edges_filtered", num_filtered);
+	};
+
+	vector<std::exception_ptr> errors(num_threads);
+	vector<thread> thread_pool;
+	for (int i{0}; i < num_threads; ++i) {
+		thread_pool.emplace_back([&, i] {
+			try { weigh_rows(i); }
+			catch (...) { errors[i] = std::current_exception(); }
+		});
+	}
+	for_each(begin(thread_pool), end(thread_pool),
+			std::bind(&thread::join, std::placeholders::_1));
+	progress_reporter.Stop();
+	for (const auto& error : errors)
+	{ if (error) { std::rethrow_exception(error); } }
+
+	TRACE_SCOPE("apply_update");
+	long num_added{0}, num_updated{0};
+	for (auto new_term_row : new_term_rows) {
+		for (const auto& edge : row_edges[new_term_row]) {
+			auto vertex1 = vertex_it[new_term_row];
+			auto vertex2 = vertex_it[edge.column];
+			if (updated.GetEdgeDescriptor(vertex1, vertex2)) {
+				++num_updated;
+			} else {
+				++num_added;
+			}
+			updated(vertex1, vertex2) = edge.weight;
+		}
+	}
+	AddToCounter("edges_added", num_added);
+	AddToCounter("edges_updated", num_updated);
+	SetLabel("edge_checksum", ComputeEdgeChecksum(updated).ToString());
+	return updated;
+}
+
+
+CourseNetwork UpdateCourseNetwork(const CourseNetwork& network,
+								  const StudentContainer& students,
+								  int new_term) {
+	TRACE_SCOPE("update_course_network");
+	// the new courses are those taken in the new term, which no course of the
+	// network may be of
+	unordered_set<Course::Id, Course::Id::Hasher> courses;
+	for (const auto& course : network.GetVertexValues()) {
+		if (course.term == new_term) {
+			throw InvalidUpdate{"The network already has courses of term " +
+				to_string(new_term) + "!"};
+		}
+		courses.insert(course);
+	}
+	vector<vector<Course::Id>> student_courses;
+	for (const auto& student : students) {
+		unordered_set<Course::Id, Course::Id::Hasher> taken;
+		bool took_new_term{false};
+		for (const auto& course : student.courses_taken()) {
+			taken.insert(course->GetId());
+			took_new_term |= course->term() == new_term;
+		}
+		if (!took_new_term) { continue; }
+		courses.insert(begin(taken), end(taken));
+		student_courses.emplace_back(begin(taken), end(taken));
+	}
+	if (student_courses.empty()) {
+		throw InvalidUpdate{"No student took a course of term " +
+			to_string(new_term) + "!"};
+	}
+
+	CourseNetwork updated{begin(courses), end(courses)};
+	for (const auto& edge_d : network.GetEdgeDescriptors()) {
+		updated(updated.GetVertex(network.GetSourceValue(edge_d)),
+				updated.GetVertex(network.GetTargetValue(edge_d))) =
+			network[edge_d];
+	}
+
+	// a student counts once for every pair of their courses, only those with
+	// a course of the new term are new
+	long num_pairs{0};
+	for (const auto& taken : student_courses) {
+		for (auto it = begin(taken); it != end(taken); ++it) {
+			for (auto it2 = std::next(it); it2 != end(taken); ++it2) {
+				if (it->term != new_term && it2->term != new_term) { continue; }
+				++updated(updated.GetVertex(*it), updated.GetVertex(*it2), 0);
+				++num_pairs;
+			}
+		}
+	}
+
+	AddToCounter("pairs_evaluated", num_pairs);
+	SetLabel("edge_checksum", ComputeEdgeChecksum(
+				updated, Course::Id::Hasher{}).ToString());
+	return updated;
+}
@@ -0,0 +1,58 @@
+#ifndef NETWORK_UPDATE_H
+#define NETWORK_UPDATE_H
+
+#include <exception>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "edge_filter.hpp"
+
+
+class CourseNetwork;
+class Student;
+class StudentContainer;
+class StudentNetwork;
+
+// Updates of networks built before the enrollments of a new term were added.
+// Courses are of a single term, so the courses of the new term are new and
+// the enrollments of every earlier course are unchanged. Only pairs sharing a
+// course of the new term change: they gain edges or weight, and every other
+// edge is copied as it was. The students and courses given must be the whole
+// updated ones, and the network must have been built from the same students
+// without the new term's enrollments. Throws InvalidUpdate otherwise, where
+// it can tell.
+
+
+// Updates a student network built with the given weighting function and
+// filter. Students who first enroll in the new term get vertices, in the
+// order of the students like a build. The weights of the pairs sharing a
+// course of the new term are recomputed from all their courses, so they sum
+// them like a full rebuild does rather than adding to the old weight. The
+// top k of every student changes with the new edges, so it can't be kept.
+// The pairs are found from the enrollments of the new term's courses (see
+// co_enrollment.hpp).
+StudentNetwork UpdateStudentNetwork(
+		const StudentNetwork& network, const StudentContainer& students,
+		boost::optional<double>(*weighting_func)(
+			const Student&, const Student&),
+		int new_term, const EdgeFilter& filter = EdgeFilter{});
+
+// Updates a course network, adding the courses of the new term and counting
+// the students who took a course of the new term and another course.
+CourseNetwork UpdateCourseNetwork(const CourseNetwork& network,
+								  const StudentContainer& students,
+								  int new_term);
+
+
+class InvalidUpdate : public std::exception {
+ public:
+	InvalidUpdate(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // NETWORK_UPDATE_H
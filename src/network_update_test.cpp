@@ -0,0 +1,130 @@
+#include "network_update.hpp"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "course.hpp"
+#include "course_network.hpp"
+#include "edge_checksum.hpp"
+#include "edge_filter.hpp"
+#include "graph_builder.hpp"
+#include "student.hpp"
+#include "student_container_mock.hpp"
+#include "student_network.hpp"
+#include "weighting_function.hpp"
+
+
+using std::vector;
+
+using ::testing::Const;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+
+class NetworkUpdateTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		// students 1 to 3 took courses of 201403 and 201405, 2 and 3 take a
+		// course together in 201407 and 4 enrolls for the first time with 2
+		for (auto id : {1, 2, 3}) { course1.AddStudentEnrolled(id); }
+		for (auto id : {1, 2}) { course2.AddStudentEnrolled(id); }
+		for (auto id : {2, 3, 4}) { course3.AddStudentEnrolled(id); }
+		for (auto id : {2, 4}) { course4.AddStudentEnrolled(id); }
+
+		old_student1.AddCoursesTaken({&course1, &course2});
+		old_student2.AddCoursesTaken({&course1, &course2});
+		old_student3.AddCourseTaken(&course1);
+		old_students.Insert({old_student1, old_student2, old_student3});
+		ON_CALL(old_students, size()).WillByDefault(Return(3));
+		ON_CALL(Const(old_students), Find(1))
+			.WillByDefault(ReturnRef(old_student1));
+		ON_CALL(Const(old_students), Find(2))
+			.WillByDefault(ReturnRef(old_student2));
+		ON_CALL(Const(old_students), Find(3))
+			.WillByDefault(ReturnRef(old_student3));
+
+		student1.AddCoursesTaken({&course1, &course2});
+		student2.AddCoursesTaken({&course1, &course2, &course3, &course4});
+		student3.AddCoursesTaken({&course1, &course3});
+		student4.AddCoursesTaken({&course3, &course4});
+		students.Insert({student1, student2, student3, student4});
+		ON_CALL(students, size()).WillByDefault(Return(4));
+		ON_CALL(Const(students), Find(1)).WillByDefault(ReturnRef(student1));
+		ON_CALL(Const(students), Find(2)).WillByDefault(ReturnRef(student2));
+		ON_CALL(Const(students), Find(3)).WillByDefault(ReturnRef(student3));
+		ON_CALL(Const(students), Find(4)).WillByDefault(ReturnRef(student4));
+	}
+
+ protected:
+	Course course1{"ENGLISH", 125, 201403, 4}, course2{"CHEM", 210, 201405, 4},
+		   course3{"MATH", 425, 201407, 3}, course4{"AAPTIS", 277, 201407, 4};
+	Student old_student1{1}, old_student2{2}, old_student3{3};
+	Student student1{1}, student2{2}, student3{3}, student4{4};
+	NiceMock<MockStudentContainer> old_students, students;
+};
+
+
+TEST_F(NetworkUpdateTest, UpdateStudentNetwork) {
+	auto old_network =
+		BuildStudentNetworkFromStudents(old_students, InverseEnrollment);
+	auto rebuilt = BuildStudentNetworkFromStudents(students, InverseEnrollment);
+
+	auto updated = UpdateStudentNetwork(
+			old_network, students, InverseEnrollment, 201407);
+	EXPECT_EQ(ComputeEdgeChecksum(rebuilt), ComputeEdgeChecksum(updated));
+	EXPECT_EQ(4u, updated.GetVertexDescriptors().size());
+	EXPECT_DOUBLE_EQ(1. / 3. + 1. / 3., updated.Get(
+				updated.GetVertexDescriptor(2),
+				updated.GetVertexDescriptor(3)));
+	EXPECT_DOUBLE_EQ(1. / 3. + 1. / 2., updated.Get(
+				updated.GetVertexDescriptor(2),
+				updated.GetVertexDescriptor(4)));
+
+	// the filter drops the same edges as a build
+	EdgeFilter filter;
+	filter.min_weight = 0.6;
+	auto filtered = UpdateStudentNetwork(
+			BuildStudentNetworkFromStudents(
+				old_students, InverseEnrollment, nullptr, filter),
+			students, InverseEnrollment, 201407, filter);
+	EXPECT_EQ(ComputeEdgeChecksum(BuildStudentNetworkFromStudents(
+					students, InverseEnrollment, nullptr, filter)),
+			  ComputeEdgeChecksum(filtered));
+}
+
+
+TEST_F(NetworkUpdateTest, UpdateCourseNetwork) {
+	auto old_network = BuildCourseNetworkFromEnrollment(old_students);
+	auto rebuilt = BuildCourseNetworkFromEnrollment(students);
+
+	auto updated = UpdateCourseNetwork(old_network, students, 201407);
+	EXPECT_EQ(ComputeEdgeChecksum(rebuilt, Course::Id::Hasher{}),
+			  ComputeEdgeChecksum(updated, Course::Id::Hasher{}));
+	EXPECT_EQ(4u, updated.GetVertexDescriptors().size());
+	EXPECT_EQ(2, updated.Get(updated.GetVertex(course3.GetId()),
+				updated.GetVertex(course4.GetId())));
+}
+
+
+TEST_F(NetworkUpdateTest, Errors) {
+	auto old_network =
+		BuildStudentNetworkFromStudents(old_students, InverseEnrollment);
+	EdgeFilter filter;
+	filter.top_k = 1;
+	EXPECT_THROW(UpdateStudentNetwork(old_network, students, InverseEnrollment,
+				201407, filter), InvalidUpdate);
+	// no one took a course of the term
+	EXPECT_THROW(UpdateStudentNetwork(old_network, students, InverseEnrollment,
+				201409), InvalidUpdate);
+	// a student of the network is missing
+	EXPECT_THROW(UpdateStudentNetwork(
+				BuildStudentNetworkFromStudents(students, InverseEnrollment),
+				old_students, InverseEnrollment, 201405), InvalidUpdate);
+
+	// the network was already built with the term
+	EXPECT_THROW(UpdateCourseNetwork(BuildCourseNetworkFromEnrollment(students),
+				students, 201407), InvalidUpdate);
+}
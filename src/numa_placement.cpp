@@ -0,0 +1,101 @@
+#include "numa_placement.hpp"
+
+#ifdef ENABLE_NUMA
+#include <numa.h>
+#endif  // ENABLE_NUMA
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+#include "network_shard.hpp"
+
+
+using std::cerr; using std::endl;
+
+
+bool numa_placement{false};
+
+
+#ifdef ENABLE_NUMA
+
+int GetNumNumaNodes() {
+	if (!numa_placement || numa_available() < 0) { return 1; }
+	return std::max(numa_num_configured_nodes(), 1);
+}
+
+
+void RunOnNumaNode(int node) {
+	if (numa_run_on_node(node) != 0)
+	{ cerr << "Could not run on NUMA node " << node << "!" << endl; }
+	numa_set_localalloc();
+}
+
+
+static void InterleaveAllocations()
+{ numa_set_interleave_mask(numa_all_nodes_ptr); }
+
+
+static void AllocateLocally() { numa_set_localalloc(); }
+
+#else
+
+int GetNumNumaNodes() {
+	static bool warned{false};
+	if (numa_placement && !warned) {
+		cerr << "NUMA placement isn't compiled in, build with -Dnuma=ON!"
+			 << endl;
+		warned = true;
+	}
+	return 1;
+}
+
+
+void RunOnNumaNode(int) {}
+
+
+static void InterleaveAllocations() {}
+
+
+static void AllocateLocally() {}
+
+#endif  // ENABLE_NUMA
+
+
+NumaInterleave::NumaInterleave() : interleaved_{GetNumNumaNodes() > 1}
+{ if (interleaved_) { InterleaveAllocations(); } }
+
+
+void NumaInterleave::Stop() {
+	if (interleaved_) { AllocateLocally(); }
+	interleaved_ = false;
+}
+
+
+int GetWorkerNode(int worker, int num_workers, int num_nodes)
+{ return worker * num_nodes / num_workers; }
+
+
+NodeRows::NodeRows(long num_students, ShardRows rows, int num_nodes) :
+	rows_{rows}, next_rows_{new std::atomic<long>[num_nodes]} {
+	for (int node{0}; node < num_nodes; ++node) {
+		node_rows_.push_back(
+				SplitShardRows(num_students, rows, node, num_nodes));
+		next_rows_[node] = node_rows_.back().first_row;
+	}
+}
+
+
+long NodeRows::Claim(int node, bool& local) {
+	int num_nodes{static_cast<int>(node_rows_.size())};
+	for (int i{0}; i < num_nodes; ++i) {
+		auto other = (node + i) % num_nodes;
+		if (next_rows_[other] >= node_rows_[other].last_row) { continue; }
+		auto row = next_rows_[other]++;
+		if (row < node_rows_[other].last_row) {
+			local = i == 0;
+			return row;
+		}
+	}
+	return rows_.last_row;
+}
@@ -0,0 +1,70 @@
+#ifndef NUMA_PLACEMENT_H
+#define NUMA_PLACEMENT_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "network_shard.hpp"
+
+
+// Placement of build workers and their memory on the NUMA nodes (sockets) of
+// the machine, compiled in only when ENABLE_NUMA is defined (cmake -Dnuma=ON,
+// needs libnuma). With numa_placement set (build --numa), the archives are
+// loaded interleaved across the nodes so no socket reads the students and
+// courses only remotely, workers are pinned to the nodes in blocks and each
+// node's workers claim the rows of their own block of the network first. A
+// worker's row edges are allocated once it's pinned, so they're on its node.
+// Otherwise, or on a machine with a single node, there's one node.
+
+extern bool numa_placement;
+
+
+// The number of nodes workers are placed on.
+int GetNumNumaNodes();
+
+// The node of the given worker, the workers are split between the nodes in
+// blocks.
+int GetWorkerNode(int worker, int num_workers, int num_nodes);
+
+// Runs the calling thread on the cpus of the node, allocating on it.
+void RunOnNumaNode(int node);
+
+
+// Memory allocated by the thread from its construction until it's stopped
+// or destroyed is interleaved across the nodes, and then allocated locally
+// again.
+class NumaInterleave {
+ public:
+	NumaInterleave();
+	~NumaInterleave() { Stop(); }
+
+	NumaInterleave(const NumaInterleave&) = delete;
+	NumaInterleave& operator=(const NumaInterleave&) = delete;
+
+	void Stop();
+
+ private:
+	bool interleaved_;
+};
+
+
+// Rows of the network split between the nodes by pairs (see
+// network_shard.hpp). The workers of a node claim the rows of its block and
+// then help the other nodes with theirs, so no node waits on another's tail.
+class NodeRows {
+ public:
+	NodeRows(long num_students, ShardRows rows, int num_nodes);
+
+	// Claims the next row for a worker of the node, or returns rows.last_row
+	// once every row is claimed. Sets local to whether the row is the node's.
+	long Claim(int node, bool& local);
+
+ private:
+	ShardRows rows_;
+	std::vector<ShardRows> node_rows_;
+	std::unique_ptr<std::atomic<long>[]> next_rows_;
+};
+
+
+#endif  // NUMA_PLACEMENT_H
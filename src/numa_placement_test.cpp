@@ -0,0 +1,47 @@
+#include "numa_placement.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "network_shard.hpp"
+
+
+using std::vector;
+
+
+TEST(NumaPlacementTest, GetWorkerNode) {
+	vector<int> nodes;
+	for (int worker{0}; worker < 6; ++worker)
+	{ nodes.push_back(GetWorkerNode(worker, 6, 2)); }
+	EXPECT_EQ((vector<int>{0, 0, 0, 1, 1, 1}), nodes);
+	EXPECT_EQ(0, GetWorkerNode(0, 1, 2));
+	EXPECT_EQ(2, GetWorkerNode(2, 3, 4));
+}
+
+
+TEST(NumaPlacementTest, SingleNodeByDefault) {
+	EXPECT_EQ(1, GetNumNumaNodes());
+}
+
+
+TEST(NodeRowsTest, ClaimEveryRowOnce) {
+	ShardRows rows{10, 90};
+	NodeRows node_rows{100, rows, 2};
+	auto node1_rows = SplitShardRows(100, rows, 1, 2);
+
+	// node 1 claims its own rows first and then helps node 0
+	vector<int> claimed(100);
+	bool local;
+	auto row = node_rows.Claim(1, local);
+	EXPECT_EQ(node1_rows.first_row, row);
+	EXPECT_TRUE(local);
+	for (; row < rows.last_row; row = node_rows.Claim(1, local)) {
+		++claimed[row];
+		EXPECT_EQ(row >= node1_rows.first_row, local);
+	}
+	EXPECT_EQ(rows.last_row, node_rows.Claim(0, local));
+
+	for (long i{0}; i < 100; ++i)
+	{ EXPECT_EQ(i >= rows.first_row && i < rows.last_row, claimed[i] == 1); }
+}
@@ -0,0 +1,290 @@
+#include "pipeline.hpp"
+
+#include <cctype>
+
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "analysis_stages.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "utility.hpp"
+
+
+using std::current_exception; using std::exception_ptr;
+using std::rethrow_exception;
+using std::function;
+using std::getline; using std::istream;
+using std::invalid_argument;
+using std::lock_guard; using std::mutex;
+using std::map;
+using std::set;
+using std::stod;
+using std::string;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+
+// Keys that must be present and keys that may be present for a stage.
+struct StageSpec {
+	StageType_e type;
+	set<string> required_keys;
+	set<string> optional_keys;
+};
+
+
+const map<string, StageSpec> stage_specs{
+	{"degree_sum", {StageType_e::DegreeSum, {"weighted", "unweighted"}, {}}},
+	{"reduce", {StageType_e::Reduce, {"grouping", "aggregate", "output"}, {}}},
+	{"distances", {StageType_e::Distances, {"type", "cohort", "output"},
+		{"delta"}}},
+	{"ego", {StageType_e::EgoNetworks, {"cohort", "output_prefix"},
+		{"format"}}},
+};
+
+
+// Splits a line on whitespace, keeping double quoted text together.
+static vector<string> TokenizeLine(const string& line, int line_number);
+
+// Checks the values of a parsed stage, throws PipelineError.
+static void ValidateStage(const PipelineStage& stage);
+
+
+vector<PipelineStage> ParsePipeline(istream& input) {
+	vector<PipelineStage> stages;
+	string line;
+	for (int line_number{1}; getline(input, line); ++line_number) {
+		auto tokens = TokenizeLine(line, line_number);
+		if (tokens.empty() || tokens.front().compare(0, 1, "#") == 0)
+		{ continue; }
+
+		auto spec_it = stage_specs.find(tokens.front());
+		if (spec_it == stage_specs.end()) {
+			throw PipelineError{
+				line_number, "unknown stage \"" + tokens.front() + "\""};
+		}
+		const auto& spec = spec_it->second;
+
+		PipelineStage stage{spec.type, {}, line_number};
+		for (auto it = ++tokens.cbegin(); it != tokens.cend(); ++it) {
+			auto separator = it->find('=');
+			if (separator == string::npos) {
+				throw PipelineError{line_number,
+					"expected <key>=<value>, got \"" + *it + "\""};
+			}
+
+			auto key = it->substr(0, separator);
+			if (!spec.required_keys.count(key) &&
+					!spec.optional_keys.count(key)) {
+				throw PipelineError{line_number, "unknown key \"" + key +
+					"\" for stage \"" + tokens.front() + "\""};
+			}
+			if (!stage.options.emplace(key, it->substr(separator + 1)).second) {
+				throw PipelineError{
+					line_number, "duplicate key \"" + key + "\""};
+			}
+		}
+
+		for (const auto& key : spec.required_keys) {
+			if (!stage.options.count(key)) {
+				throw PipelineError{line_number, "stage \"" + tokens.front() +
+					"\" requires key \"" + key + "\""};
+			}
+		}
+
+		ValidateStage(stage);
+		stages.push_back(stage);
+	}
+
+	return stages;
+}
+
+
+vector<string> TokenizeLine(const string& line, int line_number) {
+	vector<string> tokens;
+	string token;
+	bool in_token{false}, in_quotes{false};
+	for (char c : line) {
+		if (c == '"') {
+			in_quotes = !in_quotes;
+			in_token = true;
+		} else if (!in_quotes && std::isspace(static_cast<unsigned char>(c))) {
+			if (in_token) { tokens.push_back(token); }
+			token.clear();
+			in_token = false;
+		} else {
+			token.push_back(c);
+			in_token = true;
+		}
+	}
+
+	if (in_quotes) { throw PipelineError{line_number, "unterminated quote"}; }
+	if (in_token) { tokens.push_back(token); }
+	return tokens;
+}
+
+
+// Parses the delta of a distances stage, throws invalid_argument for text
+// that isn't all a number or a number out of range.
+static double ParseDelta(const string& text) {
+	double delta{0.};
+	std::size_t length{0};
+	try {
+		delta = stod(text, &length);
+	} catch (std::out_of_range&) {
+		throw invalid_argument{"delta \"" + text + "\" is out of range"};
+	} catch (invalid_argument&) {}
+	if (length == 0 || length != text.size())
+	{ throw invalid_argument{"delta \"" + text + "\" isn't a number"}; }
+	return delta;
+}
+
+
+void ValidateStage(const PipelineStage& stage) {
+	// the parsing functions throw invalid_argument for bad values
+	try {
+		if (stage.options.count("cohort"))
+		{ ParseCohortFilter(stage.options.at("cohort")); }
+		if (stage.options.count("aggregate"))
+		{ ParseEdgeAggregate(stage.options.at("aggregate")); }
+		if (stage.options.count("grouping") &&
+				!IsGroupingName(stage.options.at("grouping"))) {
+			throw invalid_argument{
+				"unknown grouping \"" + stage.options.at("grouping") + "\""};
+		}
+		if (stage.options.count("type") &&
+				stage.options.at("type") != "weighted" &&
+				stage.options.at("type") != "unweighted") {
+			throw invalid_argument{"distance type must be weighted or "
+				"unweighted"};
+		}
+		if (stage.options.count("delta")) {
+			if (stage.options.at("type") != "weighted") {
+				throw invalid_argument{
+					"delta only applies to weighted distances"};
+			}
+			if (!(ParseDelta(stage.options.at("delta")) > 0.))
+			{ throw invalid_argument{"delta must be positive"}; }
+		}
+		if (stage.options.count("format") &&
+				stage.options.at("format") != "files" &&
+				stage.options.at("format") != "indexed") {
+			throw invalid_argument{"format must be files or indexed"};
+		}
+	} catch (invalid_argument& e) {
+		throw PipelineError{stage.line_number, e.what()};
+	}
+}
+
+
+// Creates a task that runs a single non-reduce stage.
+static function<void()> MakeStageTask(const PipelineStage& stage,
+									  const StudentNetwork& network,
+									  const StudentContainer& students) {
+	const auto& options = stage.options;
+	switch (stage.type) {
+		case StageType_e::DegreeSum:
+			return [&network, &options]() {
+				auto weighted_output = OpenOutputFile(options.at("weighted"));
+				auto unweighted_output =
+					OpenOutputFile(options.at("unweighted"));
+				SaveDegreeSums(network, weighted_output, unweighted_output);
+			};
+
+		case StageType_e::Distances:
+			return [&network, &students, &options]() {
+				auto filter = ParseCohortFilter(options.at("cohort"));
+				auto output = OpenOutputFile(options.at("output"));
+				if (options.at("type") == "unweighted") {
+					SaveUnweightedDistances(network, students, filter, output);
+					return;
+				}
+
+				unique_ptr<student_delta_stepping_t> delta_stepping;
+				if (options.count("delta")) {
+					delta_stepping = make_unique<student_delta_stepping_t>(
+							network, ParseDelta(options.at("delta")));
+				}
+				SaveWeightedDistances(network, students, filter, output,
+						delta_stepping.get());
+			};
+
+		case StageType_e::EgoNetworks:
+			return [&network, &students, &options]() {
+				auto filter = ParseCohortFilter(options.at("cohort"));
+				const auto& prefix = options.at("output_prefix");
+				if (!options.count("format") ||
+						options.at("format") == "files") {
+					SaveIndividualStudentNetworks(
+							network, students, filter, prefix);
+					return;
+				}
+
+				auto data_output = OpenOutputFile(prefix + "ego_networks.tsv");
+				auto index_output =
+					OpenOutputFile(prefix + "ego_networks.index");
+				ReportSavedEdges(prefix + "ego_networks.tsv", SaveEgoNetworks(
+							network, FindCohortVertices(network, students,
+								filter), data_output, index_output));
+			};
+
+		case StageType_e::Reduce:
+			break;
+	}
+
+	// reduce stages are batched by RunPipeline
+	throw invalid_argument{"reduce stages can't run on their own"};
+}
+
+
+void RunPipeline(const vector<PipelineStage>& stages,
+				 const StudentNetwork& network,
+				 const StudentContainer& students) {
+	vector<function<void()>> tasks;
+	vector<ReductionOutput> reduction_outputs;
+	for (const auto& stage : stages) {
+		if (stage.type == StageType_e::Reduce) {
+			reduction_outputs.push_back({stage.options.at("grouping"),
+					ParseEdgeAggregate(stage.options.at("aggregate")),
+					stage.options.at("output")});
+		} else {
+			tasks.push_back(MakeStageTask(stage, network, students));
+		}
+	}
+
+	// all reductions share one pass over the edges
+	if (!reduction_outputs.empty()) {
+		tasks.push_back([&network, &students, &reduction_outputs]()
+				{ SaveReductions(network, students, reduction_outputs); });
+	}
+
+	// run every task on its own thread, keeping the first error
+	exception_ptr first_exception;
+	mutex exception_mutex;
+	vector<thread> threads;
+	for (const auto& task : tasks) {
+		threads.emplace_back([&task, &first_exception, &exception_mutex]() {
+			try {
+				task();
+			} catch (...) {
+				lock_guard<mutex> lg{exception_mutex};
+				if (!first_exception) { first_exception = current_exception(); }
+			}
+		});
+	}
+
+	for (auto& task_thread : threads) { task_thread.join(); }
+	if (first_exception) { rethrow_exception(first_exception); }
+}
@@ -0,0 +1,62 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <exception>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+
+class StudentContainer;
+class StudentNetwork;
+
+
+// A pipeline description has one stage per line in the form
+//     <stage> <key>=<value> <key>=<value> ...
+// Values containing spaces must be double quoted. Blank lines and lines
+// starting with '#' are ignored. The stages and their keys are:
+//     degree_sum weighted=<path> unweighted=<path>
+//     reduce grouping=<field> aggregate=<sum|count|min|max> output=<path>
+//     distances type=<weighted|unweighted> cohort=<cohort> output=<path>
+//               [delta=<bucket width>]
+//     ego cohort=<cohort> output_prefix=<path prefix> [format=<files|indexed>]
+// See ParseCohortFilter for the cohort syntax. Ego networks are saved to a
+// file per student by default, or with format=indexed to
+// "<path prefix>ego_networks.tsv" and its index
+// "<path prefix>ego_networks.index" as described at SaveEgoNetworks.
+
+enum class StageType_e { DegreeSum, Reduce, Distances, EgoNetworks };
+
+
+struct PipelineStage {
+	StageType_e type;
+	std::map<std::string, std::string> options;
+	int line_number;
+};
+
+
+class PipelineError : public std::exception {
+ public:
+	PipelineError(int line_number, const std::string& message) :
+		error_message_{"Pipeline line " + std::to_string(line_number) + ": " +
+			message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+// Parses and validates a pipeline description. Throws PipelineError.
+std::vector<PipelineStage> ParsePipeline(std::istream& input);
+
+// Runs every stage over the shared network. All reduce stages are computed in
+// a single pass over the edges, and the independent stages run concurrently.
+// The first exception thrown by a stage is rethrown once all stages finish.
+void RunPipeline(const std::vector<PipelineStage>& stages,
+				 const StudentNetwork& network,
+				 const StudentContainer& students);
+
+
+#endif  // PIPELINE_H
@@ -0,0 +1,239 @@
+#include "pipeline.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/graph/adjacency_matrix.hpp>
+#include "gtest/gtest.h"
+
+#include "analysis_stages.hpp"
+#include "edge_checksum.hpp"
+#include "setting_guard.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "student_sample.hpp"
+#include "test_data_streams.hpp"
+#include "utility.hpp"
+
+
+using std::invalid_argument;
+using std::string;
+using std::stringstream;
+
+using boost::add_edge;
+using boost::vertex;
+
+
+class PipelineTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		StudentNetwork::graph_t graph{5};
+
+		// add vertices
+		auto student1 = vertex(0, graph);
+		graph[student1] = Student::Id{147195};
+		auto student2 = vertex(1, graph);
+		graph[student2] = Student::Id{312995};
+		auto student3 = vertex(2, graph);
+		graph[student3] = Student::Id{352468};
+		auto student4 = vertex(3, graph);
+		graph[student4] = Student::Id{500928};
+		auto student5 = vertex(4, graph);
+		graph[student5] = Student::Id{567890};
+
+		// add edges
+		add_edge(student1, student2, 3.0, graph);
+		add_edge(student1, student3, 3.0, graph);
+		add_edge(student1, student4, 1.0, graph);
+
+		add_edge(student2, student3, 1.0, graph);
+		add_edge(student2, student4, 3.0, graph);
+
+		add_edge(student3, student4, 1.0, graph);
+		add_edge(student3, student5, 1.5, graph);
+
+		network = StudentNetwork{graph};
+	}
+
+ protected:
+	StudentNetwork network;
+};
+
+
+TEST_F(PipelineTest, ParsePipeline) {
+	stringstream description{
+		"# comments and blank lines are skipped\n"
+		"\n"
+		"degree_sum weighted=weighted.tsv unweighted=unweighted.tsv\n"
+		"reduce grouping=major1 aggregate=count output=major1.tsv\n"
+		"distances type=weighted cohort=\"major1:General Studies\" "
+			"output=general_studies.tsv delta=0.5\n"
+		"  ego cohort=school:ULSA output_prefix=output/ulsa_\n"};
+
+	auto stages = ParsePipeline(description);
+	ASSERT_EQ(4u, stages.size());
+
+	EXPECT_EQ(StageType_e::DegreeSum, stages[0].type);
+	EXPECT_EQ(3, stages[0].line_number);
+	EXPECT_EQ("weighted.tsv", stages[0].options.at("weighted"));
+	EXPECT_EQ("unweighted.tsv", stages[0].options.at("unweighted"));
+
+	EXPECT_EQ(StageType_e::Reduce, stages[1].type);
+	EXPECT_EQ("count", stages[1].options.at("aggregate"));
+
+	EXPECT_EQ(StageType_e::Distances, stages[2].type);
+	EXPECT_EQ("major1:General Studies", stages[2].options.at("cohort"));
+	EXPECT_EQ("0.5", stages[2].options.at("delta"));
+
+	EXPECT_EQ(StageType_e::EgoNetworks, stages[3].type);
+	EXPECT_EQ("output/ulsa_", stages[3].options.at("output_prefix"));
+}
+
+
+TEST_F(PipelineTest, ParsePipelineErrors) {
+	for (string description : {
+			"unknown_stage output=a.tsv",
+			"degree_sum weighted=a.tsv",
+			"degree_sum weighted=a.tsv unweighted=b.tsv weighted=c.tsv",
+			"degree_sum weighted=a.tsv unweighted",
+			"reduce grouping=major1 aggregate=median output=a.tsv",
+			"reduce grouping=favorite_color aggregate=sum output=a.tsv",
+			"distances type=weighted cohort=favorite_color:red output=a.tsv",
+			"distances type=unweighted cohort=all output=a.tsv delta=1",
+			"distances type=weighted cohort=all output=a.tsv delta=0",
+			"distances type=weighted cohort=all output=a.tsv delta=1e999",
+			"distances type=weighted cohort=all output=a.tsv delta=0.5abc",
+			"distances type=weighted cohort=all output=a.tsv delta=abc",
+			"ego cohort=\"school:ULSA output_prefix=a",
+			"ego cohort=all output_prefix=a format=binary"}) {
+		stringstream description_stream{description};
+		EXPECT_THROW(ParsePipeline(description_stream), PipelineError)
+			<< description;
+	}
+}
+
+
+TEST_F(PipelineTest, CohortFilter) {
+	stringstream student_stream{student_tab};
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+
+	auto ulsa = ParseCohortFilter("school:ULSA");
+	EXPECT_TRUE(ulsa(students.Find(147195)));
+	EXPECT_FALSE(ulsa(students.Find(352468)));
+
+	auto all = ParseCohortFilter("all");
+	EXPECT_TRUE(all(students.Find(352468)));
+
+	EXPECT_THROW(ParseCohortFilter("school"), invalid_argument);
+	EXPECT_THROW(ParseCohortFilter("favorite_color:red"), invalid_argument);
+}
+
+
+TEST_F(PipelineTest, SaveDegreeSums) {
+	stringstream weighted, unweighted;
+	SaveDegreeSums(network, weighted, unweighted);
+
+	EXPECT_EQ("147195\t7\n312995\t7\n352468\t6.5\n500928\t5\n567890\t1.5\n",
+			  weighted.str());
+	EXPECT_EQ("147195\t3\n312995\t3\n352468\t4\n500928\t3\n567890\t1\n",
+			  unweighted.str());
+}
+
+
+TEST_F(PipelineTest, SaveDegreeSumEstimates) {
+	stringstream student_stream{student_tab};
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+
+	// a sample of every student estimates the exact sums
+	StudentSample sample{students, SampleOptions{}};
+	stringstream weighted, unweighted, summary;
+	SaveDegreeSumEstimates(network, sample, weighted, unweighted, summary);
+	EXPECT_EQ("147195\t7\t7\t7\n312995\t7\t7\t7\n352468\t6.5\t6.5\t6.5\n"
+			  "500928\t5\t5\t5\n567890\t1.5\t1.5\t1.5\n", weighted.str());
+	EXPECT_EQ("147195\t3\t3\t3\n312995\t3\t3\t3\n352468\t4\t4\t4\n"
+			  "500928\t3\t3\t3\n567890\t1\t1\t1\n", unweighted.str());
+	EXPECT_EQ("edges\t7\t1\t7\t0\t7\t7\n"
+			  "total_weight\t13.5\t1\t13.5\t0\t13.5\t13.5\n"
+			  "mean_degree\t2.8\t1\t2.8\t0\t2.8\t2.8\n"
+			  "mean_weighted_degree\t5.4\t1\t5.4\t0\t5.4\t5.4\n",
+			  summary.str());
+
+	// the network must be that of the sample
+	SampleOptions options;
+	options.rate = 0.4;
+	StudentSample other_sample{students, options};
+	EXPECT_THROW(SaveDegreeSumEstimates(network, other_sample, weighted,
+				unweighted, summary), invalid_argument);
+}
+
+
+TEST_F(PipelineTest, SaveReductionEstimate) {
+	stringstream student_stream{student_tab};
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+	StudentSample sample{students, SampleOptions{}};
+
+	stringstream output;
+	SaveReductionEstimate(network, students, sample,
+			{"school", EdgeAggregate_e::Count, ""}, output);
+	EXPECT_EQ("NA\tULSA\t4\t1\t4\t4\t4\nULSA\tULSA\t3\t1\t3\t3\t3\n",
+			  output.str());
+
+	EXPECT_THROW(SaveReductionEstimate(network, students, sample,
+				{"school", EdgeAggregate_e::Max, ""}, output),
+			invalid_argument);
+}
+
+
+TEST_F(PipelineTest, SaveDistances) {
+	stringstream student_stream{student_tab};
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+	auto na_school = ParseCohortFilter("school:NA");
+
+	stringstream weighted;
+	SaveWeightedDistances(network, students, na_school, weighted, nullptr);
+	EXPECT_EQ("352468\t2.000000\t1.000000\t1.000000\t1.500000\n",
+			  weighted.str());
+
+	student_delta_stepping_t delta_stepping{network, 1.};
+	stringstream delta_weighted;
+	SaveWeightedDistances(
+			network, students, na_school, delta_weighted, &delta_stepping);
+	EXPECT_EQ(weighted.str(), delta_weighted.str());
+
+	stringstream unweighted;
+	SaveUnweightedDistances(network, students, na_school, unweighted);
+	EXPECT_EQ("352468\t1.000000\t1.000000\t1.000000\t1.000000\n",
+			  unweighted.str());
+}
+
+
+TEST_F(PipelineTest, SaveEgoNetworks) {
+	stringstream student_stream{student_tab};
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+
+	auto egos = FindStudentVertices(network, {567890, 147195});
+	EXPECT_EQ(FindCohortVertices(network, students, ParseCohortFilter(
+					"school:NA")), FindStudentVertices(network, {352468}));
+	EXPECT_THROW(FindStudentVertices(network, {123}), invalid_argument);
+
+	stringstream data, index;
+	EdgeChecksum checksum;
+	{
+		SettingGuard<int> threads_guard{num_threads, 2};
+		checksum = SaveEgoNetworks(network, egos, data, index);
+	}
+
+	EXPECT_EQ("567890\t352468\t1.5\n"
+			  "147195\t312995\t3\n147195\t352468\t3\n147195\t500928\t1\n",
+			  data.str());
+	EXPECT_EQ("567890\t0\t18\n147195\t18\t48\n", index.str());
+
+	EdgeChecksum expected;
+	expected.AddEdge(567890, 352468, 1.5);
+	expected.AddEdge(147195, 312995, 3.);
+	expected.AddEdge(147195, 352468, 3.);
+	expected.AddEdge(147195, 500928, 1.);
+	EXPECT_EQ(expected, checksum);
+}
@@ -0,0 +1,117 @@
+#include "progress.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "mem_usage.hpp"
+
+
+using std::endl;
+using std::ostream; using std::ostringstream;
+using std::setfill; using std::setprecision; using std::setw;
+using std::string;
+namespace chr = std::chrono;
+
+
+// How often the reporter thread checks whether it should stop.
+const chr::milliseconds reporter_poll_interval{100};
+
+
+ProgressCounters::ProgressCounters(int num_workers) :
+	num_slots_{num_workers},
+	storage_{new char[num_workers * sizeof(Slot) + cache_line_size]} {
+	static_assert(sizeof(Slot) == cache_line_size, "A slot isn't a line");
+	void* storage = storage_.get();
+	auto space = num_workers * sizeof(Slot) + cache_line_size;
+	slots_ = static_cast<Slot*>(std::align(
+				alignof(Slot), num_workers * sizeof(Slot), storage, space));
+	for (int i{0}; i < num_slots_; ++i) { new (slots_ + i) Slot; }
+}
+
+
+long ProgressCounters::work() const {
+	long work{0};
+	for (int i{0}; i < num_slots_; ++i)
+	{ work += slots_[i].work.load(std::memory_order_relaxed); }
+	return work;
+}
+
+
+long ProgressCounters::edges() const {
+	long edges{0};
+	for (int i{0}; i < num_slots_; ++i)
+	{ edges += slots_[i].edges.load(std::memory_order_relaxed); }
+	return edges;
+}
+
+
+string FormatProgress(long work, long total_work, long edges,
+					  double elapsed_seconds, const string& work_name) {
+	ostringstream output;
+	double fraction{total_work > 0 ?
+		static_cast<double>(work) / total_work : 1.};
+	output << std::fixed << setprecision(1) << 100. * fraction << "% of "
+		   << total_work << ' ' << work_name << ", ";
+
+	double work_rate{0.}, edge_rate{0.};
+	if (elapsed_seconds > 0.) {
+		work_rate = work / elapsed_seconds;
+		edge_rate = edges / elapsed_seconds;
+	}
+	output.unsetf(std::ios::floatfield);
+	output << setprecision(2) << work_rate << ' ' << work_name << "/s, "
+		   << edge_rate << " edges/s, ETA ";
+
+	if (work >= total_work) { output << "0:00:00"; }
+	else if (work_rate <= 0.) { output << "unknown"; }
+	else {
+		auto remaining = static_cast<long>((total_work - work) / work_rate);
+		output << remaining / 3600 << ':' << setfill('0') << setw(2)
+			   << remaining / 60 % 60 << ':' << setw(2) << remaining % 60;
+	}
+	return output.str();
+}
+
+
+ProgressReporter::ProgressReporter(
+		const ProgressCounters& counters, long total_work,
+		const string& work_name, int period_seconds, ostream& output) :
+			counters_(counters), total_work_{total_work},
+			work_name_{work_name}, output_(output),
+			start_{chr::steady_clock::now()}, stop_{period_seconds <= 0} {
+	if (stop_) { return; }
+
+	reporter_thread_ = std::thread{[this, period_seconds]() {
+		auto next_report = start_ + chr::seconds{period_seconds};
+		while (!stop_) {
+			std::this_thread::sleep_for(reporter_poll_interval);
+			if (chr::steady_clock::now() < next_report) { continue; }
+			Report();
+			next_report += chr::seconds{period_seconds};
+		}
+	}};
+}
+
+
+void ProgressReporter::Stop() {
+	if (!reporter_thread_.joinable()) { return; }
+	stop_ = true;
+	reporter_thread_.join();
+	Report();
+}
+
+
+void ProgressReporter::Report() const {
+	double elapsed_seconds{chr::duration<double>(
+			chr::steady_clock::now() - start_).count()};
+	output_ << "Progress: " << FormatProgress(counters_.work(), total_work_,
+			counters_.edges(), elapsed_seconds, work_name_)
+			<< ", resident memory " << GetMemoryUsage() << " KB" << endl;
+}
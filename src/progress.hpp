@@ -0,0 +1,84 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <thread>
+
+
+// Work and edge counts of a fixed number of workers. Each worker owns a slot
+// on its own cache line and is the only one to write it, so updates are
+// relaxed stores that never contend; readers sum the slots whenever they like.
+class ProgressCounters {
+ public:
+	ProgressCounters(int num_workers);
+
+	ProgressCounters(const ProgressCounters&) = delete;
+	ProgressCounters& operator=(const ProgressCounters&) = delete;
+
+	// Sets the running totals of the given worker.
+	void Update(int worker, long work, long edges) {
+		slots_[worker].work.store(work, std::memory_order_relaxed);
+		slots_[worker].edges.store(edges, std::memory_order_relaxed);
+	}
+
+	long work() const;
+	long edges() const;
+
+ private:
+	static const std::size_t cache_line_size{64};
+
+	struct alignas(cache_line_size) Slot {
+		std::atomic<long> work{0}, edges{0};
+	};
+
+	// vector doesn't align over-aligned types before C++17, so the slots are
+	// placed at the first cache line of storage_
+	int num_slots_;
+	std::unique_ptr<char[]> storage_;
+	Slot* slots_;
+};
+
+
+// Formats a line like
+//     "45.2% of 1000000 pairs, 1.2e+06 pairs/s, 3.4e+05 edges/s, ETA 0:12:03"
+// work_name names the units of work. The ETA assumes the current rate holds.
+std::string FormatProgress(long work, long total_work, long edges,
+						   double elapsed_seconds,
+						   const std::string& work_name);
+
+
+// Writes the progress of the counters against total_work to output every
+// period_seconds from a background thread, and a last line when stopped.
+// Only reads the counters, so the workers are never slowed down by it. Does
+// nothing if period_seconds isn't positive.
+class ProgressReporter {
+ public:
+	ProgressReporter(const ProgressCounters& counters, long total_work,
+					 const std::string& work_name, int period_seconds,
+					 std::ostream& output);
+	~ProgressReporter() { Stop(); }
+
+	ProgressReporter(const ProgressReporter&) = delete;
+	ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+	// Stops reporting, e.g. once the work is done but the builder isn't.
+	void Stop();
+
+ private:
+	void Report() const;
+
+	const ProgressCounters& counters_;
+	long total_work_;
+	std::string work_name_;
+	std::ostream& output_;
+	std::chrono::steady_clock::time_point start_;
+	std::atomic<bool> stop_;
+	std::thread reporter_thread_;
+};
+
+
+#endif  // PROGRESS_H
@@ -0,0 +1,52 @@
+#include "progress.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+
+using std::ostringstream;
+using std::string;
+
+
+TEST(ProgressTest, Counters) {
+	ProgressCounters counters{3};
+	EXPECT_EQ(0, counters.work());
+	EXPECT_EQ(0, counters.edges());
+
+	counters.Update(0, 10, 2);
+	counters.Update(2, 5, 1);
+	counters.Update(0, 20, 4);
+	EXPECT_EQ(25, counters.work());
+	EXPECT_EQ(5, counters.edges());
+}
+
+
+TEST(ProgressTest, FormatProgress) {
+	EXPECT_EQ("25.0% of 1000 pairs, 25 pairs/s, 5 edges/s, ETA 0:00:30",
+			  FormatProgress(250, 1000, 50, 10., "pairs"));
+	EXPECT_EQ("50.0% of 20000 pairs, 1 pairs/s, 0 edges/s, ETA 2:46:40",
+			  FormatProgress(10000, 20000, 0, 10000., "pairs"));
+	EXPECT_EQ("0.0% of 1000 pairs, 0 pairs/s, 0 edges/s, ETA unknown",
+			  FormatProgress(0, 1000, 0, 0., "pairs"));
+	EXPECT_EQ("100.0% of 0 pairs, 0 pairs/s, 0 edges/s, ETA 0:00:00",
+			  FormatProgress(0, 0, 0, 5., "pairs"));
+}
+
+
+TEST(ProgressTest, Reporter) {
+	ProgressCounters counters{1};
+	ostringstream output;
+	{
+		// nothing is written when disabled
+		ProgressReporter reporter{counters, 10, "pairs", 0, output};
+	}
+	EXPECT_EQ("", output.str());
+
+	{
+		ProgressReporter reporter{counters, 10, "pairs", 1, output};
+		counters.Update(0, 10, 3);
+	}
+	EXPECT_EQ(0u, output.str().find("Progress: 100.0% of 10 pairs, "));
+}
@@ -0,0 +1,87 @@
+#include "query_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "query_server.hpp"
+
+
+using std::runtime_error;
+using std::string; using std::stoul;
+using std::vector;
+
+
+QueryClient::QueryClient(const string& socket_path) {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+	{ throw runtime_error{"Socket path \"" + socket_path + "\" is too long"}; }
+	std::strncpy(address.sun_path, socket_path.c_str(),
+				 sizeof(address.sun_path) - 1);
+
+	socket_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket_fd_ < 0)
+	{ throw runtime_error{string{"socket: "} + std::strerror(errno)}; }
+
+	if (connect(socket_fd_, reinterpret_cast<sockaddr*>(&address),
+				sizeof(address)) < 0) {
+		string error{std::strerror(errno)};
+		close(socket_fd_);
+		throw runtime_error{"Could not connect to \"" + socket_path + "\": " +
+			error};
+	}
+}
+
+
+QueryClient::~QueryClient() { close(socket_fd_); }
+
+
+vector<string> QueryClient::Request(const string& request) {
+	if (request.find('\n') != string::npos)
+	{ throw std::invalid_argument{"Requests must be a single line"}; }
+
+	auto data = request + '\n';
+	std::size_t sent{0};
+	while (sent < data.size()) {
+		auto result = send(socket_fd_, data.data() + sent, data.size() - sent,
+						   MSG_NOSIGNAL);
+		if (result < 0 && errno == EINTR) { continue; }
+		if (result <= 0) { throw runtime_error{"Lost connection to server"}; }
+		sent += result;
+	}
+
+	auto status = ReadLine();
+	if (status.compare(0, 4, "ERR ") == 0)
+	{ throw QueryError{status.substr(4)}; }
+	if (status.compare(0, 3, "OK ") != 0)
+	{ throw runtime_error{"Malformed response \"" + status + "\""}; }
+
+	vector<string> lines(stoul(status.substr(3)));
+	for (auto& line : lines) { line = ReadLine(); }
+	return lines;
+}
+
+
+string QueryClient::ReadLine() {
+	std::size_t newline;
+	while ((newline = buffer_.find('\n')) == string::npos) {
+		char read_buffer[4096];
+		auto received = recv(socket_fd_, read_buffer, sizeof(read_buffer), 0);
+		if (received < 0 && errno == EINTR) { continue; }
+		if (received <= 0) { throw runtime_error{"Lost connection to server"}; }
+		buffer_.append(read_buffer, received);
+	}
+
+	auto line = buffer_.substr(0, newline);
+	buffer_.erase(0, newline + 1);
+	return line;
+}
@@ -0,0 +1,31 @@
+#ifndef QUERY_CLIENT_H
+#define QUERY_CLIENT_H
+
+#include <string>
+#include <vector>
+
+
+// Connection to a network server speaking the protocol in query_server.hpp.
+class QueryClient {
+ public:
+	// Throws std::runtime_error if the server can't be reached.
+	QueryClient(const std::string& socket_path);
+	~QueryClient();
+
+	QueryClient(const QueryClient&) = delete;
+	QueryClient& operator=(const QueryClient&) = delete;
+
+	// Sends a single request line and returns the lines of the response.
+	// Throws QueryError if the server answers with an error and
+	// std::runtime_error if the connection is lost.
+	std::vector<std::string> Request(const std::string& request);
+
+ private:
+	std::string ReadLine();
+
+	int socket_fd_;
+	std::string buffer_;
+};
+
+
+#endif  // QUERY_CLIENT_H
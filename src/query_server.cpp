@@ -0,0 +1,342 @@
+#include "query_server.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_stages.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "trace.hpp"
+
+
+using std::atomic;
+using std::cref;
+using std::istream_iterator;
+using std::lock_guard; using std::mutex;
+using std::map;
+using std::ostringstream; using std::istringstream;
+using std::queue;
+using std::runtime_error;
+using std::string; using std::stoi; using std::to_string;
+using std::thread;
+using std::vector;
+namespace chr = std::chrono;
+
+
+// How often blocked socket calls wake up to check whether to stop.
+const int poll_timeout_ms{200};
+
+const std::size_t read_buffer_size{4096};
+
+
+using handler_func_t = vector<string>(QueryHandler::*)(
+		const vector<string>&) const;
+
+
+QueryHandler::QueryHandler(const StudentNetwork& network,
+						   const StudentContainer& students,
+						   const student_delta_stepping_t* delta_stepping) :
+		network_(network), students_(students),
+		delta_stepping_(delta_stepping),
+		vertex_index_(network.GetVertexIndex()) {}
+
+
+string QueryHandler::HandleRequest(const string& request) const {
+	TRACE_SCOPE("query");
+	// request name => handler and the number of words it expects
+	static const map<string, std::pair<handler_func_t, std::size_t>>
+		handlers{
+			{"student", {&QueryHandler::HandleStudent, 2}},
+			{"neighbors", {&QueryHandler::HandleNeighbors, 2}},
+			{"ego", {&QueryHandler::HandleEgo, 3}},
+			{"distances", {&QueryHandler::HandleDistances, 3}},
+			{"distance", {&QueryHandler::HandleDistance, 4}},
+			{"reduce", {&QueryHandler::HandleReduce, 3}},
+		};
+
+	istringstream request_stream{request};
+	vector<string> words{istream_iterator<string>{request_stream},
+						 istream_iterator<string>{}};
+
+	try {
+		if (words.empty()) { throw QueryError{"empty request"}; }
+		auto handler_it = handlers.find(words.front());
+		if (handler_it == handlers.end())
+		{ throw QueryError{"unknown request \"" + words.front() + "\""}; }
+		if (words.size() != handler_it->second.second) {
+			throw QueryError{"\"" + words.front() + "\" expects " +
+				to_string(handler_it->second.second - 1) + " arguments"};
+		}
+
+		auto lines = (this->*(handler_it->second.first))(words);
+		ostringstream response;
+		response << "OK " << lines.size() << '\n';
+		for (const auto& line : lines) { response << line << '\n'; }
+		return response.str();
+	} catch (std::exception& e) {
+		// errors are single lines
+		string message{e.what()};
+		for (auto& c : message) { if (c == '\n') { c = ' '; } }
+		return "ERR " + message + '\n';
+	}
+}
+
+
+vector<string> QueryHandler::HandleStudent(const vector<string>& words) const {
+	try {
+		return {students_.Find(stoi(words[1])).GetDescription()};
+	} catch (StudentNotFound& e) {
+		throw QueryError{e.what()};
+	}
+}
+
+
+vector<string> QueryHandler::HandleNeighbors(
+		const vector<string>& words) const {
+	vector<string> lines;
+	for (const auto& edge_d : network_.GetOutEdgeDescriptors(
+				FindVertex(words[1]))) {
+		ostringstream line;
+		line << network_.GetTargetValue(edge_d) << '\t' << network_[edge_d];
+		lines.push_back(line.str());
+	}
+	return lines;
+}
+
+
+vector<string> QueryHandler::HandleEgo(const vector<string>& words) const {
+	int hops{stoi(words[2])};
+	if (hops < 0) { throw QueryError{"hops must not be negative"}; }
+
+	// breadth first search out to the given number of hops
+	vector<int> depth(network_.GetVertexDescriptors().size(), -1);
+	vector<StudentNetwork::vertex_t> members;
+	queue<StudentNetwork::vertex_t> frontier;
+	auto start = FindVertex(words[1]);
+	depth[start] = 0;
+	frontier.push(start);
+	while (!frontier.empty()) {
+		auto vertex_d = frontier.front();
+		frontier.pop();
+		members.push_back(vertex_d);
+		if (depth[vertex_d] == hops) { continue; }
+
+		for (const auto& edge_d : network_.GetOutEdgeDescriptors(vertex_d)) {
+			auto target = network_.GetTargetDescriptor(edge_d);
+			if (depth[target] != -1) { continue; }
+			depth[target] = depth[vertex_d] + 1;
+			frontier.push(target);
+		}
+	}
+
+	// every edge among the members, each reported once
+	vector<string> lines;
+	for (auto vertex_d : members) {
+		for (const auto& edge_d : network_.GetOutEdgeDescriptors(vertex_d)) {
+			auto target = network_.GetTargetDescriptor(edge_d);
+			if (depth[target] == -1 || target < vertex_d) { continue; }
+
+			ostringstream line;
+			line << network_[vertex_d] << '\t' << network_[target] << '\t'
+				 << network_[edge_d];
+			lines.push_back(line.str());
+		}
+	}
+	return lines;
+}
+
+
+vector<string> QueryHandler::HandleDistances(
+		const vector<string>& words) const {
+	auto vertex_d = FindVertex(words[1]);
+
+	vector<string> lines;
+	auto add_lines = [&lines](const map<Student::Id, double>& distances) {
+		for (const auto& elt : distances) {
+			ostringstream line;
+			line << elt.first << '\t' << elt.second;
+			lines.push_back(line.str());
+		}
+	};
+
+	if (words[2] == "weighted") {
+		add_lines(delta_stepping_ ? delta_stepping_->FindDistances(vertex_d) :
+				network_.FindWeightedDistances(vertex_d));
+	} else if (words[2] == "unweighted") {
+		auto distances = network_.FindUnweightedDistances(vertex_d);
+		add_lines({begin(distances), end(distances)});
+	} else {
+		throw QueryError{"distance type must be weighted or unweighted"};
+	}
+	return lines;
+}
+
+
+vector<string> QueryHandler::HandleDistance(
+		const vector<string>& words) const {
+	// reuse the single source distances and pick out the target
+	auto distances = HandleDistances({words[0], words[1], words[3]});
+	auto target_id = to_string(network_[FindVertex(words[2])]) + '\t';
+	for (const auto& line : distances) {
+		if (line.compare(0, target_id.size(), target_id) == 0)
+		{ return {line.substr(target_id.size())}; }
+	}
+	return {};
+}
+
+
+vector<string> QueryHandler::HandleReduce(const vector<string>& words) const {
+	auto key = words[1] + ' ' + words[2];
+	{
+		lock_guard<mutex> lg{reductions_mutex_};
+		auto reduction_it = reductions_.find(key);
+		if (reduction_it != reductions_.end()) { return reduction_it->second; }
+	}
+
+	if (!IsGroupingName(words[1]))
+	{ throw QueryError{"unknown grouping \"" + words[1] + "\""}; }
+
+	// computed outside the lock, two racing requests just compute it twice
+	ostringstream output;
+	SaveReduction(network_, students_,
+			{words[1], ParseEdgeAggregate(words[2]), ""}, output);
+	vector<string> lines;
+	istringstream output_lines{output.str()};
+	for (string line; getline(output_lines, line);) { lines.push_back(line); }
+
+	lock_guard<mutex> lg{reductions_mutex_};
+	reductions_[key] = lines;
+	return lines;
+}
+
+
+StudentNetwork::vertex_t QueryHandler::FindVertex(const string& id) const {
+	auto vertex_it = vertex_index_.find(stoi(id));
+	if (vertex_it == vertex_index_.end())
+	{ throw QueryError{"Student " + id + " is not in the network"}; }
+	return vertex_it->second;
+}
+
+
+// Sends all of data, returns false if the connection was closed.
+static bool SendAll(int socket_fd, const string& data) {
+	std::size_t sent{0};
+	while (sent < data.size()) {
+		auto result = send(socket_fd, data.data() + sent, data.size() - sent,
+						   MSG_NOSIGNAL);
+		if (result < 0 && errno == EINTR) { continue; }
+		if (result <= 0) { return false; }
+		sent += result;
+	}
+	return true;
+}
+
+
+static void ServeConnection(int client_fd, const QueryHandler& handler,
+							const atomic<bool>& stop,
+							atomic<int>& active_connections) {
+	string buffer;
+	char read_buffer[read_buffer_size];
+	bool open{true};
+	while (open && !stop) {
+		pollfd client_poll{client_fd, POLLIN, 0};
+		auto ready = poll(&client_poll, 1, poll_timeout_ms);
+		if (ready < 0 && errno != EINTR) { break; }
+		if (ready <= 0) { continue; }
+
+		auto received = recv(client_fd, read_buffer, sizeof(read_buffer), 0);
+		if (received < 0 && errno == EINTR) { continue; }
+		if (received <= 0) { break; }
+		buffer.append(read_buffer, received);
+
+		// answer every complete line in the buffer
+		std::size_t newline;
+		while (open && (newline = buffer.find('\n')) != string::npos) {
+			auto request = buffer.substr(0, newline);
+			buffer.erase(0, newline + 1);
+			if (!request.empty() && request.back() == '\r')
+			{ request.pop_back(); }
+
+			if (request == "quit") { open = false; }
+			else { open = SendAll(client_fd, handler.HandleRequest(request)); }
+		}
+	}
+
+	close(client_fd);
+	--active_connections;
+}
+
+
+void ServeUnixSocket(const string& socket_path, const QueryHandler& handler,
+					 const atomic<bool>& stop) {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+	{ throw runtime_error{"Socket path \"" + socket_path + "\" is too long"}; }
+	std::strncpy(address.sun_path, socket_path.c_str(),
+				 sizeof(address.sun_path) - 1);
+
+	// remove a socket left behind by a previous server, but nothing else
+	struct stat existing;
+	if (lstat(socket_path.c_str(), &existing) == 0) {
+		if (!S_ISSOCK(existing.st_mode)) {
+			throw runtime_error{"\"" + socket_path +
+				"\" exists and isn't a socket"};
+		}
+		unlink(socket_path.c_str());
+	}
+
+	int server_fd{socket(AF_UNIX, SOCK_STREAM, 0)};
+	if (server_fd < 0)
+	{ throw runtime_error{string{"socket: "} + std::strerror(errno)}; }
+
+	if (bind(server_fd, reinterpret_cast<sockaddr*>(&address),
+				sizeof(address)) < 0 || listen(server_fd, SOMAXCONN) < 0) {
+		string error{std::strerror(errno)};
+		close(server_fd);
+		throw runtime_error{"Could not listen on \"" + socket_path + "\": " +
+			error};
+	}
+
+	atomic<int> active_connections{0};
+	while (!stop) {
+		pollfd server_poll{server_fd, POLLIN, 0};
+		if (poll(&server_poll, 1, poll_timeout_ms) <= 0) { continue; }
+
+		int client_fd{accept(server_fd, nullptr, nullptr)};
+		if (client_fd < 0) { continue; }
+
+		++active_connections;
+		thread{ServeConnection, client_fd, cref(handler), cref(stop),
+			   std::ref(active_connections)}.detach();
+	}
+
+	// connections notice stop within one poll timeout
+	while (active_connections > 0)
+	{ std::this_thread::sleep_for(chr::milliseconds{poll_timeout_ms / 4}); }
+
+	close(server_fd);
+	unlink(socket_path.c_str());
+}
@@ -0,0 +1,99 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_stages.hpp"
+#include "student.hpp"
+#include "student_network.hpp"
+
+
+class StudentContainer;
+
+
+// Line protocol spoken over the server's Unix-domain socket. Every request is
+// a single line of whitespace separated words:
+//     student <id>
+//     neighbors <id>
+//     ego <id> <hops>
+//     distances <id> <weighted|unweighted>
+//     distance <id> <id> <weighted|unweighted>
+//     reduce <grouping> <sum|count|min|max>
+//     quit
+// A successful response is "OK <n>" followed by n lines of tab separated
+// values, a failed one is a single "ERR <message>" line. quit closes the
+// connection without a response.
+//     student: the student's description
+//     neighbors: <student>\t<edge weight>
+//     ego: <student>\t<student>\t<edge weight> for every edge among the
+//          students within <hops> steps of <id>
+//     distances: <student>\t<distance> for every connected student
+//     distance: <distance>, or no lines if the students aren't connected
+//     reduce: <group>\t<group>\t<aggregate>, as saved by SaveReductions
+
+
+class QueryError : public std::exception {
+ public:
+	QueryError(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+// Answers requests against a network that stays loaded in memory. Requests
+// only read the network, so HandleRequest may be called from many threads.
+// Weighted distances use delta_stepping when given and Dijkstra otherwise.
+class QueryHandler {
+ public:
+	QueryHandler(const StudentNetwork& network,
+				 const StudentContainer& students,
+				 const student_delta_stepping_t* delta_stepping = nullptr);
+
+	// Returns the full response, including the trailing newline.
+	std::string HandleRequest(const std::string& request) const;
+
+ private:
+	std::vector<std::string> HandleStudent(
+			const std::vector<std::string>& words) const;
+	std::vector<std::string> HandleNeighbors(
+			const std::vector<std::string>& words) const;
+	std::vector<std::string> HandleEgo(
+			const std::vector<std::string>& words) const;
+	std::vector<std::string> HandleDistances(
+			const std::vector<std::string>& words) const;
+	std::vector<std::string> HandleDistance(
+			const std::vector<std::string>& words) const;
+	std::vector<std::string> HandleReduce(
+			const std::vector<std::string>& words) const;
+
+	StudentNetwork::vertex_t FindVertex(const std::string& id) const;
+
+	const StudentNetwork& network_;
+	const StudentContainer& students_;
+	const student_delta_stepping_t* delta_stepping_;
+	std::unordered_map<Student::Id, StudentNetwork::vertex_t> vertex_index_;
+
+	// reductions are expensive and rarely change, so they're computed once
+	mutable std::map<std::string, std::vector<std::string>> reductions_;
+	mutable std::mutex reductions_mutex_;
+};
+
+
+// Serves requests on a Unix-domain socket at socket_path until stop is set.
+// Each connection is served on its own thread. A socket left at socket_path
+// is replaced. Throws std::runtime_error if the socket can't be created or
+// socket_path is some other file.
+void ServeUnixSocket(const std::string& socket_path,
+					 const QueryHandler& handler,
+					 const std::atomic<bool>& stop);
+
+
+#endif  // QUERY_SERVER_H
@@ -0,0 +1,210 @@
+#include "query_server.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/graph/adjacency_matrix.hpp>
+#include "gtest/gtest.h"
+
+#include "analysis_stages.hpp"
+#include "query_client.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+#include "student_network.hpp"
+#include "test_data_streams.hpp"
+
+
+using std::atomic;
+using std::count;
+using std::ofstream;
+using std::runtime_error;
+using std::string; using std::to_string;
+using std::stringstream;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+using boost::add_edge;
+using boost::vertex;
+
+
+class QueryServerTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		StudentNetwork::graph_t graph{5};
+
+		// add vertices
+		auto student1 = vertex(0, graph);
+		graph[student1] = Student::Id{147195};
+		auto student2 = vertex(1, graph);
+		graph[student2] = Student::Id{312995};
+		auto student3 = vertex(2, graph);
+		graph[student3] = Student::Id{352468};
+		auto student4 = vertex(3, graph);
+		graph[student4] = Student::Id{500928};
+		auto student5 = vertex(4, graph);
+		graph[student5] = Student::Id{567890};
+
+		// add edges
+		add_edge(student1, student2, 3.0, graph);
+		add_edge(student1, student3, 3.0, graph);
+		add_edge(student1, student4, 1.0, graph);
+
+		add_edge(student2, student3, 1.0, graph);
+		add_edge(student2, student4, 3.0, graph);
+
+		add_edge(student3, student4, 1.0, graph);
+		add_edge(student3, student5, 1.5, graph);
+
+		network = StudentNetwork{graph};
+	}
+
+ protected:
+	static StudentContainer LoadStudents() {
+		stringstream student_stream{student_tab};
+		return StudentContainer::LoadFromTsv(student_stream);
+	}
+
+	StudentNetwork network;
+	StudentContainer students{LoadStudents()};
+};
+
+
+TEST_F(QueryServerTest, HandleRequest) {
+	QueryHandler handler{network, students};
+
+	EXPECT_EQ("OK 1\n" + students.Find(352468).GetDescription() + '\n',
+			  handler.HandleRequest("student 352468"));
+	EXPECT_EQ("OK 4\n147195\t3\n312995\t1\n500928\t1\n567890\t1.5\n",
+			  handler.HandleRequest("neighbors 352468"));
+
+	// within one hop 567890 only knows 352468, within two hops everyone
+	EXPECT_EQ("OK 0\n", handler.HandleRequest("ego 567890 0"));
+	EXPECT_EQ("OK 1\n352468\t567890\t1.5\n",
+			  handler.HandleRequest("ego 567890 1"));
+	EXPECT_EQ("OK 7\n", handler.HandleRequest("ego 567890 2").substr(0, 5));
+
+	EXPECT_EQ("OK 4\n147195\t2\n312995\t1\n500928\t1\n567890\t1.5\n",
+			  handler.HandleRequest("distances 352468 weighted"));
+	EXPECT_EQ("OK 4\n147195\t1\n312995\t1\n500928\t1\n567890\t1\n",
+			  handler.HandleRequest("distances 352468 unweighted"));
+	EXPECT_EQ("OK 1\n3.5\n",
+			  handler.HandleRequest("distance 147195 567890 weighted"));
+	EXPECT_EQ("OK 1\n2\n",
+			  handler.HandleRequest("distance 147195 567890 unweighted"));
+}
+
+
+TEST_F(QueryServerTest, HandleRequestDeltaStepping) {
+	student_delta_stepping_t delta_stepping{network, 1.};
+	QueryHandler dijkstra_handler{network, students};
+	QueryHandler delta_handler{network, students, &delta_stepping};
+
+	for (const auto& vertex_id : network.GetVertexValues()) {
+		auto request = "distances " + to_string(vertex_id) + " weighted";
+		EXPECT_EQ(dijkstra_handler.HandleRequest(request),
+				  delta_handler.HandleRequest(request));
+	}
+}
+
+
+TEST_F(QueryServerTest, HandleReduce) {
+	QueryHandler handler{network, students};
+
+	stringstream expected;
+	SaveReduction(network, students, {"school", EdgeAggregate_e::Count, ""},
+				  expected);
+	auto expected_lines = expected.str();
+	auto num_lines = count(begin(expected_lines), end(expected_lines),
+								'\n');
+
+	auto response = "OK " + to_string(num_lines) + '\n' + expected_lines;
+	EXPECT_EQ(response, handler.HandleRequest("reduce school count"));
+	// a second request is answered from the cache
+	EXPECT_EQ(response, handler.HandleRequest("reduce school count"));
+}
+
+
+TEST_F(QueryServerTest, HandleRequestErrors) {
+	QueryHandler handler{network, students};
+
+	for (string request : {
+			"",
+			"centrality 147195",
+			"neighbors",
+			"neighbors 147195 312995",
+			"neighbors 123",
+			"neighbors abc",
+			"student 123",
+			"ego 147195 -1",
+			"distances 147195 sideways",
+			"reduce favorite_color sum",
+			"reduce school median"}) {
+		auto response = handler.HandleRequest(request);
+		EXPECT_EQ("ERR ", response.substr(0, 4)) << request;
+		EXPECT_EQ(1, count(begin(response), end(response), '\n'))
+			<< request;
+	}
+}
+
+
+TEST_F(QueryServerTest, ServeUnixSocket) {
+	QueryHandler handler{network, students};
+	string socket_path{"/tmp/query_server_test_" + to_string(getpid())};
+
+	atomic<bool> stop{false};
+	thread server{[&socket_path, &handler, &stop]
+		{ ServeUnixSocket(socket_path, handler, stop); }};
+
+	// wait for the server to start listening
+	unique_ptr<QueryClient> client;
+	for (int attempt{0}; !client && attempt < 100; ++attempt) {
+		try {
+			client.reset(new QueryClient{socket_path});
+		} catch (runtime_error&) {
+			std::this_thread::sleep_for(std::chrono::milliseconds{10});
+		}
+	}
+	ASSERT_TRUE(client != nullptr);
+
+	EXPECT_EQ((vector<string>{"147195\t3", "312995\t1", "500928\t1",
+						  "567890\t1.5"}),
+			  client->Request("neighbors 352468"));
+	EXPECT_EQ(vector<string>{"3.5"},
+			  client->Request("distance 147195 567890 weighted"));
+	EXPECT_THROW(client->Request("neighbors 123"), QueryError);
+
+	// a second connection is served alongside the first
+	QueryClient other_client{socket_path};
+	EXPECT_EQ(vector<string>{"1.5"},
+			  other_client.Request("distance 352468 567890 weighted"));
+	EXPECT_EQ(vector<string>{"2"},
+			  client->Request("distance 147195 567890 unweighted"));
+
+	stop = true;
+	server.join();
+	EXPECT_NE(0, access(socket_path.c_str(), F_OK));
+}
+
+
+TEST_F(QueryServerTest, ServeUnixSocketOverFile) {
+	QueryHandler handler{network, students};
+	string file_path{"/tmp/query_server_test_file_" + to_string(getpid())};
+	ofstream{file_path} << "not a socket\n";
+
+	// a mistyped socket path doesn't delete the file
+	atomic<bool> stop{true};
+	EXPECT_THROW(ServeUnixSocket(file_path, handler, stop), runtime_error);
+	EXPECT_EQ(0, access(file_path.c_str(), F_OK));
+	EXPECT_EQ(0, unlink(file_path.c_str()));
+}
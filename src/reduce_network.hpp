@@ -2,13 +2,20 @@
 #define REDUCE_NETWORK_H
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <string>
 #include <set>
 #include <utility>
+#include <vector>
 
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "metrics.hpp"
 #include "network.hpp"
+#include "thread_safe_range_action.hpp"
 
 
 // reduce the network using functions that map every vertex in the original onto
@@ -61,4 +68,206 @@ ReduceNetwork(const Network<InputVertex, InputEdge>& input_network,
 }
 
 
+// Aggregate functions supported by ReduceNetworkMulti. Unlike the edge
+// functions passed to ReduceNetwork, these can be merged across threads.
+enum class EdgeAggregate_e { Sum, Count, Min, Max };
+
+
+// Dictionary encoding of a vertex function over a network. Every input vertex
+// descriptor maps to a dense group id and every group id maps to its reduced
+// vertex. Groups are sorted like the vertices of ReduceNetwork's output.
+template <typename ReducedVertex>
+struct VertexGrouping {
+	std::vector<ReducedVertex> groups;
+	std::vector<int> group_ids;
+};
+
+
+template <typename InputVertex, typename InputEdge, typename VertexFunc>
+VertexGrouping<decltype(std::declval<VertexFunc>()(InputVertex{}))>
+EncodeVertexGrouping(const Network<InputVertex, InputEdge>& input_network,
+					 VertexFunc vertex_func) {
+	using reduced_vertex_t = decltype(std::declval<VertexFunc>()(InputVertex{}));
+
+	// evaluate the vertex function once per input vertex
+	std::vector<reduced_vertex_t> reduced_values;
+	std::transform(std::begin(input_network.GetVertexValues()),
+		 std::end(input_network.GetVertexValues()),
+		 std::back_inserter(reduced_values),
+		 [vertex_func](const InputVertex& vertex)
+			{ return vertex_func(vertex); });
+
+	std::set<reduced_vertex_t> reduced_vertices{
+		std::begin(reduced_values), std::end(reduced_values)};
+	std::map<reduced_vertex_t, int> group_id_map;
+	for (const auto& reduced_vertex : reduced_vertices) {
+		auto group_id = static_cast<int>(group_id_map.size());
+		group_id_map[reduced_vertex] = group_id;
+	}
+
+	VertexGrouping<reduced_vertex_t> grouping;
+	grouping.groups.assign(
+			std::begin(reduced_vertices), std::end(reduced_vertices));
+	for (const auto& reduced_value : reduced_values)
+	{ grouping.group_ids.push_back(group_id_map[reduced_value]); }
+	return grouping;
+}
+
+
+// Dense symmetric matrix of aggregated edge values between groups. Only the
+// lower triangle is stored.
+class AggregateMatrix {
+ public:
+	AggregateMatrix(std::size_t num_groups, EdgeAggregate_e aggregate) :
+		num_groups_{num_groups}, aggregate_{aggregate},
+		values_(num_groups * (num_groups + 1) / 2, 0.),
+		present_(num_groups * (num_groups + 1) / 2, false) {}
+
+	void Add(int source, int target, double value) {
+		auto index = Index(source, target);
+		if (!present_[index]) {
+			present_[index] = true;
+			values_[index] = aggregate_ == EdgeAggregate_e::Count ? 1. : value;
+		} else {
+			values_[index] = Combine(values_[index],
+					aggregate_ == EdgeAggregate_e::Count ? 1. : value);
+		}
+	}
+
+	// Folds the partial aggregates of another matrix into this one.
+	void Merge(const AggregateMatrix& other) {
+		for (std::size_t index{0}; index < values_.size(); ++index) {
+			if (!other.present_[index]) { continue; }
+			values_[index] = present_[index] ?
+				Combine(values_[index], other.values_[index]) :
+				other.values_[index];
+			present_[index] = true;
+		}
+	}
+
+	bool HasEdge(int source, int target) const
+	{ return present_[Index(source, target)]; }
+	double Get(int source, int target) const
+	{ return values_[Index(source, target)]; }
+
+	std::size_t num_groups() const { return num_groups_; }
+	EdgeAggregate_e aggregate() const { return aggregate_; }
+
+ private:
+	std::size_t Index(int source, int target) const {
+		std::size_t row = std::max(source, target);
+		std::size_t column = std::min(source, target);
+		return row * (row + 1) / 2 + column;
+	}
+
+	double Combine(double current, double value) const {
+		switch (aggregate_) {
+			case EdgeAggregate_e::Sum:
+			case EdgeAggregate_e::Count:
+				return current + value;
+			case EdgeAggregate_e::Min:
+				return std::min(current, value);
+			case EdgeAggregate_e::Max:
+				return std::max(current, value);
+		}
+		return current;
+	}
+
+	std::size_t num_groups_;
+	EdgeAggregate_e aggregate_;
+	std::vector<double> values_;
+	std::vector<bool> present_;
+};
+
+
+// One grouping combined with one aggregate function.
+struct Reduction {
+	const std::vector<int>* group_ids;
+	std::size_t num_groups;
+	EdgeAggregate_e aggregate;
+};
+
+
+template <typename ReducedVertex>
+Reduction MakeReduction(const VertexGrouping<ReducedVertex>& grouping,
+						EdgeAggregate_e aggregate)
+{ return {&grouping.group_ids, grouping.groups.size(), aggregate}; }
+
+
+// Computes every reduction in a single parallel pass over the edges of the
+// input network. Each thread accumulates into its own matrices, which are
+// merged once the thread's share of vertices is done.
+template <typename InputVertex, typename InputEdge>
+std::vector<AggregateMatrix> ReduceNetworkMulti(
+		const Network<InputVertex, InputEdge>& input_network,
+		const std::vector<Reduction>& reductions) {
+	using input_vertex_t =
+		typename Network<InputVertex, InputEdge>::vertex_t;
+
+	std::vector<AggregateMatrix> reduced;
+	for (const auto& reduction : reductions)
+	{ reduced.emplace_back(reduction.num_groups, reduction.aggregate); }
+
+	CountingMutex reduced_mutex{"reduce"};
+	PerformFunctionOnRange([&input_network, &reductions, &reduced,
+			&reduced_mutex](boost::counting_iterator<input_vertex_t> first,
+				boost::counting_iterator<input_vertex_t> last) {
+			std::vector<AggregateMatrix> thread_reduced;
+			for (const auto& reduction : reductions) {
+				thread_reduced.emplace_back(
+						reduction.num_groups, reduction.aggregate);
+			}
+
+			// every undirected edge is visited from its lower endpoint only
+			for (auto it = first; it != last; ++it) {
+				for (const auto& edge_d :
+						input_network.GetOutEdgeDescriptors(*it)) {
+					auto target = input_network.GetTargetDescriptor(edge_d);
+					if (target < *it) { continue; }
+
+					double value = input_network[edge_d];
+					for (std::size_t i{0}; i < reductions.size(); ++i) {
+						const auto& group_ids = *reductions[i].group_ids;
+						thread_reduced[i].Add(
+								group_ids[*it], group_ids[target], value);
+					}
+				}
+			}
+
+			std::lock_guard<CountingMutex> lg{reduced_mutex};
+			for (std::size_t i{0}; i < reduced.size(); ++i)
+			{ reduced[i].Merge(thread_reduced[i]); }
+		},
+		boost::counting_iterator<input_vertex_t>{0},
+		boost::counting_iterator<input_vertex_t>{
+			input_network.GetVertexDescriptors().size()});
+
+	return reduced;
+}
+
+
+// Converts an aggregate matrix back into a network over the grouping's
+// reduced vertices.
+template <typename ReducedEdge, typename ReducedVertex>
+Network<ReducedVertex, ReducedEdge> MakeReducedNetwork(
+		const VertexGrouping<ReducedVertex>& grouping,
+		const AggregateMatrix& matrix) {
+	using reduced_network_t = Network<ReducedVertex, ReducedEdge>;
+	using reduced_vertex_t = typename reduced_network_t::vertex_t;
+	reduced_network_t reduced{
+		std::begin(grouping.groups), std::end(grouping.groups)};
+
+	// group ids are the vertex descriptors of the reduced network
+	for (reduced_vertex_t source{0}; source < matrix.num_groups(); ++source) {
+		for (reduced_vertex_t target{0}; target <= source; ++target) {
+			if (!matrix.HasEdge(source, target)) { continue; }
+			reduced(source, target) =
+				static_cast<ReducedEdge>(matrix.Get(source, target));
+		}
+	}
+
+	return reduced;
+}
+
+
 #endif  // REDUCE_NETWORK_H
@@ -7,9 +7,11 @@
 
 #include "gtest/gtest.h"
 
+#include "setting_guard.hpp"
 #include "student_container.hpp"
 #include "student_network.hpp"
 #include "test_data_streams.hpp"
+#include "utility.hpp"
 
 
 using std::begin;
@@ -105,3 +107,63 @@ TEST_F(ReduceNetworkTest, ReduceNework) {
 				male_unweighted_vertex, male_unweighted_vertex), 
 			NoEdgeException);
 }
+
+
+TEST_F(ReduceNetworkTest, ReduceNetworkMulti) {
+	auto gender_grouping = EncodeVertexGrouping(network,
+			[this](const Student::Id& id)
+			{ return students.find(Student{id})->gender(); });
+	auto id_parity_grouping = EncodeVertexGrouping(network,
+			[](const Student::Id& id) { return id % 2; });
+
+	for (int threads : {1, 3}) {
+		SettingGuard<int> threads_guard{num_threads, threads};
+		auto reduced = ReduceNetworkMulti(network, {
+				MakeReduction(gender_grouping, EdgeAggregate_e::Sum),
+				MakeReduction(gender_grouping, EdgeAggregate_e::Count),
+				MakeReduction(gender_grouping, EdgeAggregate_e::Max),
+				MakeReduction(id_parity_grouping, EdgeAggregate_e::Min)});
+		ASSERT_EQ(4u, reduced.size());
+
+		auto weighted_gender_network =
+			MakeReducedNetwork<double>(gender_grouping, reduced[0]);
+		auto male_weighted_vertex =
+			weighted_gender_network.GetVertexDescriptor(Student::Gender::Male);
+		auto female_weighted_vertex = weighted_gender_network.
+			GetVertexDescriptor(Student::Gender::Female);
+		EXPECT_DOUBLE_EQ(8.5, weighted_gender_network.Get(
+					male_weighted_vertex, female_weighted_vertex));
+		EXPECT_DOUBLE_EQ(5.0, weighted_gender_network.Get(
+					female_weighted_vertex, female_weighted_vertex));
+		EXPECT_THROW(weighted_gender_network.Get(
+					male_weighted_vertex, male_weighted_vertex),
+				NoEdgeException);
+
+		auto unweighted_gender_network =
+			MakeReducedNetwork<int>(gender_grouping, reduced[1]);
+		auto male_unweighted_vertex = unweighted_gender_network.
+			GetVertexDescriptor(Student::Gender::Male);
+		auto female_unweighted_vertex = unweighted_gender_network.
+			GetVertexDescriptor(Student::Gender::Female);
+		EXPECT_EQ(4, unweighted_gender_network.Get(
+					male_unweighted_vertex, female_unweighted_vertex));
+		EXPECT_EQ(3, unweighted_gender_network.Get(
+					female_unweighted_vertex, female_unweighted_vertex));
+
+		auto max_gender_network =
+			MakeReducedNetwork<double>(gender_grouping, reduced[2]);
+		EXPECT_DOUBLE_EQ(3.0, max_gender_network.Get(
+					male_weighted_vertex, female_weighted_vertex));
+		EXPECT_DOUBLE_EQ(3.0, max_gender_network.Get(
+					female_weighted_vertex, female_weighted_vertex));
+
+		// 312995 and 147195 are odd, the other students are even
+		auto min_parity_network =
+			MakeReducedNetwork<double>(id_parity_grouping, reduced[3]);
+		auto odd_vertex = min_parity_network.GetVertexDescriptor(1);
+		auto even_vertex = min_parity_network.GetVertexDescriptor(0);
+		EXPECT_DOUBLE_EQ(3.0, min_parity_network.Get(odd_vertex, odd_vertex));
+		EXPECT_DOUBLE_EQ(1.0, min_parity_network.Get(even_vertex, odd_vertex));
+		EXPECT_DOUBLE_EQ(1.0, min_parity_network.Get(even_vertex, even_vertex));
+	}
+}
@@ -6,8 +6,10 @@
 
 #include "course.hpp"
 #include "course_container.hpp"
+#include "metrics.hpp"
 #include "student.hpp"
 #include "student_container.hpp"
+#include "trace.hpp"
 
 using std::cerr; using std::cout; using std::endl;
 using std::ifstream; using std::ofstream;
@@ -17,7 +19,8 @@ namespace po = boost::program_options;
 int main(int argc, char* argv[]) {
 	po::options_description desc{"Save archives of students and courses:"};
 	string student_path, enrollment_path, student_archive_path,
-		   course_archive_path;
+		   course_archive_path, metrics_path, trace_path;
+	int metrics_period;
 	desc.add_options()
 		("help,h", "Show this help message")
 		("student_file", po::value<string>(&student_path)->required(),
@@ -29,7 +32,14 @@ int main(int argc, char* argv[]) {
 		 "Set the path to which the student archive should be saved.")
 		("course_archive_path",
 		 po::value<string>(&course_archive_path)->required(),
-		 "Set the path at which to course archive should be saved.");
+		 "Set the path at which to course archive should be saved.")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
 
 	po::variables_map vm;
 	try {
@@ -44,6 +54,10 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
+	MetricsReporter metrics_reporter{
+		"serialize", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
 	// read students and enrollment data
 	ifstream student_stream{student_path};
 	ifstream enrollment_stream{enrollment_path};
@@ -57,12 +71,21 @@ int main(int argc, char* argv[]) {
 			 << endl;
 		return -1;
 	}
+	PhaseTimer parse_timer{"parse"};
 	StudentContainer students{StudentContainer::LoadFromTsv(student_stream)};
 	CourseContainer courses{CourseContainer::LoadFromTsv(enrollment_stream)};
+	AddToCounter("bytes_read",
+			GetFileSize(student_path) + GetFileSize(enrollment_path));
+	parse_timer.Stop();
 
 	// save archives of students and courses
+	PhaseTimer save_timer{"save"};
 	ofstream student_archive{student_archive_path};
 	ofstream course_archive{course_archive_path};
 	students.SaveToArchive(student_archive);
 	courses.SaveToArchive(course_archive);
+	student_archive.close();
+	course_archive.close();
+	AddToCounter("bytes_written", GetFileSize(student_archive_path) +
+			GetFileSize(course_archive_path));
 }
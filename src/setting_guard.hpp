@@ -0,0 +1,23 @@
+#ifndef SETTING_GUARD_H
+#define SETTING_GUARD_H
+
+// Changes a global setting, like num_threads, for the life of the guard and
+// restores it afterwards, so a test that fails partway doesn't leak it into
+// the tests after it.
+template <typename Setting>
+class SettingGuard {
+ public:
+	SettingGuard(Setting& setting, Setting value)
+			: setting_(setting), saved_value_{setting} { setting_ = value; }
+	~SettingGuard() { setting_ = saved_value_; }
+
+	SettingGuard(const SettingGuard&) = delete;
+	SettingGuard& operator=(const SettingGuard&) = delete;
+
+ private:
+	Setting& setting_;
+	Setting saved_value_;
+};
+
+
+#endif  // SETTING_GUARD_H
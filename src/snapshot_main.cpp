@@ -0,0 +1,109 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "metrics.hpp"
+#include "student_network.hpp"
+#include "temporal_network.hpp"
+#include "trace.hpp"
+
+
+using std::cerr; using std::cout; using std::endl;
+using std::ifstream; using std::ostream;
+using std::string;
+
+namespace po = boost::program_options;
+
+
+int main(int argc, char* argv[]) {
+	po::options_description desc{"Read the snapshots of a temporal build:"};
+	string temporal_path, metrics_path, trace_path;
+	int first_term, metrics_period;
+	desc.add_options()
+		("help,h", "Show this help message")
+		("temporal_path", po::value<string>(&temporal_path)->required(),
+		 "Path of the snapshots written by build --temporal_window")
+		("first_term", po::value<int>(&first_term),
+		 "Save the network of the snapshot starting at this term, e.g. "
+		 "201403, for the analyses. Without it every snapshot is listed "
+		 "with the edges added, removed and reweighted since the last.")
+		("trace_path", po::value<string>(&trace_path),
+		 "Save a Chrome trace of what every thread did here, needs a build "
+		 "with -Dtracing=ON")
+		("metrics_path", po::value<string>(&metrics_path),
+		 "Save a JSON report of phase timings, counters and peak memory here")
+		("metrics_period", po::value<int>(&metrics_period)->default_value(0),
+		 "Also save the metrics report every this many seconds");
+
+	po::positional_options_description positional;
+	positional.add("temporal_path", 1);
+
+	po::variables_map vm;
+	try {
+		po::store(po::command_line_parser(argc, argv).options(desc)
+				.positional(positional).run(), vm);
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 0;
+		}
+		po::notify(vm);
+	} catch (po::error& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	MetricsReporter metrics_reporter{"snapshot", metrics_path, metrics_period};
+	TraceReporter trace_reporter{trace_path};
+
+	PhaseTimer load_timer{"load"};
+	ifstream temporal_stream{temporal_path};
+	if (!temporal_stream.is_open()) {
+		cerr << "Could not open snapshots \"" << temporal_path << "\"!"
+			 << endl;
+		return -1;
+	}
+	TemporalNetwork temporal_network;
+	try {
+		temporal_network = TemporalNetwork::Load(temporal_stream);
+	} catch (InvalidTemporalNetwork& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+	AddToCounter("bytes_read", GetFileSize(temporal_path));
+	load_timer.Stop();
+
+	if (!vm.count("first_term")) {
+		// the first snapshot is compared with an empty one
+		Snapshot previous{0, 0, {}};
+		for (const auto& snapshot : temporal_network.snapshots) {
+			auto diff = DiffSnapshots(previous, snapshot);
+			cout << snapshot.first_term << '\t' << snapshot.last_term << '\t'
+				 << snapshot.edges.size() << '\t' << diff.added << '\t'
+				 << diff.removed << '\t' << diff.changed << '\n';
+			previous = snapshot;
+		}
+		return 0;
+	}
+
+	StudentNetwork student_network;
+	try {
+		const auto& snapshot = temporal_network.FindSnapshot(first_term);
+		student_network = temporal_network.GetNetwork(snapshot);
+		cerr << "Edge checksum "
+			 << temporal_network.GetChecksum(snapshot).ToString() << endl;
+	} catch (InvalidTemporalNetwork& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	PhaseTimer save_timer{"save"};
+	CountingStreamBuffer counting_buffer{cout.rdbuf()};
+	ostream network_output{&counting_buffer};
+	student_network.Save(network_output);
+	network_output.flush();
+	AddToCounter("bytes_written", counting_buffer.count());
+
+	return 0;
+}
@@ -71,6 +71,7 @@ class Student {
 
 	void AddCourseTaken(const Course* course) { courses_taken_.insert(course); }
 	void AddCoursesTaken(std::initializer_list<const Course*> courses);
+	void ClearCoursesTaken() { courses_taken_.clear(); }
 	bool HasTakenCourse(const Course* course) const
 	{ return courses_taken_.count(course) == 1; }
 	// provide access to the container to allow stl algorithms to be run on them
@@ -16,6 +16,7 @@
 
 #include "course_container.hpp"
 #include "student.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 
@@ -31,6 +32,7 @@ using std::vector;
 
 
 StudentContainer StudentContainer::LoadFromTsv(istream& student_stream) {
+	TRACE_SCOPE("load_students_tsv");
     StudentContainer students{};
 
     // Skip headings line.
@@ -44,6 +46,7 @@ StudentContainer StudentContainer::LoadFromTsv(istream& student_stream) {
 
 
 StudentContainer StudentContainer::LoadFromArchive(istream& input_archive) {
+	TRACE_SCOPE("load_students_archive");
     StudentContainer students{};
 
 	boost::archive::text_iarchive archive{input_archive};
@@ -60,6 +63,7 @@ StudentContainer StudentContainer::LoadFromArchive(string input_path) {
 
 
 void StudentContainer::SaveToArchive(ostream& output_archive) {
+	TRACE_SCOPE("save_students_archive");
 	boost::archive::text_oarchive archive{output_archive};
 	serialize(archive, 0);
 }
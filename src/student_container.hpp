@@ -46,6 +46,10 @@ class StudentContainer {
 	// Populate the list of courses a student took.
 	void UpdateCourses(const CourseContainer& courses);
 
+	// A container of copies of the students keep returns true for, in order.
+	template <typename Predicate>
+	StudentContainer Filter(Predicate keep) const;
+
 	// These functions made virtual for mocking
 	// Finds a student with the given ID in the container of students
 	virtual Student& Find(Student::Id id);
@@ -72,6 +76,15 @@ class StudentContainer {
 };
 
 
+template <typename Predicate>
+StudentContainer StudentContainer::Filter(Predicate keep) const {
+	StudentContainer filtered;
+	for (const auto& student : students_)
+	{ if (keep(student)) { filtered.students_.push_back(student); } }
+	return filtered;
+}
+
+
 class StudentNotFound : public std::exception {
  public:
 	StudentNotFound(Student::Id id) : 
@@ -95,6 +95,16 @@ TEST_F(StudentNetworkTest, GetVertexDescriptor) {
 }
 
 
+TEST_F(StudentNetworkTest, GetVertexIndex) {
+	auto index = network.GetVertexIndex();
+
+	EXPECT_EQ(network.GetVertexDescriptors().size(), index.size());
+	for (auto vertex_d : network.GetVertexDescriptors())
+	{ EXPECT_EQ(vertex_d, index.at(network[vertex_d])); }
+	EXPECT_EQ(0u, index.count(Student::Id(0)));
+}
+
+
 TEST_F(StudentNetworkTest, FindUnweightedDistance) {
 	auto distances = network.FindUnweightedDistances(
 			network.GetVertexDescriptor(Student::Id(312995)));
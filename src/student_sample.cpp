@@ -0,0 +1,157 @@
+#include "student_sample.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "student.hpp"
+#include "student_container.hpp"
+#include "utility.hpp"
+
+
+using std::function;
+using std::map;
+using std::pair;
+using std::string; using std::to_string;
+using std::uint64_t;
+using std::vector;
+
+
+// samples are split into this many replicates, fewer if they're smaller
+const int max_replicates{20};
+
+
+// Functions getting the stratum of a student.
+const map<string, function<string(const Student&)>> strata_fields{
+	{"", [](const Student&) { return string{}; }},
+	{"school", [](const Student& student) { return student.school(); }},
+	{"major1", [](const Student& student)
+		{ return student.GetMajor1Description(); }},
+};
+
+
+StudentSample::StudentSample(const StudentContainer& students,
+							 const SampleOptions& options) :
+		population_size_{0} {
+	if (!(options.rate > 0. && options.rate <= 1.)) {
+		throw InvalidSample{"Can't sample a fraction of " +
+			to_string(options.rate) + " of the students!"};
+	}
+	auto field_it = strata_fields.find(options.stratify_by);
+	if (field_it == strata_fields.end()) {
+		throw InvalidSample{"Can't stratify students by \"" +
+			options.stratify_by + "\"!"};
+	}
+
+	// every student gets a random key and the smallest keys of every stratum
+	// are sampled
+	map<string, vector<pair<uint64_t, Student::Id>>> strata_keys;
+	for (const auto& student : students) {
+		strata_keys[field_it->second(student)].emplace_back(
+				MixBits(options.seed ^ MixBits(student.id())), student.id());
+		++population_size_;
+	}
+
+	vector<pair<uint64_t, Student::Id>> sampled_keys;
+	for (auto& stratum_keys : strata_keys) {
+		auto& keys = stratum_keys.second;
+		long population_size{static_cast<long>(keys.size())};
+		auto sample_size = std::max(1l, std::lround(
+					options.rate * population_size));
+		std::partial_sort(begin(keys), begin(keys) + sample_size, end(keys));
+
+		int stratum{static_cast<int>(strata_.size())};
+		strata_.push_back({population_size, sample_size});
+		for (long i{0}; i < sample_size; ++i) {
+			sampled_[keys[i].second] = {stratum, 0};
+			sampled_keys.push_back(keys[i]);
+		}
+	}
+
+	// deal the sampled students to the replicates in the order of their keys
+	std::sort(begin(sampled_keys), end(sampled_keys));
+	num_replicates_ = std::min<int>(max_replicates, sampled_keys.size());
+	for (std::size_t i{0}; i < sampled_keys.size(); ++i)
+	{ sampled_[sampled_keys[i].second].replicate = i % num_replicates_; }
+}
+
+
+StudentContainer StudentSample::GetSampledStudents(
+		const StudentContainer& students) const {
+	return students.Filter([this](const Student& student)
+			{ return Contains(student.id()); });
+}
+
+
+double StudentSample::GetProbability(Student::Id student) const {
+	const auto& stratum = strata_[sampled_.at(student).stratum];
+	return stratum.sample_size / static_cast<double>(stratum.population_size);
+}
+
+
+double StudentSample::GetConditionalProbability(Student::Id student,
+												Student::Id other) const {
+	// the student took one of the places in their stratum
+	if (sampled_.at(student).stratum != sampled_.at(other).stratum)
+	{ return GetProbability(other); }
+	const auto& stratum = strata_[sampled_.at(other).stratum];
+	if (stratum.population_size == 1) { return 1.; }
+	return (stratum.sample_size - 1) /
+		static_cast<double>(stratum.population_size - 1);
+}
+
+
+double StudentSample::GetPairProbability(Student::Id student1,
+										 Student::Id student2) const {
+	return GetProbability(student1) *
+		GetConditionalProbability(student1, student2);
+}
+
+
+JackknifeTotal::JackknifeTotal(int num_replicates, int order,
+							   double sampling_fraction) :
+	order_{order}, sampling_fraction_{sampling_fraction}, sample_total_{0.},
+	total_{0.}, dropped_(num_replicates) {}
+
+
+void JackknifeTotal::Add(double value, double probability, int replicate1,
+						 int replicate2) {
+	sample_total_ += value;
+	total_ += value / probability;
+	dropped_[replicate1] += value / probability;
+	if (replicate2 >= 0 && replicate2 != replicate1)
+	{ dropped_[replicate2] += value / probability; }
+}
+
+
+SampleEstimate JackknifeTotal::Estimate(double population_size) const {
+	auto scale = population_size > 0. ? 1. / population_size : 1.;
+	SampleEstimate estimate{sample_total_, total_ * scale, 0.};
+
+	// a replicate holds (g - 1) / g of the sample, so its students and pairs
+	// were sampled with that much less probability
+	double num_replicates = dropped_.size();
+	if (num_replicates < 2) { return estimate; }
+	auto replicate_scale = std::pow(
+			num_replicates / (num_replicates - 1), order_);
+	vector<double> replicate_totals;
+	for (auto dropped : dropped_)
+	{ replicate_totals.push_back((total_ - dropped) * replicate_scale); }
+	double mean{0.};
+	for (auto replicate_total : replicate_totals)
+	{ mean += replicate_total / num_replicates; }
+	// a fraction f of the students holds about f^2 of the pairs
+	auto correction = 1. - std::pow(sampling_fraction_, order_);
+	double variance{0.};
+	for (auto replicate_total : replicate_totals) {
+		variance += (num_replicates - 1) / num_replicates *
+			(replicate_total - mean) * (replicate_total - mean);
+	}
+	estimate.standard_error = std::sqrt(variance * correction) * scale;
+	return estimate;
+}
@@ -0,0 +1,137 @@
+#ifndef STUDENT_SAMPLE_H
+#define STUDENT_SAMPLE_H
+
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "student.hpp"
+
+
+class StudentContainer;
+
+// Quick estimates of the student network from the network of a random sample
+// of the students. The edges between sampled students keep their weights, as
+// course enrollments come from every student, so the sampled network is the
+// induced subnetwork of the whole one. Totals over it are scaled up by the
+// inverse of the probability every student or pair was sampled, and
+// confidence intervals come from a delete-a-group jackknife: the sample is
+// split into replicate groups and the estimate is recomputed without each.
+
+
+struct SampleOptions {
+	// the fraction of students sampled, 1 for every student
+	double rate{1.};
+	std::uint64_t seed{0};
+	// sample this fraction of every school or major1 rather than of all the
+	// students, empty for a uniform sample
+	std::string stratify_by;
+
+	bool IsSampling() const { return rate < 1.; }
+};
+
+
+// A simple random sample of the students of every stratum, the same for the
+// same students and options wherever it's drawn, so build and the analyses
+// agree on it. Strata sample round(rate * size) students, at least one.
+class StudentSample {
+ public:
+	// Throws InvalidSample for a rate outside (0, 1] or an unknown stratum.
+	StudentSample(const StudentContainer& students,
+				  const SampleOptions& options);
+
+	// The sampled students, in order.
+	StudentContainer GetSampledStudents(
+			const StudentContainer& students) const;
+
+	bool Contains(Student::Id student) const
+	{ return sampled_.count(student) == 1; }
+
+	std::size_t size() const { return sampled_.size(); }
+	std::size_t population_size() const { return population_size_; }
+	double sampling_fraction() const
+	{ return size() / static_cast<double>(population_size_); }
+
+	// The probability a student was sampled.
+	double GetProbability(Student::Id student) const;
+	// The probability another student was sampled given this one was.
+	double GetConditionalProbability(Student::Id student,
+									 Student::Id other) const;
+	// The probability both students were sampled.
+	double GetPairProbability(Student::Id student1,
+							  Student::Id student2) const;
+
+	// The jackknife replicate group of a sampled student.
+	int GetReplicate(Student::Id student) const
+	{ return sampled_.at(student).replicate; }
+	int num_replicates() const { return num_replicates_; }
+
+ private:
+	struct Stratum {
+		long population_size, sample_size;
+	};
+	struct SampledStudent {
+		int stratum, replicate;
+	};
+
+	std::vector<Stratum> strata_;
+	std::unordered_map<Student::Id, SampledStudent> sampled_;
+	std::size_t population_size_;
+	int num_replicates_;
+};
+
+
+// An estimate of a total or mean over every student from the sample.
+struct SampleEstimate {
+	// the statistic of the sampled network itself
+	double sample_value;
+	double value, standard_error;
+
+	// what the sample value was multiplied by
+	double scaling_factor() const
+	{ return sample_value == 0. ? 0. : value / sample_value; }
+
+	// the bounds of the 95% confidence interval
+	double lower() const { return value - 1.96 * standard_error; }
+	double upper() const { return value + 1.96 * standard_error; }
+};
+
+
+// A Horvitz-Thompson total over students or pairs of students, with the
+// totals of its jackknife replicates.
+class JackknifeTotal {
+ public:
+	// order is 1 for a total over students and 2 for one over pairs. The
+	// variance shrinks with the sampling fraction, to 0 for every student.
+	JackknifeTotal(int num_replicates, int order,
+				   double sampling_fraction = 0.);
+
+	// Adds the value of a student or pair of the sample, sampled with the
+	// given probability, in the given replicate groups.
+	void Add(double value, double probability, int replicate1,
+			 int replicate2 = -1);
+
+	// Estimates the total, or its mean over population_size if positive.
+	SampleEstimate Estimate(double population_size = 0.) const;
+
+ private:
+	int order_;
+	double sampling_fraction_, sample_total_, total_;
+	// the total of what every replicate drops
+	std::vector<double> dropped_;
+};
+
+
+class InvalidSample : public std::exception {
+ public:
+	InvalidSample(const std::string& message) : error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // STUDENT_SAMPLE_H
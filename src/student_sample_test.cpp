@@ -0,0 +1,142 @@
+#include "student_sample.hpp"
+
+#include <cmath>
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "student.hpp"
+#include "student_container.hpp"
+#include "test_data_streams.hpp"
+
+
+using std::stringstream;
+using std::vector;
+
+using ::testing::ElementsAre;
+
+
+class StudentSampleTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		stringstream student_stream{student_tab};
+		students.reset(new StudentContainer{
+				StudentContainer::LoadFromTsv(student_stream)});
+	}
+
+ protected:
+	vector<Student::Id> GetSampled(const StudentSample& sample) {
+		vector<Student::Id> sampled;
+		for (const auto& student : sample.GetSampledStudents(*students))
+		{ sampled.push_back(student.id()); }
+		return sampled;
+	}
+
+	std::unique_ptr<StudentContainer> students;
+};
+
+
+TEST_F(StudentSampleTest, EveryStudent) {
+	StudentSample sample{*students, SampleOptions{}};
+	EXPECT_EQ(5u, sample.size());
+	EXPECT_EQ(5u, sample.population_size());
+	EXPECT_THAT(GetSampled(sample),
+			ElementsAre(147195, 312995, 352468, 500928, 567890));
+	EXPECT_DOUBLE_EQ(1., sample.GetProbability(147195));
+	EXPECT_DOUBLE_EQ(1., sample.GetPairProbability(147195, 567890));
+	EXPECT_EQ(5, sample.num_replicates());
+}
+
+
+TEST_F(StudentSampleTest, Uniform) {
+	SampleOptions options;
+	options.rate = 0.4;
+	StudentSample sample{*students, options};
+	auto sampled = GetSampled(sample);
+	ASSERT_EQ(2u, sampled.size());
+	EXPECT_DOUBLE_EQ(0.4, sample.sampling_fraction());
+	EXPECT_DOUBLE_EQ(0.4, sample.GetProbability(sampled[0]));
+	EXPECT_DOUBLE_EQ(0.25,
+			sample.GetConditionalProbability(sampled[0], sampled[1]));
+	EXPECT_DOUBLE_EQ(0.1, sample.GetPairProbability(sampled[0], sampled[1]));
+	EXPECT_NE(sample.GetReplicate(sampled[0]),
+			sample.GetReplicate(sampled[1]));
+
+	// the same seed draws the same sample
+	StudentSample same_sample{*students, options};
+	EXPECT_EQ(sampled, GetSampled(same_sample));
+}
+
+
+TEST_F(StudentSampleTest, Stratified) {
+	// four students of ULSA and one without a school
+	SampleOptions options;
+	options.rate = 0.5;
+	options.stratify_by = "school";
+	StudentSample sample{*students, options};
+	EXPECT_EQ(3u, sample.size());
+	EXPECT_TRUE(sample.Contains(352468));
+	EXPECT_DOUBLE_EQ(1., sample.GetProbability(352468));
+
+	vector<Student::Id> ulsa;
+	for (auto student : GetSampled(sample))
+	{ if (student != 352468) { ulsa.push_back(student); } }
+	ASSERT_EQ(2u, ulsa.size());
+	EXPECT_DOUBLE_EQ(0.5, sample.GetProbability(ulsa[0]));
+	EXPECT_DOUBLE_EQ(0.5, sample.GetConditionalProbability(352468, ulsa[0]));
+	EXPECT_DOUBLE_EQ(1. / 3.,
+			sample.GetConditionalProbability(ulsa[0], ulsa[1]));
+}
+
+
+TEST_F(StudentSampleTest, Invalid) {
+	for (auto rate : {0., -0.5, 1.5}) {
+		SampleOptions options;
+		options.rate = rate;
+		EXPECT_THROW((StudentSample{*students, options}), InvalidSample);
+	}
+
+	SampleOptions options;
+	options.stratify_by = "favorite_color";
+	EXPECT_THROW((StudentSample{*students, options}), InvalidSample);
+}
+
+
+TEST(JackknifeTotalTest, Estimate) {
+	// half of the students, two from each of two replicates
+	JackknifeTotal total{2, 1, 0.5};
+	total.Add(1., 0.5, 0);
+	total.Add(2., 0.5, 0);
+	total.Add(3., 0.5, 1);
+	total.Add(4., 0.5, 1);
+
+	auto estimate = total.Estimate();
+	EXPECT_DOUBLE_EQ(10., estimate.sample_value);
+	EXPECT_DOUBLE_EQ(20., estimate.value);
+	EXPECT_DOUBLE_EQ(2., estimate.scaling_factor());
+	// the replicates estimate 28 and 12, so the variance is 64 * (1 - 0.5)
+	EXPECT_DOUBLE_EQ(std::sqrt(32.), estimate.standard_error);
+	EXPECT_LT(estimate.lower(), 20.);
+	EXPECT_GT(estimate.upper(), 20.);
+
+	auto mean = total.Estimate(8.);
+	EXPECT_DOUBLE_EQ(2.5, mean.value);
+	EXPECT_DOUBLE_EQ(std::sqrt(32.) / 8., mean.standard_error);
+}
+
+
+TEST(JackknifeTotalTest, EveryStudent) {
+	JackknifeTotal total{3, 2, 1.};
+	total.Add(1., 1., 0, 1);
+	total.Add(2., 1., 1, 2);
+	total.Add(3., 1., 2, 2);
+
+	auto estimate = total.Estimate();
+	EXPECT_DOUBLE_EQ(6., estimate.value);
+	EXPECT_DOUBLE_EQ(0., estimate.standard_error);
+	EXPECT_DOUBLE_EQ(estimate.value, estimate.lower());
+}
@@ -0,0 +1,75 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "synthetic_data.hpp"
+
+using std::cerr; using std::cout; using std::endl;
+using std::ofstream;
+using std::string;
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[]) {
+	po::options_description desc{"Generate synthetic student and enrollment "
+		"files:"};
+	string student_path, enrollment_path;
+	SyntheticPopulation population;
+	desc.add_options()
+		("help,h", "Show this help message")
+		("student_file", po::value<string>(&student_path)->required(),
+		 "Set the path to which the student file should be saved")
+		("enrollment_file", po::value<string>(&enrollment_path)->required(),
+		 "Set the path to which the enrollment file should be saved")
+		("num_students",
+		 po::value<int>(&population.num_students)->default_value(
+			 population.num_students), "Number of students to generate")
+		("num_courses",
+		 po::value<int>(&population.num_courses)->default_value(
+			 population.num_courses),
+		 "Number of distinct courses, each offered every term")
+		("num_years",
+		 po::value<int>(&population.num_years)->default_value(
+			 population.num_years), "Number of years spanned by enrollment")
+		("courses_per_student",
+		 po::value<double>(&population.courses_per_student)->default_value(
+			 population.courses_per_student),
+		 "Mean number of courses taken by a student")
+		("class_size_skew",
+		 po::value<double>(&population.class_size_skew)->default_value(
+			 population.class_size_skew),
+		 "Zipf exponent of course popularity")
+		("major_skew",
+		 po::value<double>(&population.major_skew)->default_value(
+			 population.major_skew), "Zipf exponent of major popularity")
+		("seed", po::value<unsigned>(&population.seed)->default_value(
+			 population.seed), "Seed of the generator");
+
+	po::variables_map vm;
+	try {
+		po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 0;
+		}
+		po::notify(vm);
+	} catch (po::error& e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	if (population.num_students < 1 || population.num_courses < 2) {
+		cerr << "Need at least one student and two courses!" << endl;
+		return -1;
+	}
+
+	ofstream student_stream{student_path};
+	ofstream enrollment_stream{enrollment_path};
+	if (!student_stream.is_open() || !enrollment_stream.is_open()) {
+		cerr << "Could not open the output files!" << endl;
+		return -1;
+	}
+	WriteSyntheticStudentTab(population, student_stream);
+	WriteSyntheticEnrollmentTab(population, enrollment_stream);
+}
@@ -0,0 +1,171 @@
+#include "synthetic_data.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+using std::discrete_distribution; using std::mt19937;
+using std::bernoulli_distribution; using std::poisson_distribution;
+using std::uniform_int_distribution;
+using std::ostream;
+using std::pair;
+using std::seed_seq;
+using std::setfill; using std::setw;
+using std::string;
+using std::unordered_set;
+using std::vector;
+
+
+// A selection of codes known to Student::GetMajor1Description.
+const vector<int> major_codes{
+	30103, 40201, 50102, 50103, 90101, 110101, 110104, 131202, 140101,
+	140201, 160905, 230101, 240102, 260101, 270101, 301301, 380101, 400501,
+	400801, 422704, 422706, 450101, 450201, 450601, 451001, 500501, 500901,
+	510602, 520201, 540101,
+};
+
+const vector<string> subjects{
+	"ENGLISH", "MATH", "CHEM", "PHYSICS", "ECON", "PSYCH", "HISTORY",
+	"BIOLOGY", "EECS", "SPANISH", "POLSCI", "SOC", "PHIL", "COMM", "STATS",
+	"ANTHRCUL", "MUSIC", "ARTDES", "ENVIRON", "AAPTIS",
+};
+
+const vector<pair<string, double>> schools{
+	{"ULSA", 0.6}, {"ENGIN", 0.2}, {"BUS", 0.07}, {"MUSIC", 0.05},
+	{"NURS", 0.04}, {"KINES", 0.04},
+};
+
+// IPEDS ethnicity codes 1 through 7 and their weights
+const vector<double> ethnicity_weights{
+	0.05, 0.01, 0.14, 0.05, 0.01, 0.65, 0.04,
+};
+
+const int first_id{100000};
+const int first_year{2010};
+const int years_enrolled{4};
+
+
+// Weights 1 / rank^exponent for ranks 1 through n.
+static vector<double> ZipfWeights(std::size_t n, double exponent) {
+	vector<double> weights;
+	for (std::size_t rank{1}; rank <= n; ++rank)
+	{ weights.push_back(1. / std::pow(rank, exponent)); }
+	return weights;
+}
+
+
+// The year every student starts, shared by both tabs.
+static vector<int> GenerateFirstYears(const SyntheticPopulation& population) {
+	seed_seq seed{population.seed, 0u};
+	mt19937 engine{seed};
+	uniform_int_distribution<int> year_distribution{first_year,
+		first_year + std::max(population.num_years - years_enrolled, 0)};
+
+	vector<int> first_years;
+	for (int i{0}; i < population.num_students; ++i)
+	{ first_years.push_back(year_distribution(engine)); }
+	return first_years;
+}
+
+
+// Majors are written like the registrar writes them, e.g. 42.2706.
+static void WriteMajor(ostream& output, int major_code) {
+	output << major_code / 10000 << '.' << setw(4) << setfill('0')
+		   << major_code % 10000 << setfill(' ');
+}
+
+
+void WriteSyntheticStudentTab(const SyntheticPopulation& population,
+							  ostream& output) {
+	seed_seq seed{population.seed, 1u};
+	mt19937 engine{seed};
+	bernoulli_distribution female{0.5}, transfer{0.05}, declared{0.85},
+		double_major{0.1};
+	discrete_distribution<int> ethnicity{
+		begin(ethnicity_weights), end(ethnicity_weights)};
+	auto major_weights = ZipfWeights(major_codes.size(), population.major_skew);
+	discrete_distribution<std::size_t> major{
+		begin(major_weights), end(major_weights)};
+	vector<double> school_weights;
+	for (const auto& school : schools)
+	{ school_weights.push_back(school.second); }
+	discrete_distribution<std::size_t> school{
+		begin(school_weights), end(school_weights)};
+
+	output << "ID\tGENDER\tETHNICITY\tFIRST_TERM\tDEGREE_TERM\tTRANSFER\t"
+		"MAJOR1\tMAJOR2\tMAJOR1_LONG\tMAJOR2_LONG\tFIRST_DECLARE\t"
+		"FIRST_DECLARE_LONG\tFIRST_DECLARE_TERM\tPELL_STATUS\tACT_ENGL\t"
+		"ACT_MATH\tACT_COMP\tCOA\n";
+
+	auto first_years = GenerateFirstYears(population);
+	for (int i{0}; i < population.num_students; ++i) {
+		output << first_id + i << '\t' << (female(engine) ? 'F' : 'M') << '\t'
+			   << ethnicity(engine) + 1 << '\t' << first_years[i] << "07\t"
+			   << first_years[i] + years_enrolled << "05\t"
+			   << (transfer(engine) ? 'Y' : 'N') << '\t';
+
+		bool has_major1{declared(engine)}, has_major2{double_major(engine)};
+		if (has_major1) { WriteMajor(output, major_codes[major(engine)]); }
+		else { output << "NA"; }
+		output << '\t';
+		if (has_major1 && has_major2)
+		{ WriteMajor(output, major_codes[major(engine)]); }
+		else { output << "NA"; }
+
+		// descriptions and scores aren't read by Student
+		output << "\tNA\tNA\tNA\tNA\tNA\tN\tNA\tNA\tNA\t"
+			   << schools[school(engine)].first << '\n';
+	}
+}
+
+
+void WriteSyntheticEnrollmentTab(const SyntheticPopulation& population,
+								 ostream& output) {
+	seed_seq seed{population.seed, 2u};
+	mt19937 engine{seed};
+	auto course_weights = ZipfWeights(
+			population.num_courses, population.class_size_skew);
+	discrete_distribution<int> course{begin(course_weights),
+		end(course_weights)};
+	poisson_distribution<int> num_courses{population.courses_per_student};
+	// a fall and a winter term every year enrolled
+	uniform_int_distribution<int> term{0, 2 * years_enrolled - 1};
+	discrete_distribution<int> grade{1, 2, 4, 6, 4, 2};
+	const vector<string> grades{"2", "2.7", "3", "3.3", "3.7", "4"};
+
+	output << "ID\tSUBJECT\tCATALOGNBR\tCOURSE_CODE\tGRADE\tGPAO\tCUM_GPA\t"
+		"TOTALCREDITS\tTOTALGRADEPTS\tCOURSECREDIT\tTERM\n";
+
+	auto first_years = GenerateFirstYears(population);
+	for (int i{0}; i < population.num_students; ++i) {
+		// leave room so drawing distinct courses doesn't take forever
+		auto num_taken = std::min(std::max(num_courses(engine), 1),
+				population.num_courses / 2);
+
+		unordered_set<int> taken;
+		while (static_cast<int>(taken.size()) < num_taken) {
+			auto course_index = course(engine);
+			if (!taken.insert(course_index).second) { continue; }
+
+			auto term_index = term(engine);
+			auto year = first_years[i] + (term_index + 1) / 2;
+			auto term_code = year * 100 + (term_index % 2 == 0 ? 7 : 3);
+			auto credits = course_index % 7 == 0 ? 1 :
+				(course_index % 3 == 0 ? 3 : 4);
+
+			output << first_id + i << '\t'
+				   << subjects[course_index % subjects.size()] << '\t'
+				   << 100 + course_index / subjects.size() << "\tNA\t"
+				   << grades[grade(engine)] << "\t3.5\t3.5\t60\t210\t"
+				   << credits << '\t' << term_code << '\n';
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#ifndef SYNTHETIC_DATA_H
+#define SYNTHETIC_DATA_H
+
+#include <iosfwd>
+
+
+// Parameters of a generated population of students and their enrollment. The
+// same parameters always generate the same tabs (for a given standard library),
+// so benchmarks and regression runs compare like with like.
+struct SyntheticPopulation {
+	int num_students{1000};
+	// distinct subject and catalog number pairs, each offered every term
+	int num_courses{400};
+	// students enroll over four years out of this many
+	int num_years{6};
+	// mean number of courses a student takes, drawn from a Poisson
+	double courses_per_student{30.};
+	// Zipf exponent of course popularity, larger means a few huge classes
+	double class_size_skew{1.1};
+	// Zipf exponent of major popularity
+	double major_skew{0.8};
+	unsigned seed{1};
+};
+
+
+// Writes a student tab and an enrollment tab in the format read by
+// StudentContainer::LoadFromTsv and CourseContainer::LoadFromTsv.
+void WriteSyntheticStudentTab(const SyntheticPopulation& population,
+							  std::ostream& output);
+void WriteSyntheticEnrollmentTab(const SyntheticPopulation& population,
+								 std::ostream& output);
+
+
+#endif  // SYNTHETIC_DATA_H
@@ -0,0 +1,67 @@
+#include "synthetic_data.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "course_container.hpp"
+#include "student.hpp"
+#include "student_container.hpp"
+
+
+using std::stringstream;
+using std::vector;
+
+
+TEST(SyntheticDataTest, Deterministic) {
+	SyntheticPopulation population;
+	population.num_students = 50;
+	population.num_courses = 40;
+
+	stringstream students1, students2, enrollment1, enrollment2;
+	WriteSyntheticStudentTab(population, students1);
+	WriteSyntheticStudentTab(population, students2);
+	WriteSyntheticEnrollmentTab(population, enrollment1);
+	WriteSyntheticEnrollmentTab(population, enrollment2);
+	EXPECT_EQ(students1.str(), students2.str());
+	EXPECT_EQ(enrollment1.str(), enrollment2.str());
+
+	population.seed = 2;
+	stringstream enrollment3;
+	WriteSyntheticEnrollmentTab(population, enrollment3);
+	EXPECT_NE(enrollment1.str(), enrollment3.str());
+}
+
+
+TEST(SyntheticDataTest, Load) {
+	SyntheticPopulation population;
+	population.num_students = 200;
+	population.num_courses = 100;
+	population.courses_per_student = 10.;
+
+	stringstream student_stream, enrollment_stream;
+	WriteSyntheticStudentTab(population, student_stream);
+	WriteSyntheticEnrollmentTab(population, enrollment_stream);
+	auto students = StudentContainer::LoadFromTsv(student_stream);
+	auto courses = CourseContainer::LoadFromTsv(enrollment_stream);
+	students.UpdateCourses(courses);
+
+	ASSERT_EQ(200u, students.size());
+	std::size_t num_enrollments{0};
+	for (const auto& student : students) {
+		EXPECT_FALSE(student.courses_taken().empty());
+		num_enrollments += student.courses_taken().size();
+		// majors must be known so they can be described
+		student.GetDescription();
+	}
+	EXPECT_NEAR(10., num_enrollments / 200., 1.);
+
+	// popular courses should be much bigger than the typical course
+	vector<std::size_t> class_sizes;
+	for (const auto& course : courses)
+	{ class_sizes.push_back(course.GetNumStudentsEnrolled()); }
+	std::sort(begin(class_sizes), end(class_sizes));
+	EXPECT_GT(class_sizes.back(), 5 * class_sizes[class_sizes.size() / 2]);
+}
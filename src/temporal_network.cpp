@@ -0,0 +1,199 @@
+#include "temporal_network.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "student_network.hpp"
+#include "trace.hpp"
+
+
+using std::begin; using std::end;
+using std::istream; using std::ostream;
+using std::istringstream;
+using std::pair;
+using std::size_t;
+using std::string; using std::to_string;
+using std::vector;
+
+
+vector<pair<size_t, size_t>> GetTermWindows(size_t num_terms,
+											  int window_terms) {
+	auto window_size = std::min<size_t>(std::max(window_terms, 1), num_terms);
+	vector<pair<size_t, size_t>> windows;
+	for (size_t first{0}; num_terms > 0 && first + window_size <= num_terms;
+			++first)
+	{ windows.emplace_back(first, first + window_size); }
+	return windows;
+}
+
+
+SnapshotDiff DiffSnapshots(const Snapshot& before, const Snapshot& after) {
+	// both are ordered by row and column, so they're merged
+	SnapshotDiff diff{0, 0, 0};
+	auto before_it = begin(before.edges), after_it = begin(after.edges);
+	auto less = [](const SnapshotEdge& edge1, const SnapshotEdge& edge2) {
+		return edge1.row < edge2.row ||
+			(edge1.row == edge2.row && edge1.column < edge2.column);
+	};
+	while (before_it != end(before.edges) && after_it != end(after.edges)) {
+		if (less(*before_it, *after_it)) {
+			++diff.removed;
+			++before_it;
+		} else if (less(*after_it, *before_it)) {
+			++diff.added;
+			++after_it;
+		} else {
+			if (before_it->weight != after_it->weight) { ++diff.changed; }
+			++before_it;
+			++after_it;
+		}
+	}
+	diff.removed += end(before.edges) - before_it;
+	diff.added += end(after.edges) - after_it;
+	return diff;
+}
+
+
+EdgeChecksum TemporalNetwork::GetChecksum(const Snapshot& snapshot) const {
+	EdgeChecksum checksum;
+	for (const auto& edge : snapshot.edges) {
+		checksum.AddEdge(students[edge.row], students[edge.column],
+				edge.weight);
+	}
+	return checksum;
+}
+
+
+const Snapshot& TemporalNetwork::FindSnapshot(int first_term) const {
+	for (const auto& snapshot : snapshots)
+	{ if (snapshot.first_term == first_term) { return snapshot; } }
+	throw InvalidTemporalNetwork{"There's no snapshot starting at term " +
+		to_string(first_term) + "!"};
+}
+
+
+StudentNetwork TemporalNetwork::GetNetwork(const Snapshot& snapshot) const {
+	TRACE_SCOPE("snapshot_network");
+	StudentNetwork network{students.size()};
+	auto vertex_value_it = network.GetVertexValues().begin();
+	for (auto student : students) { *vertex_value_it++ = student; }
+
+	auto vertex_it = begin(network.GetVertexDescriptors());
+	for (const auto& edge : snapshot.edges)
+	{ network(vertex_it[edge.row], vertex_it[edge.column]) = edge.weight; }
+	return network;
+}
+
+
+void TemporalNetwork::Save(ostream& output) const {
+	TRACE_SCOPE("save_temporal_network");
+	output << "temporal\t" << students.size() << '\t' << snapshots.size()
+		   << '\n';
+	for (auto student : students) { output << student << '\n'; }
+
+	// weights are written exactly so snapshots compare like the networks
+	for (const auto& snapshot : snapshots) {
+		output << "snapshot\t" << snapshot.first_term << '\t'
+			   << snapshot.last_term << '\n';
+		auto precision =
+			output.precision(std::numeric_limits<double>::max_digits10);
+		for (const auto& edge : snapshot.edges) {
+			output << edge.row << '\t' << edge.column << '\t' << edge.weight
+				   << '\n';
+		}
+		output.precision(precision);
+		output << "end\t" << snapshot.edges.size() << '\t'
+			   << GetChecksum(snapshot).ToString() << '\n';
+	}
+	output.flush();
+}
+
+
+TemporalNetwork TemporalNetwork::Load(istream& input) {
+	TRACE_SCOPE("load_temporal_network");
+	TemporalNetwork network;
+	string line, keyword;
+	long num_students, num_snapshots;
+	if (!getline(input, line)) {
+		throw InvalidTemporalNetwork{"The temporal network is empty!"};
+	}
+	istringstream header{line};
+	header >> keyword >> num_students >> num_snapshots;
+	if (!header || keyword != "temporal") {
+		throw InvalidTemporalNetwork{"Bad temporal network header: " + line};
+	}
+
+	for (long i{0}; i < num_students; ++i) {
+		Student::Id student;
+		if (!getline(input, line) || !(istringstream{line} >> student)) {
+			throw InvalidTemporalNetwork{"The vertex table is truncated or "
+				"has a bad student!"};
+		}
+		network.students.push_back(student);
+	}
+
+	for (long i{0}; i < num_snapshots; ++i) {
+		Snapshot snapshot;
+		if (!getline(input, line)) { break; }
+		istringstream snapshot_header{line};
+		snapshot_header >> keyword >> snapshot.first_term
+						>> snapshot.last_term;
+		if (!snapshot_header || keyword != "snapshot")
+		{ throw InvalidTemporalNetwork{"Bad snapshot header: " + line}; }
+
+		auto name = "Snapshot " + to_string(snapshot.first_term) + "-" +
+			to_string(snapshot.last_term);
+		bool ended{false};
+		while (!ended && getline(input, line)) {
+			istringstream fields{line};
+			if (line.compare(0, 4, "end\t") == 0) {
+				long num_edges;
+				string checksum;
+				fields >> keyword >> num_edges >> checksum;
+				if (num_edges != static_cast<long>(snapshot.edges.size())) {
+					throw InvalidTemporalNetwork{name + " has " +
+						to_string(snapshot.edges.size()) + " edges but " +
+						"should have " + to_string(num_edges) + "!"};
+				}
+				if (checksum != network.GetChecksum(snapshot).ToString()) {
+					throw InvalidTemporalNetwork{
+						name + " doesn't match its checksum!"};
+				}
+				ended = true;
+				continue;
+			}
+
+			SnapshotEdge edge;
+			fields >> edge.row >> edge.column >> edge.weight;
+			if (!fields || edge.row < 0 || edge.row >= edge.column ||
+					edge.column >= num_students) {
+				throw InvalidTemporalNetwork{
+					name + " has a bad edge: " + line};
+			}
+			// diffs merge the edges of snapshots in order
+			if (!snapshot.edges.empty()) {
+				const auto& previous = snapshot.edges.back();
+				if (previous.row > edge.row || (previous.row == edge.row &&
+							previous.column >= edge.column)) {
+					throw InvalidTemporalNetwork{
+						name + " has an edge out of order: " + line};
+				}
+			}
+			snapshot.edges.push_back(edge);
+		}
+		if (!ended) { throw InvalidTemporalNetwork{name + " is truncated!"}; }
+		network.snapshots.push_back(std::move(snapshot));
+	}
+
+	if (static_cast<long>(network.snapshots.size()) != num_snapshots) {
+		throw InvalidTemporalNetwork{"The temporal network has " +
+			to_string(network.snapshots.size()) + " snapshots but should "
+			"have " + to_string(num_snapshots) + "!"};
+	}
+	return network;
+}
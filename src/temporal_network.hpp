@@ -0,0 +1,99 @@
+#ifndef TEMPORAL_NETWORK_H
+#define TEMPORAL_NETWORK_H
+
+#include <cstddef>
+#include <exception>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "edge_checksum.hpp"
+#include "student.hpp"
+
+
+class StudentNetwork;
+
+
+// A temporal build slices the student network by the terms of the courses.
+// Terms are numbered in order and every window of window_terms consecutive
+// terms gets a snapshot of the network of only its courses, so a window of
+// one term gives a network per term. The snapshots share a single vertex
+// table, the students in the order of the student archive, and their edges
+// are pairs of rows of it, ordered by row and then column, so snapshots are
+// compared edge by edge without looking students up.
+
+
+// Returns the windows of window_terms of the ordered terms as the indices
+// of their first and one past their last term. A window larger than the
+// terms holds all of them.
+std::vector<std::pair<std::size_t, std::size_t>> GetTermWindows(
+		std::size_t num_terms, int window_terms);
+
+
+// An edge between the students at two rows of the vertex table, row < column.
+struct SnapshotEdge {
+	long row, column;
+	double weight;
+};
+
+
+struct Snapshot {
+	int first_term, last_term;
+	std::vector<SnapshotEdge> edges;
+};
+
+
+// The edges added, removed and reweighted from one snapshot to another.
+struct SnapshotDiff {
+	long added, removed, changed;
+};
+
+SnapshotDiff DiffSnapshots(const Snapshot& before, const Snapshot& after);
+
+
+// Saved as a tab separated file of the form
+//     temporal	<num_students>	<num_snapshots>
+//     <student>
+//     ...
+//     snapshot	<first_term>	<last_term>
+//     <row>	<column>	<weight>
+//     ...
+//     end	<num_edges>	<edge checksum>
+//     snapshot	...
+// where every snapshot ends like a shard, so a truncated file is found.
+struct TemporalNetwork {
+	std::vector<Student::Id> students;
+	std::vector<Snapshot> snapshots;
+
+	// The checksum of a snapshot is that of a network of the same edges.
+	EdgeChecksum GetChecksum(const Snapshot& snapshot) const;
+
+	// Returns the snapshot of the window starting at first_term, throws
+	// InvalidTemporalNetwork if there's none.
+	const Snapshot& FindSnapshot(int first_term) const;
+
+	// The network of a snapshot, with a vertex for every student.
+	StudentNetwork GetNetwork(const Snapshot& snapshot) const;
+
+	void Save(std::ostream& output) const;
+
+	// Throws InvalidTemporalNetwork if the file is malformed, truncated, a
+	// snapshot's edges aren't in order without repeats or a snapshot doesn't
+	// match the checksum it was saved with.
+	static TemporalNetwork Load(std::istream& input);
+};
+
+
+class InvalidTemporalNetwork : public std::exception {
+ public:
+	InvalidTemporalNetwork(const std::string& message) :
+		error_message_{message} {}
+	const char* what() const noexcept { return error_message_.c_str(); }
+
+ private:
+	std::string error_message_;
+};
+
+
+#endif  // TEMPORAL_NETWORK_H
@@ -0,0 +1,129 @@
+#include "temporal_network.hpp"
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "edge_checksum.hpp"
+#include "student_network.hpp"
+
+
+using std::string;
+using std::stringstream;
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+
+TEST(GetTermWindowsTest, Windows) {
+	using Window = std::pair<std::size_t, std::size_t>;
+	EXPECT_THAT(GetTermWindows(3, 1),
+			ElementsAre(Window{0, 1}, Window{1, 2}, Window{2, 3}));
+	EXPECT_THAT(GetTermWindows(3, 2), ElementsAre(Window{0, 2}, Window{1, 3}));
+	EXPECT_THAT(GetTermWindows(3, 5), ElementsAre(Window{0, 3}));
+	EXPECT_THAT(GetTermWindows(0, 2), IsEmpty());
+}
+
+
+class TemporalNetworkTest : public ::testing::Test {
+ public:
+	void SetUp() override {
+		temporal_network.students = {10, 20, 30};
+		temporal_network.snapshots = {
+			{201403, 201403, {{0, 1, 0.1 + 0.2}, {0, 2, 1.}}},
+			{201405, 201405, {{0, 1, 0.5}, {1, 2, 2.}}}};
+	}
+
+	static TemporalNetwork SaveAndLoad(const TemporalNetwork& network) {
+		stringstream stream;
+		network.Save(stream);
+		return TemporalNetwork::Load(stream);
+	}
+
+ protected:
+	TemporalNetwork temporal_network;
+};
+
+
+TEST_F(TemporalNetworkTest, SaveAndLoad) {
+	auto loaded = SaveAndLoad(temporal_network);
+	EXPECT_EQ(temporal_network.students, loaded.students);
+	ASSERT_EQ(2u, loaded.snapshots.size());
+	EXPECT_EQ(201405, loaded.snapshots[1].first_term);
+	ASSERT_EQ(2u, loaded.snapshots[0].edges.size());
+	EXPECT_EQ(2, loaded.snapshots[0].edges[1].column);
+	// weights survive exactly
+	EXPECT_EQ(0.1 + 0.2, loaded.snapshots[0].edges[0].weight);
+	for (std::size_t i{0}; i < 2; ++i) {
+		EXPECT_EQ(temporal_network.GetChecksum(temporal_network.snapshots[i]),
+				loaded.GetChecksum(loaded.snapshots[i]));
+	}
+}
+
+
+TEST_F(TemporalNetworkTest, LoadErrors) {
+	stringstream stream;
+	temporal_network.Save(stream);
+	auto saved = stream.str();
+
+	// the last snapshot is cut off before its end line
+	stringstream truncated{saved.substr(0, saved.rfind("end\t"))};
+	EXPECT_THROW(TemporalNetwork::Load(truncated), InvalidTemporalNetwork);
+
+	// a weight changed after saving
+	auto corrupt = saved;
+	corrupt.replace(corrupt.find("0.5"), 3, "0.6");
+	stringstream corrupt_stream{corrupt};
+	EXPECT_THROW(TemporalNetwork::Load(corrupt_stream), InvalidTemporalNetwork);
+
+	// an edge of a student past the vertex table
+	auto outside = saved;
+	outside.replace(outside.find("1\t2\t2"), 5, "1\t3\t2");
+	stringstream outside_stream{outside};
+	EXPECT_THROW(TemporalNetwork::Load(outside_stream), InvalidTemporalNetwork);
+
+	stringstream empty;
+	EXPECT_THROW(TemporalNetwork::Load(empty), InvalidTemporalNetwork);
+
+	// edges out of order or repeated, the checksums don't tell
+	auto reordered = temporal_network;
+	std::swap(reordered.snapshots[0].edges[0], reordered.snapshots[0].edges[1]);
+	EXPECT_THROW(SaveAndLoad(reordered), InvalidTemporalNetwork);
+	auto repeated = temporal_network;
+	repeated.snapshots[1].edges.push_back({1, 2, 2.});
+	EXPECT_THROW(SaveAndLoad(repeated), InvalidTemporalNetwork);
+}
+
+
+TEST_F(TemporalNetworkTest, Diff) {
+	auto diff = DiffSnapshots(temporal_network.snapshots[0],
+			temporal_network.snapshots[1]);
+	EXPECT_EQ(1, diff.added);
+	EXPECT_EQ(1, diff.removed);
+	EXPECT_EQ(1, diff.changed);
+
+	diff = DiffSnapshots(temporal_network.snapshots[1],
+			temporal_network.snapshots[1]);
+	EXPECT_EQ(0, diff.added + diff.removed + diff.changed);
+
+	diff = DiffSnapshots(Snapshot{0, 0, {}}, temporal_network.snapshots[1]);
+	EXPECT_EQ(2, diff.added);
+}
+
+
+TEST_F(TemporalNetworkTest, GetNetwork) {
+	const auto& snapshot = temporal_network.FindSnapshot(201405);
+	auto network = temporal_network.GetNetwork(snapshot);
+	EXPECT_EQ(3u, network.GetVertexDescriptors().size());
+	EXPECT_EQ(temporal_network.GetChecksum(snapshot),
+			  ComputeEdgeChecksum(network));
+	EXPECT_DOUBLE_EQ(2., network.Get(network.GetVertexDescriptor(20),
+				network.GetVertexDescriptor(30)));
+
+	EXPECT_THROW(temporal_network.FindSnapshot(201407),
+			InvalidTemporalNetwork);
+}
@@ -0,0 +1,155 @@
+#include "trace.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+using std::cerr; using std::endl;
+using std::lock_guard; using std::mutex;
+using std::ofstream; using std::ostream;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+namespace chr = std::chrono;
+
+
+#ifdef ENABLE_TRACING
+
+// Events kept per thread, older events are overwritten.
+const std::size_t trace_buffer_size{1 << 18};
+
+
+struct TraceEvent {
+	const char* name;
+	chr::steady_clock::time_point start, end;
+};
+
+
+// The ring buffer of a single thread, written only by that thread.
+struct TraceBuffer {
+	int thread_index;
+	vector<TraceEvent> events;
+	std::size_t next_event;  // also the number of events, until it wraps
+	bool wrapped;
+};
+
+
+// Buffers outlive their threads so events of finished threads are saved.
+// When a thread exits its buffer is free for the next new thread, which
+// carries on writing it, so threads started one after another (like the
+// connections of the query server) don't each hold a buffer.
+static mutex buffers_mutex;
+static vector<unique_ptr<TraceBuffer>> buffers;
+static vector<TraceBuffer*> free_buffers;
+static const auto trace_start = chr::steady_clock::now();
+
+
+// Frees the buffer of a thread when it exits.
+struct ThreadBufferOwner {
+	~ThreadBufferOwner() {
+		if (!buffer) { return; }
+		lock_guard<mutex> lg{buffers_mutex};
+		free_buffers.push_back(buffer);
+	}
+
+	TraceBuffer* buffer{nullptr};
+};
+
+
+static TraceBuffer& GetThreadBuffer() {
+	thread_local ThreadBufferOwner owner;
+	if (owner.buffer) { return *owner.buffer; }
+
+	lock_guard<mutex> lg{buffers_mutex};
+	if (!free_buffers.empty()) {
+		owner.buffer = free_buffers.back();
+		free_buffers.pop_back();
+		return *owner.buffer;
+	}
+	buffers.emplace_back(new TraceBuffer{static_cast<int>(buffers.size()),
+			vector<TraceEvent>(trace_buffer_size), 0, false});
+	owner.buffer = buffers.back().get();
+	return *owner.buffer;
+}
+
+
+TraceScope::~TraceScope() {
+	auto& buffer = GetThreadBuffer();
+	buffer.events[buffer.next_event] =
+		{name_, start_, chr::steady_clock::now()};
+	if (++buffer.next_event == buffer.events.size()) {
+		buffer.next_event = 0;
+		buffer.wrapped = true;
+	}
+}
+
+
+// Microseconds since the first event, the unit of Chrome's timestamps.
+static double Microseconds(chr::steady_clock::duration duration)
+{ return chr::duration<double, std::micro>(duration).count(); }
+
+
+void SaveTrace(ostream& output) {
+	lock_guard<mutex> lg{buffers_mutex};
+	auto pid = getpid();
+	output << "{\"traceEvents\": [";
+	output << std::fixed << std::setprecision(3);
+	bool first{true};
+	for (const auto& buffer : buffers) {
+		// write the events oldest first
+		auto num_events = buffer->wrapped ?
+			buffer->events.size() : buffer->next_event;
+		auto first_event = buffer->wrapped ? buffer->next_event : 0;
+		for (std::size_t i{0}; i < num_events; ++i) {
+			const auto& event =
+				buffer->events[(first_event + i) % buffer->events.size()];
+			output << (first ? "\n" : ",\n") << "{\"name\": \"" << event.name
+				   << "\", \"ph\": \"X\", \"ts\": "
+				   << Microseconds(event.start - trace_start)
+				   << ", \"dur\": " << Microseconds(event.end - event.start)
+				   << ", \"pid\": " << pid << ", \"tid\": "
+				   << buffer->thread_index << '}';
+			first = false;
+		}
+	}
+	output << "\n]}\n";
+}
+
+#else
+
+void SaveTrace(ostream& output) { output << "{\"traceEvents\": []}\n"; }
+
+#endif  // ENABLE_TRACING
+
+
+TraceReporter::TraceReporter(const string& path) : path_{path} {
+#ifndef ENABLE_TRACING
+	if (!path_.empty()) {
+		cerr << "Built without tracing, the trace will be empty. Rebuild with "
+			 << "cmake -Dtracing=ON." << endl;
+	}
+#endif  // ENABLE_TRACING
+}
+
+
+TraceReporter::~TraceReporter() { Save(); }
+
+
+void TraceReporter::Save() const {
+	if (path_.empty()) { return; }
+
+	ofstream output{path_};
+	if (!output.is_open()) {
+		cerr << "Could not write the trace to \"" << path_ << "\"!" << endl;
+		return;
+	}
+	SaveTrace(output);
+}
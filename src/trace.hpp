@@ -0,0 +1,75 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <iosfwd>
+#include <string>
+
+
+// Scoped trace events for inspecting what every thread spends its time on,
+// compiled in only when ENABLE_TRACING is defined (cmake -Dtracing=ON).
+// Otherwise TRACE_SCOPE expands to nothing. Each thread records its events in
+// its own ring buffer, keeping the most recent trace_buffer_size of them, and
+// SaveTrace writes every buffer in Chrome's trace-event JSON format for
+// chrome://tracing or ui.perfetto.dev. Only the pointer of the name is kept,
+// so it must be a string literal:
+//     void SaveDegreeSums(...) {
+//         TRACE_SCOPE("degree_sums");
+//         ...
+//     }
+// Scopes nest, so a scope around a loop body and one inside a function it
+// calls show how the body's time divides.
+
+#ifdef ENABLE_TRACING
+
+#include <chrono>
+
+class TraceScope {
+ public:
+	explicit TraceScope(const char* name) :
+		name_{name}, start_{std::chrono::steady_clock::now()} {}
+	~TraceScope();
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+	const char* name_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+#define TRACE_CONCATENATE_IMPL(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_IMPL(a, b)
+#define TRACE_SCOPE(name) \
+	TraceScope TRACE_CONCATENATE(trace_scope_, __LINE__){name}
+
+#else
+
+#define TRACE_SCOPE(name) static_cast<void>(0)
+
+#endif  // ENABLE_TRACING
+
+
+// Writes the recorded events of every thread. Threads still recording events
+// may race with it, so call it once the traced work is done.
+void SaveTrace(std::ostream& output);
+
+
+// Saves the trace to path when destroyed, typically at the end of main. Does
+// nothing for an empty path, and warns if tracing isn't compiled in.
+class TraceReporter {
+ public:
+	TraceReporter(const std::string& path);
+	~TraceReporter();
+
+	TraceReporter(const TraceReporter&) = delete;
+	TraceReporter& operator=(const TraceReporter&) = delete;
+
+	// Saves the trace now, e.g. before exiting without unwinding.
+	void Save() const;
+
+ private:
+	std::string path_;
+};
+
+
+#endif  // TRACE_H
@@ -0,0 +1,57 @@
+#include "trace.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+
+using std::ostringstream;
+using std::string;
+
+
+TEST(TraceTest, SaveTrace) {
+	{
+		TRACE_SCOPE("trace_test_outer");
+		TRACE_SCOPE("trace_test_inner");
+	}
+	std::thread{[]() { TRACE_SCOPE("trace_test_thread"); }}.join();
+
+	ostringstream output;
+	SaveTrace(output);
+	auto trace = output.str();
+#ifdef ENABLE_TRACING
+	EXPECT_EQ(0u, trace.find("{\"traceEvents\": [\n{\"name\": "));
+	EXPECT_NE(string::npos, trace.find(
+				"{\"name\": \"trace_test_inner\", \"ph\": \"X\", \"ts\": "));
+	EXPECT_NE(string::npos, trace.find("{\"name\": \"trace_test_outer\""));
+	EXPECT_NE(string::npos, trace.find("{\"name\": \"trace_test_thread\""));
+	// inner scopes end first
+	EXPECT_LT(trace.find("trace_test_inner"), trace.find("trace_test_outer"));
+	EXPECT_EQ("\n]}\n", trace.substr(trace.size() - 4));
+#else
+	EXPECT_EQ("{\"traceEvents\": []}\n", trace);
+#endif  // ENABLE_TRACING
+}
+
+
+#ifdef ENABLE_TRACING
+TEST(TraceTest, ReuseBuffersOfFinishedThreads) {
+	std::thread{[]() { TRACE_SCOPE("trace_test_first"); }}.join();
+	std::thread{[]() { TRACE_SCOPE("trace_test_second"); }}.join();
+
+	// the second thread writes the buffer of the first, under its tid
+	ostringstream output;
+	SaveTrace(output);
+	auto trace = output.str();
+	auto get_tid = [&trace](const string& name) {
+		auto tid_position = trace.find("\"tid\": ", trace.find(name));
+		return trace.substr(tid_position, trace.find('}', tid_position) -
+				tid_position);
+	};
+	ASSERT_NE(string::npos, trace.find("trace_test_first"));
+	ASSERT_NE(string::npos, trace.find("trace_test_second"));
+	EXPECT_EQ(get_tid("trace_test_first"), get_tid("trace_test_second"));
+}
+#endif  // ENABLE_TRACING
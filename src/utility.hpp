@@ -1,6 +1,7 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <cstdint>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -58,6 +59,17 @@ bool HasIntersection(
 bool icompare(const std::string& first, const std::string& second);
 
 
+// Scrambles the bits of x (the finalizer of splitmix64), so consecutive inputs
+// hash independently.
+inline std::uint64_t MixBits(std::uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+
 template<typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args) {
 	return std::unique_ptr<T>{new T{std::forward<Args>(args)...}};
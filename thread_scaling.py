@@ -0,0 +1,179 @@
+"""Thread scaling sweep of the build and analysis stages.
+
+Builds the student network and runs an analyze pipeline on the same input at
+1, 2, 4, ... up to the maximum number of threads. For each thread count it
+reports the time of the parallel phase, the speedup and parallel efficiency
+relative to one thread, and the contention of every lock counted by
+CountingMutex (see src/metrics.hpp).
+"""
+
+
+__author__ = "karepker@umich.edu Kar Epker"
+__copyright__ = "Kar Epker, 2015"
+
+
+import argparse
+import json
+import os
+import subprocess
+import tempfile
+
+import perf_regression
+
+
+# The binaries swept and the phase of each whose time is compared.
+STEPS = [('build', 'build'), ('analyze', 'pipeline')]
+
+
+def thread_counts(max_threads):
+    """Returns powers of two below max_threads, followed by max_threads."""
+
+    counts = []
+    threads = 1
+    while threads < max_threads:
+        counts.append(threads)
+        threads *= 2
+    return counts + [max_threads]
+
+
+def phase_seconds(report, phase_name):
+    """Returns the wall time of the named phase of a metrics report."""
+
+    return next(phase['wall_seconds'] for phase in report['phases']
+                if phase['name'] == phase_name)
+
+
+def lock_contention(report, seconds, threads):
+    """Summarizes the CountingMutex counters of a metrics report.
+
+    Returns:
+        A dictionary of lock name => dictionary of acquisitions, waits, the
+        fraction of acquisitions that waited, seconds spent waiting and the
+        fraction of the threads' time spent waiting.
+    """
+
+    counters = report['counters']
+    suffix = '_lock_acquisitions'
+    contention = {}
+    for counter in counters:
+        if not counter.endswith(suffix):
+            continue
+        lock = counter[:-len(suffix)]
+        acquisitions = counters[counter]
+        waits = counters.get(lock + '_lock_waits', 0)
+        wait_seconds = counters.get(lock + '_lock_wait_us', 0) / 1e6
+        contention[lock] = {
+            'acquisitions': acquisitions,
+            'waits': waits,
+            'wait_fraction': waits / acquisitions if acquisitions else 0.,
+            'wait_seconds': wait_seconds,
+            'time_fraction': wait_seconds / (seconds * threads)
+                             if seconds > 0 else 0.}
+    return contention
+
+
+def summarize(step_reports):
+    """Computes the scaling of a step from its reports at each thread count.
+
+    Args:
+        step_reports (list): (threads, phase seconds, metrics report) tuples,
+            the first of which is the baseline.
+
+    Returns:
+        A list of dictionaries, one per thread count, with the speedup and
+        parallel efficiency relative to the baseline and the lock contention.
+    """
+
+    base_threads, base_seconds, _ = step_reports[0]
+    rows = []
+    for threads, seconds, report in step_reports:
+        speedup = base_seconds / seconds if seconds > 0 else 0.
+        rows.append({'threads': threads, 'seconds': seconds,
+                     'speedup': speedup,
+                     'efficiency': speedup * base_threads / threads,
+                     'locks': lock_contention(report, seconds, threads)})
+    return rows
+
+
+def print_summary(step, rows):
+    print('{}:'.format(step))
+    print('  threads  seconds  speedup  efficiency  lock contention')
+    for row in rows:
+        locks = ', '.join(
+            '{} {:.1%} waited {:.3f}s ({:.1%} of thread time)'.format(
+                lock, values['wait_fraction'], values['wait_seconds'],
+                values['time_fraction'])
+            for lock, values in sorted(row['locks'].items()))
+        print('  {:7d}  {:7.3f}  {:7.2f}  {:10.1%}  {}'.format(row['threads'],
+            row['seconds'], row['speedup'], row['efficiency'], locks or '-'))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Measure how the build and '
+        'analysis stages scale with threads on the same input')
+    parser.add_argument('--binary-dir', dest='binary_dir',
+        default=os.path.join('build', 'src'),
+        help='Directory containing the built binaries.')
+    parser.add_argument('--max-threads', dest='max_threads', type=int,
+        default=os.cpu_count(), help='Largest number of threads to run.')
+    parser.add_argument('--num-students', dest='num_students', type=int,
+        default=2000, help='Number of synthetic students.')
+    parser.add_argument('--seed', dest='seed', type=int, default=1,
+        help='Seed of the synthetic data.')
+    parser.add_argument('--weighting-function', dest='weighting_function',
+        default='CreditHoursOverEnrollment',
+        help='Weighting function of the student network.')
+    parser.add_argument('--output', dest='output',
+        help='Also save the results to this path as JSON.')
+
+    args = parser.parse_args()
+    binary_dir = os.path.abspath(args.binary_dir)
+
+    def binary(name):
+        return os.path.join(binary_dir, name)
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        def path(name):
+            return os.path.join(work_dir, name)
+
+        subprocess.run([binary('synthesize'),
+            '--student_file', path('student.tab'),
+            '--enrollment_file', path('enrollment.tab'),
+            '--num_students', str(args.num_students),
+            '--seed', str(args.seed)], check=True)
+        subprocess.run([binary('serialize'),
+            '--student_file', path('student.tab'),
+            '--enrollment_file', path('enrollment.tab'),
+            '--student_archive_path', path('student_archive.txt'),
+            '--course_archive_path', path('course_archive.txt')], check=True)
+        archive_args = ['--student_archive_path', path('student_archive.txt'),
+                        '--course_archive_path', path('course_archive.txt')]
+        os.makedirs(path('output'), exist_ok=True)
+        with open(path('pipeline.txt'), 'w') as f:
+            f.write(perf_regression.PIPELINE)
+
+        step_reports = {step: [] for step, _ in STEPS}
+        for threads in thread_counts(args.max_threads):
+            build_report = perf_regression.run_step('build', [binary('build'),
+                '--weighting_function', args.weighting_function,
+                '--threads', str(threads), '--progress_period', '0'] +
+                archive_args, work_dir, path('student_network.txt'))
+            analyze_report = perf_regression.run_step('analyze',
+                [binary('analyze'),
+                 '--student_network_archive_path', path('student_network.txt'),
+                 '--pipeline_path', path('pipeline.txt'),
+                 '--threads', str(threads)] + archive_args, work_dir)
+
+            for (step, phase), report in zip(
+                    STEPS, [build_report, analyze_report]):
+                step_reports[step].append(
+                        (threads, phase_seconds(report, phase), report))
+
+    results = {step: summarize(reports)
+               for step, reports in step_reports.items()}
+    for step, _ in STEPS:
+        print_summary(step, results[step])
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
@@ -0,0 +1,46 @@
+"""Tests for thread_scaling module."""
+
+__author__ = "karepker@umich.edu Kar Epker"
+__copyright__ = "Kar Epker, 2015"
+
+
+import unittest
+
+import thread_scaling
+
+
+class ThreadScalingTest(unittest.TestCase):
+    """Tests thread_scaling module."""
+
+    def test_thread_counts(self):
+        """Tests thread_counts."""
+
+        self.assertEqual(thread_scaling.thread_counts(1), [1])
+        self.assertEqual(thread_scaling.thread_counts(4), [1, 2, 4])
+        self.assertEqual(thread_scaling.thread_counts(12), [1, 2, 4, 8, 12])
+
+    def test_summarize(self):
+        """Tests summarize."""
+
+        def report(acquisitions, waits, wait_us):
+            return {'counters': {'edges_lock_acquisitions': acquisitions,
+                                 'edges_lock_waits': waits,
+                                 'edges_lock_wait_us': wait_us,
+                                 'pairs_evaluated': 100}}
+
+        rows = thread_scaling.summarize([(1, 8., report(100, 0, 0)),
+                                         (2, 5., report(100, 20, 1000000)),
+                                         (4, 4., report(100, 50, 4000000))])
+
+        self.assertEqual([row['threads'] for row in rows], [1, 2, 4])
+        self.assertEqual([row['speedup'] for row in rows], [1., 1.6, 2.])
+        self.assertEqual([row['efficiency'] for row in rows], [1., 0.8, 0.5])
+        self.assertEqual(list(rows[1]['locks']), ['edges'])
+        self.assertEqual(rows[1]['locks']['edges'], {
+            'acquisitions': 100, 'waits': 20, 'wait_fraction': 0.2,
+            'wait_seconds': 1., 'time_fraction': 0.1})
+        self.assertEqual(rows[2]['locks']['edges']['time_fraction'], 0.25)
+
+
+if __name__ == '__main__':
+    unittest.main()